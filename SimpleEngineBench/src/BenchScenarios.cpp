@@ -0,0 +1,498 @@
+#include "BenchScenarios.hpp"
+
+#include <SimpleEngineCore/Event.hpp>
+#include <SimpleEngineCore/TransformHierarchy.hpp>
+
+#include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderQueue.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/MeshPool.hpp"
+
+#include <glm/trigonometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+    using namespace SimpleEngine;
+
+    const char* bench_vertex_shader =
+        R"(#version 460
+           layout(location = 0) in vec3 vertex_position;
+           layout(location = 1) in vec3 vertex_color;
+           uniform mat4 model_matrix;
+           uniform mat4 view_projection_matrix;
+           out vec3 color;
+           void main() {
+              color = vertex_color;
+              gl_Position = view_projection_matrix * model_matrix * vec4(vertex_position, 1.0);
+           }
+        )";
+
+    // transforms from the render queue's storage buffer, drawn with multi draw indirect
+    const char* bench_indirect_vertex_shader =
+        R"(#version 460
+           layout(location = 0) in vec3 vertex_position;
+           layout(location = 1) in vec3 vertex_color;
+           layout(std430, binding = 0) readonly buffer Transforms { mat4 model_matrices[]; };
+           uniform int transforms_offset;
+           uniform mat4 view_projection_matrix;
+           out vec3 color;
+           void main() {
+              color = vertex_color;
+              gl_Position = view_projection_matrix * model_matrices[transforms_offset + gl_DrawID] * vec4(vertex_position, 1.0);
+           }
+        )";
+
+    const char* bench_fragment_shader =
+        R"(#version 460
+           in vec3 color;
+           out vec4 frag_color;
+           void main() {
+              frag_color = vec4(color, 1.0);
+           }
+        )";
+
+    const float quad_positions_colors[] = {
+        0.0f, -0.5f, -0.5f,   1.0f, 1.0f, 0.0f,
+        0.0f,  0.5f, -0.5f,   0.0f, 1.0f, 1.0f,
+        0.0f, -0.5f,  0.5f,   1.0f, 0.0f, 1.0f,
+        0.0f,  0.5f,  0.5f,   1.0f, 0.0f, 0.0f
+    };
+
+    const unsigned int quad_indices[] = {
+        0, 1, 2, 3, 2, 1
+    };
+
+    // shader + quad geometry shared by the scenarios
+    struct BenchQuad
+    {
+        explicit BenchQuad(const char* vertex_shader = bench_vertex_shader)
+            : shader_program(vertex_shader, bench_fragment_shader)
+            , vertex_buffer(quad_positions_colors, sizeof(quad_positions_colors), BufferLayout{ ShaderDataType::Float3, ShaderDataType::Float3 })
+            , index_buffer(quad_indices, sizeof(quad_indices) / sizeof(quad_indices[0]))
+        {
+            vertex_array.add_vertex_buffer(vertex_buffer);
+            vertex_array.set_index_buffer(index_buffer);
+        }
+
+        ShaderProgram shader_program;
+        VertexBuffer vertex_buffer;
+        IndexBuffer index_buffer;
+        VertexArray vertex_array;
+    };
+
+    glm::mat4 make_translation(const float x, const float y, const float z)
+    {
+        return glm::mat4(1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, 1, 0,
+            x, y, z, 1);
+    }
+
+    // objects on a grid in the YZ plane in front of the default camera
+    glm::mat4 grid_transform(const size_t index, const size_t count, const size_t frame)
+    {
+        const size_t side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        const float spacing = 8.f / side;
+        const float y = (static_cast<float>(index % side) - side * 0.5f) * spacing;
+        const float z = (static_cast<float>(index / side) - side * 0.5f) * spacing;
+        const float angle = glm::radians(static_cast<float>((frame + index) % 360));
+        const glm::mat4 rotate_matrix(std::cos(angle), std::sin(angle), 0, 0,
+            -std::sin(angle), std::cos(angle), 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, 1);
+        return make_translation(0.f, y, z) * rotate_matrix;
+    }
+
+
+    // N draws with unique transforms through the render queue.
+    // parallel - recorded into per-thread command lists on the job system
+    // indirect - transforms in a storage buffer, the queue merges the draws into multi draw indirect calls
+    class MeshesScenario : public BenchScenario
+    {
+    public:
+        MeshesScenario(const size_t count, const bool parallel = false, const bool indirect = false)
+            : BenchScenario(std::string(parallel ? "meshes_parallel_" : "meshes_") + (indirect ? "indirect_" : "") + std::to_string(count))
+            , m_count(count)
+            , m_parallel(parallel)
+            , m_indirect(indirect)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_quad = std::make_unique<BenchQuad>(m_indirect ? bench_indirect_vertex_shader : bench_vertex_shader);
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            const glm::mat4 view_projection_matrix = application.camera.get_projection_matrix() * application.camera.get_view_matrix();
+            if (m_parallel)
+            {
+                JobSystem& job_system = application.get_job_system();
+                const size_t lists_count = job_system.get_thread_count();
+                m_render_queue.begin_frame(view_projection_matrix, lists_count);
+                job_system.parallel_for(lists_count, 1, [&](const size_t first_list, const size_t last_list)
+                    {
+                        for (size_t list_index = first_list; list_index < last_list; ++list_index)
+                        {
+                            CommandList& command_list = m_render_queue.get_command_list(list_index);
+                            DrawCommand command;
+                            command.shader_program = &m_quad->shader_program;
+                            command.vertex_array = &m_quad->vertex_array;
+                            for (size_t i = m_count * list_index / lists_count; i < m_count * (list_index + 1) / lists_count; ++i)
+                            {
+                                command.model_matrix = grid_transform(i, m_count, frame);
+                                command_list.submit(command);
+                            }
+                        }
+                    });
+                m_render_queue.execute();
+                return;
+            }
+
+            m_render_queue.begin_frame(view_projection_matrix);
+            DrawCommand command;
+            command.shader_program = &m_quad->shader_program;
+            command.vertex_array = &m_quad->vertex_array;
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                command.model_matrix = grid_transform(i, m_count, frame);
+                m_render_queue.submit(command);
+            }
+            m_render_queue.execute();
+        }
+
+        void teardown(Application& application) override
+        {
+            m_render_queue.shutdown();
+            m_quad = nullptr;
+        }
+
+    protected:
+        MeshesScenario(std::string name, const size_t count)
+            : BenchScenario(std::move(name))
+            , m_count(count)
+        {
+        }
+
+    private:
+        size_t m_count;
+        bool m_parallel = false;
+        bool m_indirect = false;
+        std::unique_ptr<BenchQuad> m_quad;
+        RenderQueue m_render_queue;
+    };
+
+
+    // N uploads of changing mat4 values to one uniform, then a single draw
+    class UniformUpdatesScenario : public BenchScenario
+    {
+    public:
+        UniformUpdatesScenario(const size_t count)
+            : BenchScenario("uniform_updates_" + std::to_string(count))
+            , m_count(count)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_quad = std::make_unique<BenchQuad>();
+            m_model_matrix_handle = m_quad->shader_program.get_uniform_handle("model_matrix");
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            m_quad->shader_program.bind();
+            m_quad->shader_program.setMatrix4("view_projection_matrix", application.camera.get_projection_matrix() * application.camera.get_view_matrix());
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                m_quad->shader_program.setMatrix4(m_model_matrix_handle, grid_transform(i, m_count, frame));
+            }
+            Renderer_OpenGL::draw(m_quad->vertex_array);
+        }
+
+        void teardown(Application& application) override
+        {
+            m_quad = nullptr;
+        }
+
+    private:
+        size_t m_count;
+        std::unique_ptr<BenchQuad> m_quad;
+        ShaderProgram::UniformHandle m_model_matrix_handle = ShaderProgram::invalid_uniform;
+    };
+
+
+    // N writes of one quad worth of vertices per frame into a streaming vertex buffer
+    class BufferUploadsScenario : public BenchScenario
+    {
+    public:
+        BufferUploadsScenario(const size_t count)
+            : BenchScenario("buffer_uploads_" + std::to_string(count))
+            , m_count(count)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_quad = std::make_unique<BenchQuad>();
+            m_stream_buffer = std::make_unique<VertexBuffer>(nullptr, sizeof(quad_positions_colors) * m_count,
+                BufferLayout{ ShaderDataType::Float3, ShaderDataType::Float3 }, VertexBuffer::EUsage::Stream);
+            m_vertex_array = std::make_unique<VertexArray>();
+            m_vertex_array->add_vertex_buffer(*m_stream_buffer);
+            m_vertex_array->set_index_buffer(m_quad->index_buffer);
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            size_t offset = 0;
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                offset = m_stream_buffer->write(quad_positions_colors, sizeof(quad_positions_colors));
+            }
+
+            m_quad->shader_program.bind();
+            m_quad->shader_program.setMatrix4("view_projection_matrix", application.camera.get_projection_matrix() * application.camera.get_view_matrix());
+            m_quad->shader_program.setMatrix4("model_matrix", glm::mat4(1.f));
+            const size_t stride = m_stream_buffer->get_layout().get_stride();
+            Renderer_OpenGL::draw(*m_vertex_array, m_quad->index_buffer.get_count(), 0, static_cast<int>(offset / stride));
+        }
+
+        void teardown(Application& application) override
+        {
+            m_vertex_array = nullptr;
+            m_stream_buffer = nullptr;
+            m_quad = nullptr;
+        }
+
+    private:
+        size_t m_count;
+        std::unique_ptr<BenchQuad> m_quad;
+        std::unique_ptr<VertexBuffer> m_stream_buffer;
+        std::unique_ptr<VertexArray> m_vertex_array;
+    };
+
+
+    // N meshes of different sizes in a MeshPool, every frame a tenth of them is freed and allocated again
+    // with new sizes, then the pool is compacted with a fixed budget
+    class MeshPoolChurnScenario : public BenchScenario
+    {
+    public:
+        static constexpr size_t compaction_budget = 1024 * 1024;
+
+        MeshPoolChurnScenario(const size_t count)
+            : BenchScenario("mesh_pool_churn_" + std::to_string(count))
+            , m_count(count)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_pool = std::make_unique<MeshPool>(BufferLayout{ ShaderDataType::Float3, ShaderDataType::Float3 }, IndexBuffer::EIndexType::UInt32);
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                m_meshes.push_back(allocate(i));
+            }
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            for (size_t i = frame % 10; i < m_count; i += 10)
+            {
+                m_pool->free(m_meshes[i]);
+                m_meshes[i] = allocate(i + frame);
+            }
+            m_pool->compact(compaction_budget);
+        }
+
+        void teardown(Application& application) override
+        {
+            m_meshes.clear();
+            m_pool = nullptr;
+        }
+
+    private:
+        // 4 to 1024 vertices, same count of indices
+        MeshPool::Handle allocate(const size_t seed)
+        {
+            const size_t vertices_count = 4 + (seed * 2654435761u) % 1021;
+            const MeshPool::Handle handle = m_pool->allocate(vertices_count, vertices_count);
+            m_pool->set_vertex_data(handle, quad_positions_colors, sizeof(quad_positions_colors));
+            return handle;
+        }
+
+        size_t m_count;
+        std::unique_ptr<MeshPool> m_pool;
+        std::vector<MeshPool::Handle> m_meshes;
+    };
+
+
+    // N mouse move events per frame, either queued like window events (coalesced, drained once
+    // per frame) or dispatched to the application listeners one by one
+    class EventFloodScenario : public BenchScenario
+    {
+    public:
+        EventFloodScenario(const size_t count, const bool queued)
+            : BenchScenario((queued ? "event_flood_" : "event_dispatch_") + std::to_string(count))
+            , m_count(count)
+            , m_queued(queued)
+        {
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                EventMouseMoved event(static_cast<double>(i % 1024), static_cast<double>(frame % 768));
+                if (m_queued)
+                {
+                    application.post_event(event);
+                }
+                else
+                {
+                    application.dispatch_event(event);
+                }
+            }
+        }
+
+    private:
+        size_t m_count;
+        bool m_queued;
+    };
+
+
+    // N nodes, roots with 3 levels of children, 1% of the roots move every frame
+    class TransformHierarchyScenario : public BenchScenario
+    {
+    public:
+        TransformHierarchyScenario(const size_t count)
+            : BenchScenario("transform_hierarchy_" + std::to_string(count))
+            , m_count(count)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_hierarchy = std::make_unique<TransformHierarchy>();
+            Entity parent;
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                const Entity entity = m_registry.create();
+                Transform local;
+                local.position = glm::vec3(0.f, 1.f, 0.f);
+                if (i % 4 == 0)
+                {
+                    m_hierarchy->add(entity, local);
+                    m_roots.push_back(entity);
+                }
+                else
+                {
+                    m_hierarchy->add(entity, local, parent);
+                }
+                parent = entity;
+            }
+            m_hierarchy->update();
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            const size_t moved_count = std::max<size_t>(1, m_roots.size() / 100);
+            for (size_t i = 0; i < moved_count; ++i)
+            {
+                const Entity root = m_roots[(frame * moved_count + i) % m_roots.size()];
+                Transform local = m_hierarchy->get_local(root);
+                local.rotation.z = static_cast<float>(frame % 360);
+                m_hierarchy->set_local(root, local);
+            }
+            m_hierarchy->update();
+        }
+
+        void teardown(Application& application) override
+        {
+            m_hierarchy = nullptr;
+            m_roots.clear();
+        }
+
+    private:
+        size_t m_count;
+        Registry m_registry;
+        std::unique_ptr<TransformHierarchy> m_hierarchy;
+        std::vector<Entity> m_roots;
+    };
+
+
+    // camera orbits around the mesh grid, view matrix changes every frame
+    class CameraSweepScenario : public MeshesScenario
+    {
+    public:
+        CameraSweepScenario(const size_t count)
+            : MeshesScenario("camera_sweep_" + std::to_string(count), count)
+        {
+        }
+
+        void setup(Application& application) override
+        {
+            m_initial_position = application.camera.get_camera_position();
+            m_initial_rotation = application.camera.get_camera_rotation();
+            MeshesScenario::setup(application);
+        }
+
+        void run_frame(Application& application, const size_t frame) override
+        {
+            const float angle = glm::radians(static_cast<float>(frame % 360));
+            const glm::vec3 position(-5.f * std::cos(angle), -5.f * std::sin(angle), 0.f);
+            application.camera.set_position_rotation(position, glm::vec3(0.f, 0.f, static_cast<float>(frame % 360)));
+            MeshesScenario::run_frame(application, frame);
+        }
+
+        void teardown(Application& application) override
+        {
+            application.camera.set_position_rotation(m_initial_position, m_initial_rotation);
+            MeshesScenario::teardown(application);
+        }
+
+    private:
+        glm::vec3 m_initial_position;
+        glm::vec3 m_initial_rotation;
+    };
+
+}
+
+
+std::vector<std::unique_ptr<BenchScenario>> create_bench_scenarios()
+{
+    std::vector<std::unique_ptr<BenchScenario>> scenarios;
+    for (const size_t count : { 100, 1000, 10000 })
+    {
+        scenarios.push_back(std::make_unique<MeshesScenario>(count));
+    }
+    scenarios.push_back(std::make_unique<MeshesScenario>(10000, true));
+    for (const size_t count : { 1000, 10000 })
+    {
+        scenarios.push_back(std::make_unique<MeshesScenario>(count, false, true));
+    }
+    scenarios.push_back(std::make_unique<MeshesScenario>(10000, true, true));
+    for (const size_t count : { 1000, 100000 })
+    {
+        scenarios.push_back(std::make_unique<UniformUpdatesScenario>(count));
+    }
+    for (const size_t count : { 100, 10000 })
+    {
+        scenarios.push_back(std::make_unique<BufferUploadsScenario>(count));
+    }
+    scenarios.push_back(std::make_unique<MeshPoolChurnScenario>(10000));
+    for (const size_t count : { 1000, 100000 })
+    {
+        scenarios.push_back(std::make_unique<EventFloodScenario>(count, true));
+        scenarios.push_back(std::make_unique<EventFloodScenario>(count, false));
+    }
+    scenarios.push_back(std::make_unique<TransformHierarchyScenario>(100000));
+    scenarios.push_back(std::make_unique<CameraSweepScenario>(1000));
+    return scenarios;
+}
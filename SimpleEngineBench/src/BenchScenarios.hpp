@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SimpleEngineCore/Application.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// one parameterized stress test. setup() and run_frame() are called with the GL context current
+class BenchScenario
+{
+public:
+    virtual ~BenchScenario() = default;
+
+    virtual const std::string& get_name() const { return m_name; }
+    virtual void setup(SimpleEngine::Application& application) {}
+    virtual void run_frame(SimpleEngine::Application& application, const size_t frame) = 0;
+    virtual void teardown(SimpleEngine::Application& application) {}
+
+protected:
+    BenchScenario(std::string name)
+        : m_name(std::move(name))
+    {
+    }
+
+private:
+    std::string m_name;
+};
+
+std::vector<std::unique_ptr<BenchScenario>> create_bench_scenarios();
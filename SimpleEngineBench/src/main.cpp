@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <SimpleEngineCore/Application.hpp>
+#include <SimpleEngineCore/Profiler.hpp>
+
+#include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+
+#include "BenchScenarios.hpp"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+struct BenchSettings
+{
+    size_t frames = 300;
+    size_t warmup_frames = 30;
+    std::string filter; // run only scenarios with this substring in name
+    std::string output_path; // stdout if empty
+    bool headless = true;
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    std::vector<double> frame_milliseconds;
+    std::vector<size_t> draw_calls;
+    std::vector<size_t> state_changes;
+    std::vector<size_t> redundant_state_changes;
+};
+
+class SimpleEngineBench : public SimpleEngine::Application
+{
+public:
+    SimpleEngineBench(const BenchSettings& settings)
+        : m_settings(settings)
+    {
+        for (auto& scenario : create_bench_scenarios())
+        {
+            if (m_settings.filter.empty() || scenario->get_name().find(m_settings.filter) != std::string::npos)
+            {
+                m_scenarios.push_back(std::move(scenario));
+            }
+        }
+    }
+
+    // Every scenario runs warmup + measured frames. Profiler stats of a frame are read at the start
+    // of the next one, so measuring frame i happens in frame i + 1
+    virtual void on_render() override
+    {
+        if (m_renderer.empty())
+        {
+            m_renderer = SimpleEngine::Renderer_OpenGL::get_renderer_str();
+        }
+
+        if (m_current_scenario >= m_scenarios.size())
+        {
+            close();
+            return;
+        }
+
+        BenchScenario& scenario = *m_scenarios[m_current_scenario];
+        if (m_frame == 0)
+        {
+            m_results.push_back({ scenario.get_name() });
+            scenario.setup(*this);
+        }
+        else if (m_frame > m_settings.warmup_frames)
+        {
+            const SimpleEngine::Profiler::FrameStats stats = SimpleEngine::Profiler::get_last_frame_stats();
+            m_results.back().frame_milliseconds.push_back(stats.milliseconds);
+            m_results.back().draw_calls.push_back(stats.draw_calls);
+            m_results.back().state_changes.push_back(stats.state_changes);
+            m_results.back().redundant_state_changes.push_back(stats.redundant_state_changes);
+        }
+
+        if (m_frame == m_settings.warmup_frames + m_settings.frames)
+        {
+            scenario.teardown(*this);
+            ++m_current_scenario;
+            m_frame = 0;
+            return;
+        }
+
+        scenario.run_frame(*this, m_frame);
+        ++m_frame;
+    }
+
+    const std::vector<ScenarioResult>& get_results() const { return m_results; }
+    const std::string& get_renderer() const { return m_renderer; }
+
+private:
+    BenchSettings m_settings;
+    std::vector<std::unique_ptr<BenchScenario>> m_scenarios;
+    std::vector<ScenarioResult> m_results;
+    std::string m_renderer;
+    size_t m_current_scenario = 0;
+    size_t m_frame = 0;
+};
+
+
+template<typename T>
+double percentile(std::vector<T> values, const size_t percent)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    const size_t index = std::min(values.size() - 1, values.size() * percent / 100);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return static_cast<double>(values[index]);
+}
+
+template<typename T>
+double mean(const std::vector<T>& values)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    return static_cast<double>(std::accumulate(values.begin(), values.end(), T{})) / values.size();
+}
+
+std::string escape_json(const std::string& str)
+{
+    std::string result;
+    for (const char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result;
+}
+
+void write_report(FILE* file, const BenchSettings& settings, const SimpleEngineBench& bench)
+{
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"renderer\": \"%s\",\n", escape_json(bench.get_renderer()).c_str());
+    std::fprintf(file, "  \"frames\": %zu,\n", settings.frames);
+    std::fprintf(file, "  \"warmup_frames\": %zu,\n", settings.warmup_frames);
+    std::fprintf(file, "  \"scenarios\": [");
+
+    const auto& results = bench.get_results();
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const ScenarioResult& result = results[i];
+        std::fprintf(file, "%s\n    {\n", i == 0 ? "" : ",");
+        std::fprintf(file, "      \"name\": \"%s\",\n", escape_json(result.name).c_str());
+        std::fprintf(file, "      \"frames\": %zu,\n", result.frame_milliseconds.size());
+        std::fprintf(file, "      \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            mean(result.frame_milliseconds),
+            percentile(result.frame_milliseconds, 50),
+            percentile(result.frame_milliseconds, 99),
+            percentile(result.frame_milliseconds, 100));
+        std::fprintf(file, "      \"draw_calls\": { \"mean\": %.1f, \"max\": %.0f },\n",
+            mean(result.draw_calls),
+            percentile(result.draw_calls, 100));
+        std::fprintf(file, "      \"state_changes\": { \"mean\": %.1f, \"max\": %.0f },\n",
+            mean(result.state_changes),
+            percentile(result.state_changes, 100));
+        std::fprintf(file, "      \"redundant_state_changes\": { \"mean\": %.1f, \"max\": %.0f }\n",
+            mean(result.redundant_state_changes),
+            percentile(result.redundant_state_changes, 100));
+        std::fprintf(file, "    }");
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+void print_usage()
+{
+    std::printf("Usage: SimpleEngineBench [--frames N] [--warmup N] [--filter NAME] [--output FILE] [--windowed]\n");
+}
+
+
+int main(int argc, char** argv)
+{
+    // the report goes to stdout, engine logs must not end up in the middle of the JSON
+    spdlog::set_default_logger(spdlog::stderr_color_mt("SimpleEngine"));
+
+    BenchSettings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && has_value)
+        {
+            settings.frames = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--warmup") == 0 && has_value)
+        {
+            settings.warmup_frames = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && has_value)
+        {
+            settings.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+        {
+            settings.output_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--windowed") == 0)
+        {
+            settings.headless = false;
+        }
+        else
+        {
+            print_usage();
+            return 1;
+        }
+    }
+
+    auto pSimpleEngineBench = std::make_unique<SimpleEngineBench>(settings);
+    pSimpleEngineBench->set_headless(settings.headless);
+    pSimpleEngineBench->set_demo_content(false); // only the scenario is drawn
+    pSimpleEngineBench->set_swap_interval(0); // measure the engine, not the display refresh rate
+
+    const int returnCode = pSimpleEngineBench->start(1280, 720, "SimpleEngine Bench");
+    if (returnCode != 0)
+    {
+        return returnCode;
+    }
+
+    FILE* file = settings.output_path.empty() ? stdout : std::fopen(settings.output_path.c_str(), "w");
+    if (!file)
+    {
+        std::fprintf(stderr, "Can't open %s\n", settings.output_path.c_str());
+        return 1;
+    }
+    write_report(file, settings, *pSimpleEngineBench);
+    if (file != stdout)
+    {
+        std::fclose(file);
+    }
+
+    return 0;
+}
@@ -2,8 +2,17 @@
 
 #include "SimpleEngineCore/Event.hpp"
 #include "SimpleEngineCore/Camera.hpp"
+#include "SimpleEngineCore/Registry.hpp"
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+#include "SimpleEngineCore/MeshLoader.hpp"
+#include "SimpleEngineCore/TextureLoader.hpp"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace SimpleEngine {
 
@@ -19,8 +28,28 @@ namespace SimpleEngine {
         Application& operator=(Application&&) = delete;
 
         virtual int start(unsigned int window_width, unsigned int window_height, const char* title);
+        // must be called before start(). Renders offscreen without a display, loop runs until close()
+        void set_headless(const bool headless) { m_headless = headless; }
+        bool is_headless() const { return m_headless; }
+        // must be called before start(). false - no ImGui demo window and no default quad, for benchmarks
+        void set_demo_content(const bool demo_content) { m_demo_content = demo_content; }
+        void close() { m_bCloseWindow = true; }
 
-        virtual void on_update() {}
+        // simulation runs in fixed steps: on_update is called 0..N times per frame with delta_time = 1 / rate
+        void set_fixed_update_rate(const double updates_per_second) { m_fixed_delta_time = 1.0 / updates_per_second; }
+        double get_fixed_delta_time() const { return m_fixed_delta_time; }
+        // how far (0..1) rendering is between the last and the next fixed update, for interpolating state.
+        // The scene is drawn from the camera interpolated this far from its state before the last update to the current one
+        double get_interpolation_alpha() const { return m_interpolation_alpha; }
+        // 0 - don't wait for vsync, 1 - wait for every vertical blank, ...
+        void set_swap_interval(const int swap_interval);
+        // sleeps at the end of the frame to keep at most this many frames per second. 0 - no limit
+        void set_frame_rate_limit(const double frames_per_second) { m_frame_rate_limit = frames_per_second; }
+
+        virtual void on_update(const double delta_time) {}
+
+        // called once per frame after the scene is recorded, before the UI. GL context is current
+        virtual void on_render() {}
 
         virtual void on_ui_draw() {}
 
@@ -30,18 +59,81 @@ namespace SimpleEngine {
             const bool pressed) {}
 
         glm::vec2 get_current_cursor_position() const;
+        // headless mode only: RGBA8 pixels of the last rendered frame, bottom row first. Call from on_update
+        bool read_pixels(std::vector<uint8_t>& pixels) const;
+        // closest entity with Bounds under the cursor, null entity if none
+        Entity pick_entity(const double x_pos, const double y_pos);
+        // sends event through the same listeners as window events right away (replays, benchmarks)
+        void dispatch_event(BaseEvent& event) { m_event_dispatcher.dispatch(event); }
+        // queues event like a window event, it is dispatched after the next poll
+        template<typename EventType>
+        void post_event(const EventType& event) { m_event_queue.push(event); }
+        EventDispatcher& get_event_dispatcher() { return m_event_dispatcher; }
+        const EventQueue& get_event_queue() const { return m_event_queue; }
+
+        // must be called before start(). 0 - one worker per hardware thread except the main one
+        void set_worker_count(const unsigned int worker_count) { m_worker_count = worker_count; }
+        // created in start(), on_update can schedule jobs and parallel_for on it
+        JobSystem& get_job_system() { return *m_pJobSystem; }
+        // created in start(), meshes are parsed on the job system and uploaded a bit every frame
+        MeshLoader& get_mesh_loader() { return *m_pMeshLoader; }
+        // created in start(), textures are mapped on the job system and uploaded through a staging buffer
+        TextureLoader& get_texture_loader() { return *m_pTextureLoader; }
+        // the entity gets MeshRef and Bounds once the mesh and its texture are uploaded, a failed mesh load destroys it.
+        // Drawn with the default shader, normals show up as colors multiplied by the texture (.ktx2 or .dds, optional)
+        Entity spawn_mesh(const std::string& path, const Transform& transform = {}, const std::string& texture_path = {});
+        // destroys the entity and its children in transforms, scene.destroy() alone leaves them in the hierarchy
+        void destroy_entity(const Entity entity);
+        // meshes with a lod chain are drawn at the coarsest level whose error covers at most this many pixels.
+        // 0 - always the full mesh
+        void set_lod_error_threshold(const float pixels) { m_lod_error_threshold = pixels; }
+        float get_lod_error_threshold() const { return m_lod_error_threshold; }
 
         float camera_position[3] = { 0.f, 0.f, 1.f };
         float camera_rotation[3] = { 0.f, 0.f, 0.f };
         bool perspective_camera = true;
+        // moved by on_update, rendering interpolates it between fixed updates (see get_interpolation_alpha())
         Camera camera{ glm::vec3(-5.f, 0.f, 0.f) };
+        // entities with MeshRef, Material and Bounds are drawn at their world transform when in view
+        Registry scene;
+        // destroy_entity() removes entities from both
+        TransformHierarchy transforms;
 
 
     private:
+        uint16_t get_texture_material_id(const TextureHandle texture);
+
         std::unique_ptr<class Window> m_pWindow;
+        std::unique_ptr<JobSystem> m_pJobSystem;
+        std::unique_ptr<MeshLoader> m_pMeshLoader; // after the job system, waits for its jobs
+        std::unique_ptr<TextureLoader> m_pTextureLoader;
+
+        struct PendingMesh
+        {
+            Entity entity;
+            MeshHandle mesh;
+            TextureHandle texture; // null - no texture
+        };
+        std::vector<PendingMesh> m_pending_meshes;
+        // texture handle index -> Material::material_id, ids from 1 in the order of first use
+        std::unordered_map<uint32_t, uint16_t> m_texture_material_ids;
+        unsigned int m_worker_count = 0;
 
         EventDispatcher m_event_dispatcher;
+        EventQueue m_event_queue;
         bool m_bCloseWindow = false;
+        bool m_headless = false;
+        bool m_demo_content = true;
+
+        double m_fixed_delta_time = 1.0 / 60.0;
+        double m_interpolation_alpha = 0.0;
+        // camera before the last fixed update and the one the last frame was drawn from
+        glm::vec3 m_previous_camera_position{ 0.f };
+        glm::vec3 m_previous_camera_rotation{ 0.f };
+        Camera m_render_camera;
+        int m_swap_interval = 1;
+        double m_frame_rate_limit = 0.0;
+        float m_lod_error_threshold = 1.f;
     };
 
 }
\ No newline at end of file
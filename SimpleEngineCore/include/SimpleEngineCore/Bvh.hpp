@@ -0,0 +1,88 @@
+#pragma once
+
+#include "SimpleEngineCore/Registry.hpp"
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/FrustumCuller.hpp"
+
+#include <glm/vec3.hpp>
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    struct Ray
+    {
+        glm::vec3 origin{ 0.f, 0.f, 0.f };
+        glm::vec3 direction{ 1.f, 0.f, 0.f };
+        float max_distance = FLT_MAX;
+    };
+
+    struct RayHit
+    {
+        Entity entity; // null if nothing was hit
+        float distance = FLT_MAX; // along the ray direction to the entry point of the box
+    };
+
+
+    // bounding volume hierarchy over world space boxes of entities.
+    // Nodes are one flat array, siblings next to each other, children after parents
+    class Bvh
+    {
+    public:
+        static constexpr uint32_t max_leaf_items = 4;
+
+        void build(const std::vector<Entity>& entities, const std::vector<Bounds>& world_bounds);
+        void clear();
+        bool empty() const { return m_nodes.empty(); }
+        size_t size() const { return m_entities.size(); }
+        size_t get_node_count() const { return m_nodes.size(); }
+        bool contains(const Entity entity) const
+        {
+            return entity.index < m_slots.size() && m_slots[entity.index] != invalid_index && m_entities[m_slots[entity.index]] == entity;
+        }
+
+        // moves one item and refits only its ancestors. Tree quality goes down
+        // when items move far, rebuild from time to time
+        void update(const Entity entity, const Bounds& world_bounds);
+        // moves one item without touching the nodes, call refit() after a batch of these
+        void update_bounds_only(const Entity entity, const Bounds& world_bounds);
+        // recomputes all nodes bottom-up
+        void refit();
+
+        // closest hit per ray
+        void raycast(const Ray* rays, RayHit* hits, const size_t count) const;
+        RayHit raycast(const Ray& ray) const;
+        // entities overlapping frustums[i] are appended to results[i]. Up to 32 frustums share
+        // one walk of the tree (several views, shadow cascades)
+        void query_frustum(const Frustum* frustums, std::vector<Entity>* results, const size_t count) const;
+        void query_frustum(const Frustum& frustum, std::vector<Entity>& result) const;
+        void query_box(const Bounds& box, std::vector<Entity>& result) const;
+
+    private:
+        static constexpr uint32_t invalid_index = UINT32_MAX;
+
+        struct Node
+        {
+            glm::vec3 min;
+            uint32_t first; // leaf - first item, inner node - left child, right child is first + 1
+            glm::vec3 max;
+            uint32_t count; // items in a leaf, 0 for inner nodes
+        };
+
+        void subdivide(const uint32_t node_index);
+        void update_node_bounds(const uint32_t node_index);
+        void collect_subtree(const uint32_t node_index, std::vector<Entity>& result) const;
+
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_node_parents;
+        // items ordered so every leaf owns a contiguous range
+        std::vector<Entity> m_entities;
+        std::vector<Bounds> m_bounds;
+        std::vector<glm::vec3> m_centroids; // only used while building
+        std::vector<uint32_t> m_item_leaves;
+        std::vector<uint32_t> m_slots; // entity index -> item
+    };
+
+}
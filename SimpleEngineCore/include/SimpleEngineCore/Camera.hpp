@@ -24,6 +24,8 @@ namespace SimpleEngine {
         void set_projection_mode(const ProjectionMode projection_mode);
         const glm::mat4& get_view_matrix();
         const glm::mat4& get_projection_matrix() const { return m_projection_matrix; }
+        // how many pixels one world unit covers at the given view distance, for screen space errors
+        float get_pixels_per_unit(const float distance, const float viewport_height) const;
 
         void move_forward(const float delta); // move camera forward adding to its position delta * m_direction 
         void move_right(const float delta);
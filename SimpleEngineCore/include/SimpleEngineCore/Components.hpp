@@ -0,0 +1,63 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    class VertexArray;
+    class ShaderProgram;
+    class Texture;
+
+    // local transform relative to the parent, world matrices live in TransformHierarchy
+    struct Transform
+    {
+        glm::vec3 position{ 0.f, 0.f, 0.f };
+        glm::vec3 rotation{ 0.f, 0.f, 0.f }; // degrees, X - Roll, Y - Pitch, Z - Yaw
+        glm::vec3 scale{ 1.f, 1.f, 1.f };
+    };
+
+    // one level of detail, a range of the mesh index buffer
+    struct MeshLod
+    {
+        uint32_t first_index = 0;
+        uint32_t indices_count = 0;
+        float error = 0.f; // how far the surface can be from the original, in mesh units
+    };
+
+    // part of vertex and index buffers shared with other meshes (MeshPool). The owner updates it
+    // when the mesh is moved to pack the buffers
+    struct MeshRange
+    {
+        uint32_t first_index = 0;
+        uint32_t indices_count = 0;
+        int32_t base_vertex = 0;
+    };
+
+    struct MeshRef
+    {
+        VertexArray* vertex_array = nullptr;
+        // finest first, owned by whoever owns the vertex array. Ranges are relative to range->first_index.
+        // Without lods the whole mesh is drawn
+        const MeshLod* lods = nullptr;
+        uint32_t lods_count = 0;
+        uint32_t lod = 0; // picked on the last frame, for hysteresis
+        const MeshRange* range = nullptr; // null - the whole index buffer. Read every frame, it can change
+    };
+
+    struct Material
+    {
+        ShaderProgram* shader_program = nullptr;
+        const Texture* texture = nullptr; // base color on unit 0, null - white
+        uint16_t material_id = 0; // sorts draws with the same shader
+    };
+
+    // local space axis aligned box
+    struct Bounds
+    {
+        glm::vec3 min{ -0.5f, -0.5f, -0.5f };
+        glm::vec3 max{ 0.5f, 0.5f, 0.5f };
+    };
+
+}
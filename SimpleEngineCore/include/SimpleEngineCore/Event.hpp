@@ -4,8 +4,13 @@
 
 #include "Keys.hpp"
 
-#include <functional>
 #include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace SimpleEngine {
 
@@ -32,36 +37,6 @@ namespace SimpleEngine {
     };
 
 
-    class EventDispatcher
-    {
-    public:
-        template<typename EventType>
-        void add_event_listener(std::function<void(EventType&)> callback)
-        {
-            auto baseCallback = [func = std::move(callback)](BaseEvent& e)
-                {
-                    if (e.get_type() == EventType::type)
-                    {
-                        func(static_cast<EventType&>(e));
-                    }
-                };
-            m_eventCallbacks[static_cast<size_t>(EventType::type)] = std::move(baseCallback);
-        }
-
-        void dispatch(BaseEvent& event)
-        {
-            auto& callback = m_eventCallbacks[static_cast<size_t>(event.get_type())];
-            if (callback)
-            {
-                callback(event);
-            }
-        }
-
-    private:
-        std::array<std::function<void(BaseEvent&)>, static_cast<size_t>(EventType::EventsCount)> m_eventCallbacks;
-    };
-
-
     struct EventMouseMoved : public BaseEvent
     {
         EventMouseMoved(const double new_x, const double new_y)
@@ -187,4 +162,171 @@ namespace SimpleEngine {
 
         static const EventType type = EventType::MouseButtonReleased;
     };
+
+
+    // type-erased listener of one event type. The callable is stored inline, never on the heap:
+    // capture a pointer or a reference when it doesn't fit
+    class EventListener
+    {
+    public:
+        static constexpr size_t buffer_size = 4 * sizeof(void*);
+
+        template<typename EventType, typename Callback>
+        static EventListener create(Callback&& callback)
+        {
+            using Callable = std::decay_t<Callback>;
+            static_assert(sizeof(Callable) <= buffer_size, "Listener is too big, capture less");
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "Listener alignment is not supported");
+            static_assert(std::is_invocable_v<Callable&, EventType&>, "Listener must accept the event by reference");
+
+            EventListener listener;
+            new (listener.m_storage) Callable(std::forward<Callback>(callback));
+            listener.m_invoke = [](void* storage, BaseEvent& event)
+                {
+                    (*static_cast<Callable*>(storage))(static_cast<EventType&>(event));
+                };
+            listener.m_manage = [](void* destination, void* source)
+                {
+                    // copy when there is a destination, destroy otherwise
+                    if (destination)
+                    {
+                        new (destination) Callable(*static_cast<const Callable*>(source));
+                    }
+                    else
+                    {
+                        static_cast<Callable*>(source)->~Callable();
+                    }
+                };
+            return listener;
+        }
+
+        EventListener() = default;
+        ~EventListener() { reset(); }
+
+        EventListener(const EventListener& other) { copy_from(other); }
+        EventListener& operator=(const EventListener& other)
+        {
+            if (this != &other)
+            {
+                reset();
+                copy_from(other);
+            }
+            return *this;
+        }
+
+        void operator()(BaseEvent& event) { m_invoke(m_storage, event); }
+
+    private:
+        void copy_from(const EventListener& other)
+        {
+            if (other.m_manage)
+            {
+                other.m_manage(m_storage, const_cast<unsigned char*>(other.m_storage));
+            }
+            m_invoke = other.m_invoke;
+            m_manage = other.m_manage;
+        }
+
+        void reset()
+        {
+            if (m_manage)
+            {
+                m_manage(nullptr, m_storage);
+            }
+            m_invoke = nullptr;
+            m_manage = nullptr;
+        }
+
+        alignas(std::max_align_t) unsigned char m_storage[buffer_size];
+        void (*m_invoke)(void* storage, BaseEvent& event) = nullptr;
+        void (*m_manage)(void* destination, void* source) = nullptr;
+    };
+
+
+    class EventDispatcher
+    {
+    public:
+        // every listener of the type is called, in the order they were added
+        template<typename EventType, typename Callback>
+        void add_event_listener(Callback&& callback)
+        {
+            m_listeners[static_cast<size_t>(EventType::type)].push_back(EventListener::create<EventType>(std::forward<Callback>(callback)));
+        }
+
+        // type is known at compile time, no virtual get_type()
+        template<typename EventType>
+        void dispatch(EventType& event)
+        {
+            for (EventListener& listener : m_listeners[static_cast<size_t>(EventType::type)])
+            {
+                listener(event);
+            }
+        }
+
+        void dispatch(BaseEvent& event)
+        {
+            for (EventListener& listener : m_listeners[static_cast<size_t>(event.get_type())])
+            {
+                listener(event);
+            }
+        }
+
+    private:
+        std::array<std::vector<EventListener>, static_cast<size_t>(EventType::EventsCount)> m_listeners;
+    };
+
+
+    // events collected during the frame (window callbacks push here) and dispatched at once.
+    // Consecutive mouse moves and window resizes are merged into the latest one
+    class EventQueue
+    {
+    public:
+        using Event = std::variant<EventWindowResize, EventWindowClose,
+            EventKeyPressed, EventKeyReleased,
+            EventMouseButtonPressed, EventMouseButtonReleased, EventMouseMoved>;
+
+        static constexpr size_t initial_capacity = 256;
+
+        EventQueue()
+        {
+            m_events.reserve(initial_capacity);
+            m_draining.reserve(initial_capacity);
+        }
+
+        template<typename EventType>
+        void push(const EventType& event)
+        {
+            if constexpr (std::is_same_v<EventType, EventMouseMoved> || std::is_same_v<EventType, EventWindowResize>)
+            {
+                if (!m_events.empty() && std::holds_alternative<EventType>(m_events.back()))
+                {
+                    std::get<EventType>(m_events.back()) = event;
+                    ++m_coalesced_count;
+                    return;
+                }
+            }
+            m_events.emplace_back(event);
+        }
+
+        // listeners may push new events, those are dispatched in the next drain
+        void drain(EventDispatcher& dispatcher)
+        {
+            m_draining.swap(m_events);
+            for (Event& event : m_draining)
+            {
+                std::visit([&dispatcher](auto& typed_event) { dispatcher.dispatch(typed_event); }, event);
+            }
+            m_draining.clear();
+        }
+
+        size_t size() const { return m_events.size(); }
+        bool empty() const { return m_events.empty(); }
+        // events merged into a previous one since the start
+        size_t get_coalesced_count() const { return m_coalesced_count; }
+
+    private:
+        std::vector<Event> m_events;
+        std::vector<Event> m_draining;
+        size_t m_coalesced_count = 0;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SimpleEngineCore/Registry.hpp"
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+
+#include <glm/vec4.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+
+#include <array>
+#include <vector>
+
+namespace SimpleEngine {
+
+    struct Frustum
+    {
+        // left, right, bottom, top, near, far. xyz - normal pointing inside, w - distance
+        std::array<glm::vec4, 6> planes;
+
+        static Frustum from_matrix(const glm::mat4& view_projection);
+    };
+
+
+    // box around the local box transformed by the world matrix
+    Bounds transform_bounds(const Bounds& local_bounds, const glm::mat4& world_matrix);
+
+
+    // collects world space bounds every frame and keeps the ones intersecting the frustum.
+    // Bounds are stored as separate arrays and tested 4 at a time, big sets are split into jobs
+    class FrustumCuller
+    {
+    public:
+        void clear();
+        void reserve(const size_t count);
+
+        // local box transformed by world matrix into a world space box
+        void add_box(const Entity entity, const Bounds& local_bounds, const glm::mat4& world_matrix);
+        void add_sphere(const Entity entity, const glm::vec3& center, const float radius);
+
+        // without a job system everything is tested on the calling thread
+        void cull(const glm::mat4& view_projection, JobSystem* job_system = nullptr);
+
+        // entities that passed the last cull(), in the order they were added
+        const std::vector<Entity>& get_visible() const { return m_visible; }
+        size_t get_visible_count() const { return m_visible.size(); }
+        size_t get_culled_count() const { return m_entities.size() - m_visible.size(); }
+
+    private:
+        void cull_range(const Frustum& frustum, const size_t begin, const size_t end, std::vector<uint32_t>& visible) const;
+
+        std::vector<Entity> m_entities;
+        std::vector<float> m_center_x;
+        std::vector<float> m_center_y;
+        std::vector<float> m_center_z;
+        std::vector<float> m_extent_x; // half size of boxes, 0 for spheres
+        std::vector<float> m_extent_y;
+        std::vector<float> m_extent_z;
+        std::vector<float> m_radius; // 0 for boxes
+
+        std::vector<std::vector<uint32_t>> m_chunk_visible;
+        std::vector<Entity> m_visible;
+    };
+
+}
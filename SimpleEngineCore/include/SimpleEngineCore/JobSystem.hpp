@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // one unit of work, the callable is stored inline. Internal to JobSystem
+    struct Job
+    {
+        static constexpr size_t storage_size = 64;
+
+        void (*run)(void* storage) = nullptr; // calls and destroys the callable
+        class JobCounter* counter = nullptr;
+        bool heap_allocated = false;
+        std::atomic<bool> free{ true };
+        alignas(std::max_align_t) unsigned char storage[storage_size];
+    };
+
+
+    // number of unfinished jobs. Use JobSystem::wait() before destroying it
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_pending{ 0 };
+        std::mutex m_mutex;
+        std::vector<Job*> m_continuations; // jobs waiting for this counter to reach 0
+    };
+
+
+    // fixed pool of worker threads, each with its own work-stealing deque.
+    // Idle threads take jobs from the others, waiting threads run jobs instead of blocking
+    class JobSystem
+    {
+    public:
+        // 0 - one worker per hardware thread except the calling one
+        explicit JobSystem(const unsigned int worker_count = 0);
+        // runs the jobs still queued and their continuations, then returns
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // counter - incremented now, decremented when the job finishes.
+        // dependency - the job starts only after this counter reaches 0
+        template<typename Func>
+        void schedule(Func&& func, JobCounter* counter = nullptr, JobCounter* dependency = nullptr)
+        {
+            using Callable = std::decay_t<Func>;
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "Job alignment is not supported");
+
+            Job* job = allocate_job();
+            if constexpr (sizeof(Callable) <= Job::storage_size)
+            {
+                new (job->storage) Callable(std::forward<Func>(func));
+                job->run = [](void* storage)
+                    {
+                        Callable& callable = *static_cast<Callable*>(storage);
+                        callable();
+                        callable.~Callable();
+                    };
+            }
+            else
+            {
+                // too big to be stored inline
+                new (job->storage) Callable*(new Callable(std::forward<Func>(func)));
+                job->run = [](void* storage)
+                    {
+                        Callable* callable = *static_cast<Callable**>(storage);
+                        (*callable)();
+                        delete callable;
+                    };
+            }
+            submit(job, counter, dependency);
+        }
+
+        // runs other jobs until the counter reaches 0
+        void wait(JobCounter& counter);
+
+        // func(begin, end) over [0, count) in batches of at least min_batch_size, returns when all are done
+        template<typename Func>
+        void parallel_for(const size_t count, const size_t min_batch_size, Func&& func)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            const size_t max_batches = static_cast<size_t>(get_thread_count()) * 4;
+            const size_t batches_count = std::max<size_t>(1, std::min(max_batches, count / std::max<size_t>(1, min_batch_size)));
+            const size_t batch_size = (count + batches_count - 1) / batches_count;
+            if (batches_count == 1)
+            {
+                func(size_t(0), count);
+                return;
+            }
+
+            JobCounter counter;
+            for (size_t begin = batch_size; begin < count; begin += batch_size)
+            {
+                const size_t end = std::min(count, begin + batch_size);
+                schedule([&func, begin, end]() { func(begin, end); }, &counter);
+            }
+            func(size_t(0), batch_size);
+            wait(counter);
+        }
+
+        // workers + the thread that created the system
+        unsigned int get_thread_count() const { return static_cast<unsigned int>(m_threads_data.size()); }
+
+    private:
+        struct ThreadData;
+
+        Job* allocate_job();
+        void submit(Job* job, JobCounter* counter, JobCounter* dependency);
+        void push(Job* job);
+        Job* find_job(const unsigned int thread_index);
+        void execute(Job* job);
+        void worker_main(const unsigned int thread_index);
+        unsigned int get_current_thread_index() const;
+
+        std::vector<std::unique_ptr<ThreadData>> m_threads_data; // 0 - owner thread
+        std::vector<std::thread> m_workers;
+        std::thread::id m_owner_thread_id;
+
+        // jobs from threads outside the pool and from full deques
+        std::mutex m_overflow_mutex;
+        std::vector<Job*> m_overflow_jobs;
+        std::atomic<size_t> m_overflow_count{ 0 };
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_wake_condition;
+        std::atomic<size_t> m_queued_jobs{ 0 };
+        std::atomic<unsigned int> m_sleeping_workers{ 0 };
+        std::atomic<bool> m_quit{ false };
+    };
+
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/JobSystem.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class VertexArray;
+    class MeshPool;
+
+    // geometry on the CPU side, ready to be copied into buffers as is
+    struct MeshData
+    {
+        static constexpr size_t vertex_floats = 8;
+        static constexpr size_t vertex_size = vertex_floats * sizeof(float);
+
+        // range of indices drawn with one material (one glTF primitive)
+        struct Submesh
+        {
+            uint32_t first_index = 0;
+            uint32_t indices_count = 0;
+        };
+
+        std::vector<float> vertices; // position 3, normal 3, uv 2 per vertex
+        std::vector<uint32_t> indices; // triangles
+        std::vector<Submesh> submeshes; // cover the indices of the first lod
+        std::vector<MeshLod> lods; // empty or the full mesh first, coarser levels follow in the same indices
+        Bounds bounds;
+
+        size_t get_vertices_count() const { return vertices.size() / vertex_floats; }
+    };
+
+    // parse files on the calling thread, safe to call from workers. Errors are logged
+    bool load_obj(const std::string& path, MeshData& mesh);
+    // .gltf with embedded or external buffers and .glb. All triangle primitives of the default scene
+    // are merged into one mesh in scene space
+    bool load_gltf(const std::string& path, MeshData& mesh);
+    // .smesh, the engine's own binary format (see MeshFile.hpp). Only meshes with the MeshData vertex layout
+    bool load_mesh_file(const std::string& path, MeshData& mesh);
+    // writes indices as 16 bit when there are at most 65536 vertices
+    bool save_mesh_file(const std::string& path, const MeshData& mesh);
+    // picks the format by extension
+    bool load_mesh_data(const std::string& path, MeshData& mesh);
+
+
+    enum class MeshState
+    {
+        Loading, // file is parsed on a worker
+        Uploading, // waits for its turn in the upload budget
+        Ready,
+        Failed,
+        Unloaded
+    };
+
+    struct MeshHandle
+    {
+        uint32_t index = UINT32_MAX;
+
+        bool is_null() const { return index == UINT32_MAX; }
+    };
+
+    // parses mesh files on the job system and uploads them on the GL thread a bit every frame,
+    // so big loads don't stall the frame. All methods except the parsing jobs run on the GL thread.
+    // .smesh files are only mapped and checked by the worker, buffers are filled straight from the mapping
+    class MeshLoader
+    {
+    public:
+        static constexpr size_t default_upload_budget = 8 * 1024 * 1024;
+        // pools more fragmented than this are compacted with what is left of the upload budget
+        static constexpr float default_compaction_threshold = 0.25f;
+
+        explicit MeshLoader(JobSystem& job_system);
+        // waits for parsing jobs still in flight
+        ~MeshLoader();
+
+        MeshLoader(const MeshLoader&) = delete;
+        MeshLoader& operator=(const MeshLoader&) = delete;
+
+        MeshHandle load(const std::string& path);
+        // frees the geometry of a Ready mesh. MeshRefs to it must be gone first
+        void unload(const MeshHandle handle);
+        // once per frame: takes parsed meshes and uploads at most the budget,
+        // in the order parsing finished. The rest of the budget goes to compacting pools
+        void update();
+
+        // bytes per frame, 0 - no limit. A mesh bigger than the budget is uploaded over several frames
+        void set_upload_budget(const size_t bytes_per_frame) { m_upload_budget = bytes_per_frame; }
+        size_t get_upload_budget() const { return m_upload_budget; }
+        size_t get_last_uploaded_bytes() const { return m_last_uploaded_bytes; }
+        size_t get_last_compacted_bytes() const { return m_last_compacted_bytes; }
+        // Loading and Uploading meshes
+        size_t get_pending_count() const { return m_pending_count; }
+
+        // reorder OBJ/glTF meshes for the vertex cache, overdraw and vertex fetch after parsing (see MeshOptimizer.hpp).
+        // Applies to meshes loaded after the call
+        void set_optimize_meshes(const bool optimize) { m_optimize_meshes = optimize; }
+        bool get_optimize_meshes() const { return m_optimize_meshes; }
+        // level of detail chain for OBJ/glTF meshes, stored in the same index buffer (see generate_lods())
+        void set_generate_lods(const bool generate) { m_generate_lods = generate; }
+        bool get_generate_lods() const { return m_generate_lods; }
+        // meshes with the same layout share vertex and index buffers (see MeshPool.hpp), so RenderQueue
+        // can draw them with one multi draw indirect call. Applies to meshes loaded after the call
+        void set_use_mesh_pools(const bool use) { m_use_mesh_pools = use; }
+        bool get_use_mesh_pools() const { return m_use_mesh_pools; }
+        // fragmentation (0..1) from which a pool is compacted. 0 - never compact, small values - compact on any
+        // fragmentation, 1 or more - never (fragmentation stays below 1)
+        void set_compaction_threshold(const float threshold) { m_compaction_threshold = threshold; }
+        float get_compaction_threshold() const { return m_compaction_threshold; }
+        // the most fragmented pool, see OffsetAllocator::get_fragmentation()
+        float get_fragmentation() const;
+        size_t get_pools_count() const { return m_pools.size(); }
+
+        MeshState get_state(const MeshHandle handle) const;
+        // null until the mesh is Ready. Shared with other meshes when the mesh is in a pool
+        VertexArray* get_vertex_array(const MeshHandle handle) const;
+        // vertex array, range in its buffers and lods, empty until the mesh is Ready
+        MeshRef get_mesh_ref(const MeshHandle handle) const;
+        // valid from Uploading on
+        const Bounds& get_bounds(const MeshHandle handle) const;
+        const std::vector<MeshData::Submesh>& get_submeshes(const MeshHandle handle) const;
+        // empty when the mesh has one level. Addresses don't change, MeshRef can point here
+        const std::vector<MeshLod>& get_lods(const MeshHandle handle) const;
+
+    private:
+        struct Mesh;
+
+        static bool parse(Mesh& mesh);
+        bool upload(Mesh& mesh, size_t& budget);
+        MeshPool* get_pool(const Mesh& mesh);
+
+        JobSystem& m_job_system;
+        JobCounter m_parsing_jobs;
+        std::vector<std::unique_ptr<Mesh>> m_meshes;
+        std::vector<std::unique_ptr<MeshPool>> m_pools;
+
+        // filled by workers, taken by update()
+        std::mutex m_parsed_mutex;
+        std::vector<uint32_t> m_parsed;
+
+        std::vector<uint32_t> m_upload_queue;
+        size_t m_upload_queue_first = 0;
+        size_t m_upload_budget = default_upload_budget;
+        size_t m_last_uploaded_bytes = 0;
+        size_t m_last_compacted_bytes = 0;
+        float m_compaction_threshold = default_compaction_threshold;
+        size_t m_pending_count = 0;
+        bool m_optimize_meshes = true;
+        bool m_generate_lods = true;
+        bool m_use_mesh_pools = true;
+    };
+
+}
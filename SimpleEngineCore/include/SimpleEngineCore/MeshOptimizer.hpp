@@ -0,0 +1,66 @@
+#pragma once
+
+#include "SimpleEngineCore/MeshLoader.hpp"
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // post-transform cache is modeled as a FIFO, which is close enough to real hardware to compare orders
+    constexpr size_t default_vertex_cache_size = 16;
+
+    struct VertexCacheStatistics
+    {
+        size_t vertices_transformed = 0;
+        float acmr = 0.f; // transformed vertices per triangle, 3 at worst, ~0.5 at best on regular grids
+        float atvr = 0.f; // transformed vertices per referenced vertex, 1 at best
+    };
+
+    VertexCacheStatistics analyze_vertex_cache(const uint32_t* indices, const size_t indices_count, const size_t vertices_count,
+        const size_t cache_size = default_vertex_cache_size);
+
+    // reorders triangles in place for post-transform cache hits (Tipsify, Sander et al. 2007)
+    void optimize_vertex_cache(uint32_t* indices, const size_t indices_count, const size_t vertices_count,
+        const size_t cache_size = default_vertex_cache_size);
+
+    // reorders triangles in place so that outer parts of the mesh are drawn first and hide the inner ones.
+    // Expects a cache optimized order: it is cut into clusters where that costs at most threshold times the ACMR,
+    // then the clusters are sorted. Positions are the first 3 floats of each vertex
+    void optimize_overdraw(uint32_t* indices, const size_t indices_count, const float* vertices, const size_t vertices_count,
+        const size_t vertex_stride_floats, const float threshold = 1.05f, const size_t cache_size = default_vertex_cache_size);
+
+    // new vertex order = order of the first use in indices, so vertex fetch goes through memory forward.
+    // remap[old_index] is the new index, UINT32_MAX for vertices no triangle uses. Returns the used vertices count
+    size_t build_vertex_fetch_remap(std::vector<uint32_t>& remap, const uint32_t* indices, const size_t indices_count, const size_t vertices_count);
+
+    struct MeshOptimizationStatistics
+    {
+        VertexCacheStatistics before;
+        VertexCacheStatistics after;
+    };
+
+    // vertex cache and overdraw order inside every submesh (submesh ranges don't change),
+    // then vertex fetch order for the whole mesh. Unused vertices are dropped. Run it before generate_lods()
+    MeshOptimizationStatistics optimize_mesh(MeshData& mesh);
+
+
+    // quadric error edge collapse (Garland, Heckbert 1997). Vertices are only removed, never moved or added,
+    // so the result indexes the same vertex buffer. Border, seam and non-manifold vertices are kept.
+    // Stops at target_indices_count or before a collapse that would cost more than max_error.
+    // Returns the error reached, in mesh units
+    float simplify(std::vector<uint32_t>& result, const uint32_t* indices, const size_t indices_count, const float* vertices, const size_t vertices_count,
+        const size_t vertex_stride_floats, const size_t target_indices_count, const float max_error = FLT_MAX);
+
+    // fills mesh.lods: each level has about ratio times the triangles of the previous one and is appended to mesh.indices.
+    // max_relative_error is a fraction of the bounds diagonal. Stops early when the error limit doesn't let it go lower
+    void generate_lods(MeshData& mesh, const size_t max_lods_count = 5, const float ratio = 0.5f, const float max_relative_error = 0.05f);
+
+    // coarsest lod with error under threshold_pixels on screen. The current lod is only left when
+    // the error crosses the threshold by the hysteresis fraction, so objects at the switching distance don't pop back and forth
+    uint32_t select_lod(const MeshLod* lods, const uint32_t lods_count, const uint32_t current_lod, const float pixels_per_unit,
+        const float threshold_pixels = 1.f, const float hysteresis = 0.2f);
+
+}
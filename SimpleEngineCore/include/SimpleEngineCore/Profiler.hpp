@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    class Profiler {
+    public:
+        static constexpr size_t history_size = 256; // frames
+
+        struct FrameStats
+        {
+            double milliseconds = 0.0;
+            size_t draw_calls = 0;
+            size_t state_changes = 0;
+            size_t redundant_state_changes = 0; // skipped by the GL state cache
+        };
+
+        static void begin_frame();
+        static void end_frame();
+
+        // name must be a string literal (or live as long as the profiler), sections are found by name
+        static void add_cpu_time(const char* name, const double milliseconds);
+        static void add_gpu_time(const char* name, const double milliseconds);
+
+        static void add_draw_call() { ++s_draw_calls; }
+        static void add_state_change() { ++s_state_changes; }
+        static void add_redundant_state_change() { ++s_redundant_state_changes; }
+
+        // stats of the last finished frame
+        static FrameStats get_last_frame_stats();
+
+        static void on_ui_draw();
+
+    private:
+        static size_t s_draw_calls;
+        static size_t s_state_changes;
+        static size_t s_redundant_state_changes;
+    };
+
+
+    // measures CPU time from construction to destruction
+    class ProfileScope {
+    public:
+        ProfileScope(const char* name)
+            : m_name(name)
+            , m_start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~ProfileScope()
+        {
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+            Profiler::add_cpu_time(m_name, elapsed.count());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+}
+
+#define PROFILE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ::SimpleEngine::ProfileScope PROFILE_SCOPE_CONCAT(profile_scope_, __LINE__)(name)
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // stable handle: slot index + generation of the slot, so a handle of a destroyed entity
+    // never points to a new entity that reused the slot
+    struct Entity
+    {
+        static constexpr uint32_t invalid_index = UINT32_MAX;
+
+        uint32_t index = invalid_index;
+        uint32_t generation = 0;
+
+        bool is_null() const { return index == invalid_index; }
+        bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Entity& other) const { return !(*this == other); }
+    };
+
+
+    // sparse set: sparse[entity index] -> position in the dense arrays.
+    // Entities and components are kept in separate tightly packed arrays
+    class BaseComponentPool
+    {
+    public:
+        virtual ~BaseComponentPool() = default;
+
+        virtual void remove(const Entity entity) = 0;
+
+        // the stored handle is compared too, a stale handle to a reused slot doesn't match
+        bool contains(const Entity entity) const
+        {
+            return entity.index < m_sparse.size() && m_sparse[entity.index] != invalid_position
+                && m_entities[m_sparse[entity.index]] == entity;
+        }
+        size_t size() const { return m_entities.size(); }
+        const std::vector<Entity>& get_entities() const { return m_entities; }
+
+    protected:
+        static constexpr uint32_t invalid_position = UINT32_MAX;
+
+        std::vector<uint32_t> m_sparse;
+        std::vector<Entity> m_entities;
+    };
+
+
+    template<typename Component>
+    class ComponentPool : public BaseComponentPool
+    {
+    public:
+        template<typename... Args>
+        Component& emplace(const Entity entity, Args&&... args)
+        {
+            if (entity.index >= m_sparse.size())
+            {
+                m_sparse.resize(entity.index + 1, invalid_position);
+            }
+
+            if (m_sparse[entity.index] != invalid_position)
+            {
+                m_entities[m_sparse[entity.index]] = entity;
+                Component& component = m_components[m_sparse[entity.index]];
+                component = Component{ std::forward<Args>(args)... };
+                return component;
+            }
+
+            m_sparse[entity.index] = static_cast<uint32_t>(m_entities.size());
+            m_entities.push_back(entity);
+            m_components.push_back(Component{ std::forward<Args>(args)... });
+            return m_components.back();
+        }
+
+        // swap with the last one and pop, order of the rest is not kept
+        void remove(const Entity entity) override
+        {
+            if (!contains(entity))
+            {
+                return;
+            }
+
+            const uint32_t position = m_sparse[entity.index];
+            const uint32_t last = static_cast<uint32_t>(m_entities.size() - 1);
+            if (position != last)
+            {
+                m_entities[position] = m_entities[last];
+                m_components[position] = std::move(m_components[last]);
+                m_sparse[m_entities[position].index] = position;
+            }
+            m_entities.pop_back();
+            m_components.pop_back();
+            m_sparse[entity.index] = invalid_position;
+        }
+
+        Component& get(const Entity entity) { return m_components[m_sparse[entity.index]]; }
+        const Component& get(const Entity entity) const { return m_components[m_sparse[entity.index]]; }
+        Component* try_get(const Entity entity) { return contains(entity) ? &get(entity) : nullptr; }
+
+        // dense array, same order as get_entities()
+        std::vector<Component>& get_components() { return m_components; }
+        const std::vector<Component>& get_components() const { return m_components; }
+
+        void reserve(const size_t count)
+        {
+            m_entities.reserve(count);
+            m_components.reserve(count);
+        }
+
+        // puts shared entities first in the order of the other pool, so a view led by the other pool
+        // walks this one sequentially too
+        void arrange_like(const BaseComponentPool& other)
+        {
+            uint32_t position = 0;
+            for (const Entity entity : other.get_entities())
+            {
+                if (!contains(entity))
+                {
+                    continue;
+                }
+                const uint32_t current = m_sparse[entity.index];
+                if (current != position)
+                {
+                    std::swap(m_entities[current], m_entities[position]);
+                    std::swap(m_components[current], m_components[position]);
+                    m_sparse[m_entities[current].index] = current;
+                    m_sparse[m_entities[position].index] = position;
+                }
+                ++position;
+            }
+        }
+
+    private:
+        std::vector<Component> m_components;
+    };
+
+
+    // entities having all of the components. Iterates the smallest pool and looks up the rest.
+    // Don't add or remove these components while iterating
+    template<typename... Components>
+    class View
+    {
+    public:
+        View(ComponentPool<Components>&... pools)
+            : m_pools(&pools...)
+        {
+        }
+
+        // func(Entity, Components&...)
+        template<typename Func>
+        void each(Func&& func)
+        {
+            if constexpr (sizeof...(Components) == 1)
+            {
+                auto& pool = *std::get<0>(m_pools);
+                const std::vector<Entity>& entities = pool.get_entities();
+                auto& components = pool.get_components();
+                for (size_t i = 0; i < entities.size(); ++i)
+                {
+                    func(entities[i], components[i]);
+                }
+            }
+            else
+            {
+                for (const Entity entity : get_smallest_pool().get_entities())
+                {
+                    if ((std::get<ComponentPool<Components>*>(m_pools)->contains(entity) && ...))
+                    {
+                        func(entity, std::get<ComponentPool<Components>*>(m_pools)->get(entity)...);
+                    }
+                }
+            }
+        }
+
+        // upper bound of the number of entities in the view
+        size_t size_hint() const { return get_smallest_pool().size(); }
+
+    private:
+        const BaseComponentPool& get_smallest_pool() const
+        {
+            const BaseComponentPool* smallest = std::get<0>(m_pools);
+            ((smallest = std::get<ComponentPool<Components>*>(m_pools)->size() < smallest->size() ? std::get<ComponentPool<Components>*>(m_pools) : smallest), ...);
+            return *smallest;
+        }
+
+        std::tuple<ComponentPool<Components>*...> m_pools;
+    };
+
+
+    class Registry
+    {
+    public:
+        Registry() = default;
+
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        Entity create();
+        // removes all components of the entity, the handle becomes invalid.
+        // Doesn't know about TransformHierarchy, Application::destroy_entity() removes it from both
+        void destroy(const Entity entity);
+        bool is_valid(const Entity entity) const
+        {
+            // destroy() bumps the generation, so handles of free slots never match
+            return entity.index < m_generations.size() && m_generations[entity.index] == entity.generation;
+        }
+        size_t get_alive_count() const { return m_generations.size() - m_free_indices.size(); }
+
+        template<typename Component, typename... Args>
+        Component& emplace(const Entity entity, Args&&... args)
+        {
+            return get_pool<Component>().emplace(entity, std::forward<Args>(args)...);
+        }
+
+        template<typename Component>
+        void remove(const Entity entity) { get_pool<Component>().remove(entity); }
+
+        template<typename Component>
+        bool has(const Entity entity) { return get_pool<Component>().contains(entity); }
+
+        // entity must have the component
+        template<typename Component>
+        Component& get(const Entity entity) { return get_pool<Component>().get(entity); }
+
+        template<typename Component>
+        Component* try_get(const Entity entity) { return get_pool<Component>().try_get(entity); }
+
+        template<typename... Components>
+        View<Components...> view() { return View<Components...>(get_pool<Components>()...); }
+
+        template<typename Component>
+        ComponentPool<Component>& get_pool()
+        {
+            const size_t type_id = get_component_type_id<Component>();
+            if (type_id >= m_pools.size())
+            {
+                m_pools.resize(type_id + 1);
+            }
+            if (!m_pools[type_id])
+            {
+                m_pools[type_id] = std::make_unique<ComponentPool<Component>>();
+            }
+            return static_cast<ComponentPool<Component>&>(*m_pools[type_id]);
+        }
+
+        // reorders Component pool to follow Leader pool, call after bulk creation
+        template<typename Component, typename Leader>
+        void arrange_like() { get_pool<Component>().arrange_like(get_pool<Leader>()); }
+
+    private:
+        static size_t next_component_type_id()
+        {
+            static size_t s_next_type_id = 0;
+            return s_next_type_id++;
+        }
+
+        template<typename Component>
+        static size_t get_component_type_id()
+        {
+            static const size_t s_type_id = next_component_type_id();
+            return s_type_id;
+        }
+
+        std::vector<uint32_t> m_generations;
+        std::vector<uint32_t> m_free_indices;
+        std::vector<std::unique_ptr<BaseComponentPool>> m_pools;
+    };
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "SimpleEngineCore/JobSystem.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    class Texture;
+    class StagingBuffer;
+
+    enum class TextureState
+    {
+        Loading, // file is mapped and checked on a worker
+        Uploading, // storage is created, rows go through the staging buffer a bit every frame
+        Ready,
+        Failed
+    };
+
+    struct TextureHandle
+    {
+        uint32_t index = UINT32_MAX;
+
+        bool is_null() const { return index == UINT32_MAX; }
+    };
+
+    // loads .ktx2 and .dds textures (see TextureFile.hpp) without stalling the frame. Workers map the file
+    // and copy rows of the images into a persistently mapped staging buffer, the GL thread only issues
+    // the copies from it into the texture (pixel unpack buffer) and fences them.
+    // Block compressed data is never decompressed, mip levels come from the file.
+    // All methods except the jobs run on the GL thread
+    class TextureLoader
+    {
+    public:
+        static constexpr size_t default_upload_budget = 8 * 1024 * 1024;
+        static constexpr size_t default_staging_size = 32 * 1024 * 1024;
+
+        // staging_size - memory shared by the copies in flight, the GPU releases it a few frames later
+        explicit TextureLoader(JobSystem& job_system, const size_t staging_size = default_staging_size);
+        // waits for jobs still in flight
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader&) = delete;
+        TextureLoader& operator=(const TextureLoader&) = delete;
+
+        TextureHandle load(const std::string& path);
+        // once per frame: issues the copies filled since the last call, creates textures for parsed files
+        // and hands at most the budget of new rows to the workers, in the order parsing finished
+        void update();
+        // deletes textures and the staging buffer, needs the context. Handles stay valid, get_texture() returns null
+        // and textures still loading are Failed
+        void shutdown();
+
+        // bytes per frame, 0 - as much as the staging buffer takes. At least one row goes every frame
+        void set_upload_budget(const size_t bytes_per_frame) { m_upload_budget = bytes_per_frame; }
+        size_t get_upload_budget() const { return m_upload_budget; }
+        size_t get_last_uploaded_bytes() const { return m_last_uploaded_bytes; }
+        // Loading and Uploading textures
+        size_t get_pending_count() const { return m_pending_count; }
+        // all Ready textures on the GPU
+        size_t get_memory_size() const { return m_memory_size; }
+
+        TextureState get_state(const TextureHandle handle) const;
+        // null until the texture is Ready
+        Texture* get_texture(const TextureHandle handle) const;
+
+    private:
+        struct Entry;
+        // rows of one image copied by a worker into the staging buffer
+        struct Piece
+        {
+            uint32_t entry;
+            uint32_t level;
+            uint32_t layer;
+            uint32_t first_row;
+            uint32_t rows_count;
+            size_t staging_offset;
+            bool last; // the texture is complete once this one is issued
+        };
+
+        bool create_texture(Entry& entry);
+        // next rows of the texture within the budget. True when all of them are reserved
+        bool reserve_pieces(const uint32_t index, size_t& budget);
+        void issue_pieces();
+
+        JobSystem& m_job_system;
+        JobCounter m_parsing_jobs;
+        JobCounter m_copy_jobs;
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        std::unique_ptr<StagingBuffer> m_staging_buffer;
+        size_t m_staging_size;
+
+        // filled by workers, taken by update()
+        std::mutex m_parsed_mutex;
+        std::vector<uint32_t> m_parsed;
+
+        std::vector<uint32_t> m_upload_queue;
+        size_t m_upload_queue_first = 0;
+        std::vector<Piece> m_pieces; // copied by the jobs of m_copy_jobs, issued by the next update()
+        size_t m_upload_budget = default_upload_budget;
+        size_t m_last_uploaded_bytes = 0;
+        size_t m_pending_count = 0;
+        size_t m_memory_size = 0;
+    };
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SimpleEngineCore/Registry.hpp"
+#include "SimpleEngineCore/Components.hpp"
+
+#include <glm/ext/matrix_float4x4.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // local and world transforms of entities. Local transforms are kept as separate float arrays,
+    // parents are always stored before their children, so update() is one pass that recomputes
+    // only the changed nodes and everything below them
+    class TransformHierarchy
+    {
+    public:
+        // parent must be added already, null parent - root node
+        void add(const Entity entity, const Transform& local = {}, const Entity parent = {});
+        // removes the entity together with its children, removed - appended with all of them
+        void remove(const Entity entity, std::vector<Entity>* removed = nullptr);
+        void set_parent(const Entity entity, const Entity parent);
+        bool contains(const Entity entity) const
+        {
+            return entity.index < m_sparse.size() && m_sparse[entity.index] != invalid_position && m_entities[m_sparse[entity.index]] == entity;
+        }
+        size_t size() const { return m_entities.size(); }
+
+        Transform get_local(const Entity entity) const;
+        void set_local(const Entity entity, const Transform& local);
+
+        // valid after update()
+        const glm::mat4& get_world_matrix(const Entity entity) const { return m_world_matrices[m_sparse[entity.index]]; }
+        // world matrices in storage order, same order as get_entities()
+        const std::vector<glm::mat4>& get_world_matrices() const { return m_world_matrices; }
+        const std::vector<Entity>& get_entities() const { return m_entities; }
+
+        void update();
+        // nodes recomputed by the last update()
+        size_t get_last_update_count() const { return m_last_update_count; }
+
+    private:
+        enum LocalComponent
+        {
+            PositionX, PositionY, PositionZ,
+            RotationX, RotationY, RotationZ,
+            ScaleX, ScaleY, ScaleZ,
+            LocalComponentsCount
+        };
+
+        static constexpr uint32_t invalid_position = UINT32_MAX;
+
+        void compose_local_matrices();
+        // new_positions[old position] -> new position or invalid_position to drop the node
+        void apply_order(const std::vector<uint32_t>& new_positions);
+        void restore_order();
+
+        std::vector<Entity> m_entities;
+        std::vector<uint32_t> m_parents; // position of the parent or invalid_position
+        std::array<std::vector<float>, LocalComponentsCount> m_local;
+        std::vector<uint8_t> m_dirty;
+        std::vector<glm::mat4> m_world_matrices;
+        std::vector<uint32_t> m_sparse; // entity index -> position
+
+        std::vector<uint8_t> m_changed; // scratch of update()
+        std::vector<uint32_t> m_update_list;
+        std::vector<glm::mat4> m_local_matrices;
+        bool m_order_dirty = false;
+        size_t m_last_update_count = 0;
+    };
+
+}
@@ -3,6 +3,10 @@
 #include "SimpleEngineCore/Window.hpp"
 #include "SimpleEngineCore/Event.hpp"
 #include "SimpleEngineCore/Input.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+#include "SimpleEngineCore/FrustumCuller.hpp"
+#include "SimpleEngineCore/Bvh.hpp"
+#include "SimpleEngineCore/MeshOptimizer.hpp"
 
 #include "SimpleEngineCore/Rendering/OpenGL/ShaderProgram.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
@@ -10,13 +14,22 @@
 #include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
 #include "SimpleEngineCore/Camera.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/RenderQueue.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/GpuTimer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/SamplerCache.hpp"
 #include "SimpleEngineCore/Modules/UIModule.hpp"
 
 #include <imgui/imgui.h>
 #include <glm/mat3x3.hpp>
 #include <glm/trigonometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/geometric.hpp>
 #include <GLFW/glfw3.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
 
 namespace SimpleEngine {
 
@@ -35,21 +48,27 @@ namespace SimpleEngine {
 		R"(#version 460
            layout(location = 0) in vec3 vertex_position;
            layout(location = 1) in vec3 vertex_color;
-           uniform mat4 model_matrix;
+           layout(location = 2) in vec2 vertex_uv;
+           layout(std430, binding = 0) readonly buffer Transforms { mat4 model_matrices[]; };
+           uniform int transforms_offset;
            uniform mat4 view_projection_matrix;
            out vec3 color;
+           out vec2 uv;
            void main() {
               color = vertex_color;
-              gl_Position = view_projection_matrix * model_matrix * vec4(vertex_position, 1.0);
+              uv = vertex_uv;
+              gl_Position = view_projection_matrix * model_matrices[transforms_offset + gl_DrawID] * vec4(vertex_position, 1.0);
            }
         )";
 
 	const char* fragment_shader =
 		R"(#version 460
            in vec3 color;
+           in vec2 uv;
+           layout(binding = 0) uniform sampler2D base_color_texture;
            out vec4 frag_color;
            void main() {
-              frag_color = vec4(color, 1.0);
+              frag_color = vec4(color, 1.0) * texture(base_color_texture, uv);
            }
         )";
 
@@ -57,11 +76,47 @@ namespace SimpleEngine {
 	std::unique_ptr<VertexBuffer> p_positions_colors_vbo;
 	std::unique_ptr<IndexBuffer> p_index_buffer;
 	std::unique_ptr<VertexArray> p_vao;
-	float scale[3] = { 1.f, 1.f, 1.f };
-	float rotate = 0.f;
-	float translate[3] = { 0.f, 0.f, 0.f };
+	RenderQueue render_queue;
+	Entity quad_entity;
+	FrustumCuller frustum_culler;
+	Bvh scene_bvh;
+	bool scene_bvh_dirty = true; // transforms changed since the tree was updated
+	// fewer draws are recorded on one thread
+	static constexpr size_t min_draws_per_command_list = 1024;
+	// fraction of the lod error threshold an object has to cross before its lod changes
+	static constexpr float lod_hysteresis = 0.2f;
 	float m_background_color[4] = { 0.33f, 0.33f, 0.33f, 0.f };
 
+	// shortest way between two angles in degrees, so 350 -> 10 doesn't spin through 180
+	static glm::vec3 interpolate_angles(const glm::vec3& from, const glm::vec3& to, const float alpha)
+	{
+		glm::vec3 result;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float delta = std::fmod(std::fmod(to[axis] - from[axis], 360.f) + 540.f, 360.f) - 180.f;
+			result[axis] = from[axis] + delta * alpha;
+		}
+		return result;
+	}
+
+	// pixels per mesh unit at the point of the bounds closest to the camera, lod errors are in mesh units
+	static float get_lod_pixels_per_unit(const Camera& camera, const glm::mat4& model_matrix, const Bounds& bounds, const float viewport_height)
+	{
+		// the longest axis, errors can't grow more than that
+		float scale_squared = 0.f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const glm::vec4& column = model_matrix[axis];
+			scale_squared = std::max(scale_squared, column.x * column.x + column.y * column.y + column.z * column.z);
+		}
+		const float scale = std::sqrt(scale_squared);
+		const glm::vec4 center = model_matrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.f);
+		const float radius = glm::length(bounds.max - bounds.min) * 0.5f * scale;
+		const float distance = glm::length(glm::vec3(center.x, center.y, center.z) - camera.get_camera_position()) - radius;
+		return camera.get_pixels_per_unit(distance, viewport_height) * scale;
+	}
+
+
 	Application::Application()
 	{
 		LOG_INFO("Starting Application");
@@ -76,7 +131,21 @@ namespace SimpleEngine {
 
 	int Application::start(unsigned int window_width, unsigned int window_height, const char* title)
 	{
-		m_pWindow = std::make_unique<Window>(title, window_width, window_height);
+		m_pJobSystem = std::make_unique<JobSystem>(m_worker_count);
+		LOG_INFO("Job system: {0} threads", m_pJobSystem->get_thread_count());
+		m_pMeshLoader = std::make_unique<MeshLoader>(*m_pJobSystem);
+		m_pTextureLoader = std::make_unique<TextureLoader>(*m_pJobSystem);
+
+		m_pWindow = std::make_unique<Window>(title, window_width, window_height, m_headless);
+		if (!m_pWindow->is_initialized())
+		{
+			// GL functions aren't loaded, nothing below may run
+			LOG_CRITICAL("Can't start Application: window or OpenGL context creation failed");
+			m_pWindow = nullptr;
+			return -1;
+		}
+		m_pWindow->set_event_queue(m_event_queue);
+		m_pWindow->set_swap_interval(m_swap_interval);
 
 		m_event_dispatcher.add_event_listener<EventMouseMoved>(
 			[](EventMouseMoved& event)
@@ -141,12 +210,6 @@ namespace SimpleEngine {
 				Input::ReleaseKey(event.key_code);
 			});
 
-		m_pWindow->set_event_callback(
-			[&](BaseEvent& event)
-			{
-				m_event_dispatcher.dispatch(event);
-			}
-		);
 
 
 		//---------------------------------------//
@@ -168,77 +231,402 @@ namespace SimpleEngine {
 			ShaderDataType::Float3
 		};
 
-		p_vao = std::make_unique<VertexArray>();
-		p_positions_colors_vbo = std::make_unique<VertexBuffer>(positions_colors2, sizeof(positions_colors2), buffer_layout_2vec3);
-		p_index_buffer = std::make_unique<IndexBuffer>(indices, sizeof(indices) / sizeof(GLuint));
-
-		p_vao->add_vertex_buffer(*p_positions_colors_vbo);
-		p_vao->set_index_buffer(*p_index_buffer);
+		if (m_demo_content)
+		{
+			p_vao = std::make_unique<VertexArray>();
+			p_positions_colors_vbo = std::make_unique<VertexBuffer>(positions_colors2, sizeof(positions_colors2), buffer_layout_2vec3);
+			p_index_buffer = std::make_unique<IndexBuffer>(indices, sizeof(indices) / sizeof(GLuint));
+
+			p_vao->add_vertex_buffer(*p_positions_colors_vbo);
+			p_vao->set_index_buffer(*p_index_buffer);
+
+			quad_entity = scene.create();
+			transforms.add(quad_entity);
+			scene.emplace<MeshRef>(quad_entity, p_vao.get());
+			scene.emplace<Material>(quad_entity, p_shader_program.get());
+			scene.emplace<Bounds>(quad_entity, glm::vec3(0.f, -0.5f, -0.5f), glm::vec3(0.f, 0.5f, 0.5f));
+		}
 		//---------------------------------------//
 
 
+		using clock = std::chrono::steady_clock;
+		// longer frames (breakpoints, window drag) don't make simulation catch up for seconds
+		constexpr double max_frame_time = 0.25;
+		clock::time_point previous_frame_start = clock::now();
+		double update_time_accumulator = 0.0;
+		m_previous_camera_position = camera.get_camera_position();
+		m_previous_camera_rotation = camera.get_camera_rotation();
+
 		while (!m_bCloseWindow)
 		{
-			Renderer_OpenGL::set_clear_color(m_background_color[0], m_background_color[1], m_background_color[2], m_background_color[3]);
-			Renderer_OpenGL::clear();
+			const clock::time_point frame_start = clock::now();
+			const double frame_time = std::chrono::duration<double>(frame_start - previous_frame_start).count();
+			previous_frame_start = frame_start;
+			update_time_accumulator += std::min(frame_time, max_frame_time);
+
+			Profiler::begin_frame();
+
+			{
+				PROFILE_SCOPE("Clear");
+				GpuTimerScope gpu_scope("Clear");
+				Renderer_OpenGL::set_clear_color(m_background_color[0], m_background_color[1], m_background_color[2], m_background_color[3]);
+				Renderer_OpenGL::clear();
+			}
+
+			{
+				PROFILE_SCOPE("Mesh uploads");
+				m_pMeshLoader->update();
+				m_pTextureLoader->update();
+				for (size_t i = 0; i < m_pending_meshes.size();)
+				{
+					const PendingMesh pending = m_pending_meshes[i];
+					const MeshState state = m_pMeshLoader->get_state(pending.mesh);
+					// a failed texture leaves the mesh white
+					const TextureState texture_state = pending.texture.is_null() ? TextureState::Failed : m_pTextureLoader->get_state(pending.texture);
+					const bool texture_done = texture_state == TextureState::Ready || texture_state == TextureState::Failed;
+					if (state == MeshState::Ready && !texture_done)
+					{
+						++i;
+						continue;
+					}
+					if (state == MeshState::Ready && scene.is_valid(pending.entity))
+					{
+						scene.emplace<MeshRef>(pending.entity, m_pMeshLoader->get_mesh_ref(pending.mesh));
+						scene.emplace<Bounds>(pending.entity, m_pMeshLoader->get_bounds(pending.mesh));
+						scene.get_pool<Material>().get(pending.entity).texture = m_pTextureLoader->get_texture(pending.texture);
+					}
+					else if (state == MeshState::Failed && scene.is_valid(pending.entity))
+					{
+						destroy_entity(pending.entity);
+					}
+					else if (state != MeshState::Ready && state != MeshState::Failed)
+					{
+						++i;
+						continue;
+					}
+					m_pending_meshes[i] = m_pending_meshes.back();
+					m_pending_meshes.pop_back();
+				}
+			}
 
-			p_shader_program->bind();
+			{
+				PROFILE_SCOPE("Scene");
+				GpuTimerScope gpu_scope("Scene");
 
-			glm::mat4 scale_matrix(scale[0], 0, 0, 0,
-				0, scale[1], 0, 0,
-				0, 0, scale[2], 0,
-				0, 0, 0, 1);
+				// the camera moves in fixed steps, drawing it where it is between them keeps motion smooth
+				camera.set_projection_mode(perspective_camera ? Camera::ProjectionMode::Perspective : Camera::ProjectionMode::Orthographic);
+				const float alpha = static_cast<float>(m_interpolation_alpha);
+				m_render_camera = camera;
+				m_render_camera.set_position_rotation(
+					m_previous_camera_position + (camera.get_camera_position() - m_previous_camera_position) * alpha,
+					interpolate_angles(m_previous_camera_rotation, camera.get_camera_rotation(), alpha));
+				const glm::mat4 view_projection_matrix = m_render_camera.get_projection_matrix() * m_render_camera.get_view_matrix();
 
-			float rotate_in_radians = glm::radians(rotate);
-			glm::mat4 rotate_matrix(cos(rotate_in_radians), sin(rotate_in_radians), 0, 0,
-				-sin(rotate_in_radians), cos(rotate_in_radians), 0, 0,
-				0, 0, 1, 0,
-				0, 0, 0, 1);
+				transforms.update();
+				scene_bvh_dirty = true;
 
-			glm::mat4 translate_matrix(1, 0, 0, 0,
-				0, 1, 0, 0,
-				0, 0, 1, 0,
-				translate[0], translate[1], translate[2], 1);
+				{
+					PROFILE_SCOPE("Culling");
+					// linear on purpose: world bounds change every frame, so keeping scene_bvh for culling would
+					// walk every entity anyway. The culler does that pass with SIMD on the job system
+					frustum_culler.clear();
+					scene.view<MeshRef, Material, Bounds>().each(
+						[&](const Entity entity, MeshRef& mesh, Material& material, Bounds& bounds)
+						{
+							if (transforms.contains(entity))
+							{
+								frustum_culler.add_box(entity, bounds, transforms.get_world_matrix(entity));
+							}
+						});
+					frustum_culler.cull(view_projection_matrix, m_pJobSystem.get());
+				}
 
-			glm::mat4 model_matrix = translate_matrix * rotate_matrix * scale_matrix;
-			p_shader_program->setMatrix4("model_matrix", model_matrix);
+				{
+					PROFILE_SCOPE("Recording");
+					// no GL calls here: workers fill one command list each for a slice of the visible entities.
+					// Pools are taken on this thread, get_pool() can create them.
+					// Every entity is visited by one worker, so its MeshRef::lod can be written
+					ComponentPool<MeshRef>& meshes = scene.get_pool<MeshRef>();
+					const ComponentPool<Material>& materials = scene.get_pool<Material>();
+					const ComponentPool<Bounds>& bounds_pool = scene.get_pool<Bounds>();
+					const float viewport_height = static_cast<float>(m_pWindow->get_height());
+					const std::vector<Entity>& visible = frustum_culler.get_visible();
+					const size_t lists_count = std::max<size_t>(1, std::min<size_t>(m_pJobSystem->get_thread_count(), visible.size() / min_draws_per_command_list));
+					render_queue.begin_frame(view_projection_matrix, lists_count);
+
+					m_pJobSystem->parallel_for(lists_count, 1,
+						[&](const size_t first_list, const size_t last_list)
+						{
+							for (size_t list_index = first_list; list_index < last_list; ++list_index)
+							{
+								CommandList& command_list = render_queue.get_command_list(list_index);
+								const size_t begin = visible.size() * list_index / lists_count;
+								const size_t end = visible.size() * (list_index + 1) / lists_count;
+								command_list.reserve(end - begin);
+
+								DrawCommand command;
+								for (size_t i = begin; i < end; ++i)
+								{
+									const Entity entity = visible[i];
+									const Material& material = materials.get(entity);
+									MeshRef& mesh = meshes.get(entity);
+									command.shader_program = material.shader_program;
+									command.vertex_array = mesh.vertex_array;
+									command.texture = material.texture;
+									command.model_matrix = transforms.get_world_matrix(entity);
+									const MeshRange range = mesh.range ? *mesh.range : MeshRange();
+									command.first_index = range.first_index;
+									command.indices_count = mesh.range ? range.indices_count : DrawCommand::all_indices;
+									command.base_vertex = range.base_vertex;
+									if (mesh.lods_count > 0)
+									{
+										// all levels share the index range, a draw always takes one of them
+										if (mesh.lods_count > 1 && m_lod_error_threshold > 0.f)
+										{
+											const float pixels_per_unit = get_lod_pixels_per_unit(m_render_camera, command.model_matrix, bounds_pool.get(entity), viewport_height);
+											mesh.lod = select_lod(mesh.lods, mesh.lods_count, mesh.lod, pixels_per_unit, m_lod_error_threshold, lod_hysteresis);
+										}
+										else
+										{
+											mesh.lod = 0;
+										}
+										command.first_index = range.first_index + mesh.lods[mesh.lod].first_index;
+										command.indices_count = mesh.lods[mesh.lod].indices_count;
+									}
+									// clip space w of the origin is the view depth, opaque draws go front to back
+									const glm::vec4& origin = command.model_matrix[3];
+									const float depth = view_projection_matrix[0][3] * origin.x + view_projection_matrix[1][3] * origin.y
+										+ view_projection_matrix[2][3] * origin.z + view_projection_matrix[3][3] * origin.w;
+									command_list.submit(command, RenderPass::Opaque, material.material_id, depth);
+								}
+							}
+						});
+				}
 
-			camera.set_projection_mode(perspective_camera ? Camera::ProjectionMode::Perspective : Camera::ProjectionMode::Orthographic);
-			p_shader_program->setMatrix4("view_projection_matrix", camera.get_projection_matrix() * camera.get_view_matrix());
-			Renderer_OpenGL::draw(*p_vao);
+				render_queue.execute();
+
+				on_render();
+			}
 
 
-			//---------------------------------------//
-			UIModule::on_ui_draw_begin();
-			bool show = true;
-			UIModule::ShowExampleAppDockSpace(&show);
-			ImGui::ShowDemoWindow();
-			ImGui::Begin("Background Color Window");
-			ImGui::ColorEdit4("Background Color", m_background_color);
-			ImGui::SliderFloat3("scale", scale, 0.f, 2.f);
-			ImGui::SliderFloat("rotate", &rotate, 0.f, 360.f);
-			ImGui::SliderFloat3("translate", translate, -1.f, 1.f);
-			ImGui::SliderFloat3("camera position", camera_position, -10.f, 10.f);
-			ImGui::SliderFloat3("camera rotation", camera_rotation, 0, 360.f);
-			ImGui::Checkbox("Perspective camera", &perspective_camera);
-			ImGui::End();
-			//---------------------------------------//
+			{
+				PROFILE_SCOPE("UI");
+				GpuTimerScope gpu_scope("UI");
+
+				//---------------------------------------//
+				UIModule::on_ui_draw_begin();
+				bool show = true;
+				UIModule::ShowExampleAppDockSpace(&show);
+				if (m_demo_content)
+				{
+					ImGui::ShowDemoWindow();
+				}
+				ImGui::Begin("Background Color Window");
+				ImGui::ColorEdit4("Background Color", m_background_color);
+				if (transforms.contains(quad_entity))
+				{
+					Transform quad_transform = transforms.get_local(quad_entity);
+					bool changed = ImGui::SliderFloat3("scale", &quad_transform.scale.x, 0.f, 2.f);
+					changed |= ImGui::SliderFloat3("rotate", &quad_transform.rotation.x, 0.f, 360.f);
+					changed |= ImGui::SliderFloat3("translate", &quad_transform.position.x, -1.f, 1.f);
+					if (changed)
+					{
+						transforms.set_local(quad_entity, quad_transform);
+					}
+				}
+				ImGui::SliderFloat3("camera position", camera_position, -10.f, 10.f);
+				ImGui::SliderFloat3("camera rotation", camera_rotation, 0, 360.f);
+				ImGui::Checkbox("Perspective camera", &perspective_camera);
+				ImGui::Text("Visible: %zu  Culled: %zu", frustum_culler.get_visible_count(), frustum_culler.get_culled_count());
+				ImGui::End();
+				Profiler::on_ui_draw();
+				//---------------------------------------//
 
-			on_ui_draw();
+				on_ui_draw();
 
-			UIModule::on_ui_draw_end();
+				UIModule::on_ui_draw_end();
+			}
+			Renderer_OpenGL::end_frame();
 
+			{
+				PROFILE_SCOPE("Swap and poll events");
+				m_pWindow->on_update();
+			}
+			{
+				PROFILE_SCOPE("Events");
+				m_event_queue.drain(m_event_dispatcher);
+			}
+			{
+				PROFILE_SCOPE("on_update");
+				while (update_time_accumulator >= m_fixed_delta_time)
+				{
+					m_previous_camera_position = camera.get_camera_position();
+					m_previous_camera_rotation = camera.get_camera_rotation();
+					on_update(m_fixed_delta_time);
+					update_time_accumulator -= m_fixed_delta_time;
+				}
+				m_interpolation_alpha = update_time_accumulator / m_fixed_delta_time;
+			}
 
-			m_pWindow->on_update();
-			on_update();
+			if (m_frame_rate_limit > 0.0)
+			{
+				PROFILE_SCOPE("Frame limiter");
+				const clock::time_point frame_end = frame_start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / m_frame_rate_limit));
+				// OS sleep is coarse, the last millisecond is spent yielding
+				const clock::time_point sleep_end = frame_end - std::chrono::milliseconds(1);
+				if (clock::now() < sleep_end)
+				{
+					std::this_thread::sleep_until(sleep_end);
+				}
+				while (clock::now() < frame_end)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			Profiler::end_frame();
 		}
+		GpuTimer::shutdown();
+		render_queue.shutdown();
+		m_pTextureLoader->shutdown();
+		SamplerCache::shutdown();
 		m_pWindow = nullptr;
 
 		return 0;
 	}
 
+	void Application::set_swap_interval(const int swap_interval)
+	{
+		m_swap_interval = swap_interval;
+		if (m_pWindow)
+		{
+			m_pWindow->set_swap_interval(swap_interval);
+		}
+	}
+
+	// scene_bvh over the world bounds of entities with Bounds and a transform
+	static void update_scene_bvh(Registry& scene, const TransformHierarchy& transforms)
+	{
+		std::vector<Entity> entities;
+		std::vector<Bounds> world_bounds;
+		bool same_entities = true;
+		scene.view<Bounds>().each(
+			[&](const Entity entity, Bounds& bounds)
+			{
+				if (transforms.contains(entity))
+				{
+					entities.push_back(entity);
+					world_bounds.push_back(transform_bounds(bounds, transforms.get_world_matrix(entity)));
+					same_entities = same_entities && scene_bvh.contains(entity);
+				}
+			});
+
+		if (same_entities && !scene_bvh.empty() && entities.size() == scene_bvh.size())
+		{
+			for (size_t i = 0; i < entities.size(); ++i)
+			{
+				scene_bvh.update_bounds_only(entities[i], world_bounds[i]);
+			}
+			scene_bvh.refit();
+		}
+		else
+		{
+			scene_bvh.build(entities, world_bounds);
+		}
+	}
+
+	Entity Application::pick_entity(const double x_pos, const double y_pos)
+	{
+		// picking is rare, so the tree is updated here and at most once per frame:
+		// rebuilt when entities were added or removed, refit otherwise
+		if (scene_bvh_dirty)
+		{
+			update_scene_bvh(scene, transforms);
+			scene_bvh_dirty = false;
+		}
+
+		// cursor -> points on the near and far planes
+		const float ndc_x = static_cast<float>(2.0 * x_pos / m_pWindow->get_width() - 1.0);
+		const float ndc_y = static_cast<float>(1.0 - 2.0 * y_pos / m_pWindow->get_height());
+		// the camera the last frame was drawn from, that's what is under the cursor
+		const glm::mat4 inverse_view_projection = glm::inverse(m_render_camera.get_projection_matrix() * m_render_camera.get_view_matrix());
+		glm::vec4 near_point = inverse_view_projection * glm::vec4(ndc_x, ndc_y, -1.f, 1.f);
+		glm::vec4 far_point = inverse_view_projection * glm::vec4(ndc_x, ndc_y, 1.f, 1.f);
+		near_point = near_point * (1.f / near_point.w);
+		far_point = far_point * (1.f / far_point.w);
+
+		Ray ray;
+		ray.origin = glm::vec3(near_point.x, near_point.y, near_point.z);
+		const glm::vec3 to_far = glm::vec3(far_point.x, far_point.y, far_point.z) - ray.origin;
+		ray.max_distance = glm::length(to_far);
+		ray.direction = to_far / ray.max_distance;
+		return scene_bvh.raycast(ray).entity;
+	}
+
+	Entity Application::spawn_mesh(const std::string& path, const Transform& transform, const std::string& texture_path)
+	{
+		const Entity entity = scene.create();
+		transforms.add(entity, transform);
+		Material& material = scene.emplace<Material>(entity, p_shader_program.get());
+		TextureHandle texture;
+		if (!texture_path.empty())
+		{
+			texture = m_pTextureLoader->load(texture_path);
+			material.material_id = get_texture_material_id(texture);
+		}
+		m_pending_meshes.push_back({ entity, m_pMeshLoader->load(path), texture });
+		return entity;
+	}
+
+	void Application::destroy_entity(const Entity entity)
+	{
+		if (!scene.is_valid(entity))
+		{
+			return;
+		}
+
+		std::vector<Entity> removed;
+		if (transforms.contains(entity))
+		{
+			transforms.remove(entity, &removed);
+		}
+		else
+		{
+			removed.push_back(entity);
+		}
+		for (const Entity removed_entity : removed)
+		{
+			scene.destroy(removed_entity);
+		}
+		scene_bvh_dirty = true;
+	}
+
+	uint16_t Application::get_texture_material_id(const TextureHandle texture)
+	{
+		// draws with the same texture end up next to each other. 0 is for draws without a texture
+		const auto it = m_texture_material_ids.find(texture.index);
+		if (it != m_texture_material_ids.end())
+		{
+			return it->second;
+		}
+		if (m_texture_material_ids.size() >= UINT16_MAX)
+		{
+			// still drawn right, RenderQueue splits batches on the texture itself
+			LOG_WARN("Out of material ids, textures loaded from now on share one");
+			return UINT16_MAX;
+		}
+		const uint16_t material_id = static_cast<uint16_t>(m_texture_material_ids.size() + 1);
+		m_texture_material_ids.emplace(texture.index, material_id);
+		return material_id;
+	}
+
 	glm::vec2 Application::get_current_cursor_position() const
 	{
 		return m_pWindow->get_current_cursor_position();
 	}
+
+	bool Application::read_pixels(std::vector<uint8_t>& pixels) const
+	{
+		return m_pWindow && m_pWindow->read_pixels(pixels);
+	}
 }
\ No newline at end of file
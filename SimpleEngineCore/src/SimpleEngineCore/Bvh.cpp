@@ -0,0 +1,571 @@
+#include "SimpleEngineCore/Bvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace SimpleEngine {
+
+	static constexpr uint32_t bins_count = 16;
+
+	static glm::vec3 min_components(const glm::vec3& a, const glm::vec3& b)
+	{
+		return { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+	}
+
+	static glm::vec3 max_components(const glm::vec3& a, const glm::vec3& b)
+	{
+		return { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z) };
+	}
+
+	static float half_area(const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 size = max - min;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	// slab test, entry distance is clamped to 0 when the origin is inside.
+	// A zero direction component gives 0 * inf = NaN when the origin is on a plane of that slab,
+	// the ray runs along the face then and the axis doesn't limit it
+	static bool intersect_ray_box(const glm::vec3& origin, const glm::vec3& inverse_direction, const float max_distance,
+		const glm::vec3& min, const glm::vec3& max, float& entry_distance)
+	{
+		float t_near = -INFINITY;
+		float t_far = INFINITY;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float t1 = (min[axis] - origin[axis]) * inverse_direction[axis];
+			const float t2 = (max[axis] - origin[axis]) * inverse_direction[axis];
+			if (std::isnan(t1) || std::isnan(t2))
+			{
+				continue;
+			}
+			t_near = std::max(t_near, std::min(t1, t2));
+			t_far = std::min(t_far, std::max(t1, t2));
+		}
+		entry_distance = std::max(t_near, 0.f);
+		return t_far >= entry_distance && entry_distance < max_distance;
+	}
+
+	// infinity with the sign of the component for zero ones, -0 included
+	static glm::vec3 get_inverse_direction(const glm::vec3& direction)
+	{
+		glm::vec3 result;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			result[axis] = direction[axis] != 0.f ? 1.f / direction[axis] : std::copysign(INFINITY, direction[axis]);
+		}
+		return result;
+	}
+
+	enum class FrustumOverlap
+	{
+		Outside,
+		Intersects,
+		Inside
+	};
+
+	static FrustumOverlap test_frustum_box(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 center = (min + max) * 0.5f;
+		const glm::vec3 extent = (max - min) * 0.5f;
+		FrustumOverlap result = FrustumOverlap::Inside;
+		for (const glm::vec4& plane : frustum.planes)
+		{
+			const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+			const float radius = std::fabs(plane.x) * extent.x + std::fabs(plane.y) * extent.y + std::fabs(plane.z) * extent.z;
+			if (distance + radius < 0.f)
+			{
+				return FrustumOverlap::Outside;
+			}
+			if (distance - radius < 0.f)
+			{
+				result = FrustumOverlap::Intersects;
+			}
+		}
+		return result;
+	}
+
+	static bool overlap_boxes(const glm::vec3& min_a, const glm::vec3& max_a, const glm::vec3& min_b, const glm::vec3& max_b)
+	{
+		return min_a.x <= max_b.x && max_a.x >= min_b.x
+			&& min_a.y <= max_b.y && max_a.y >= min_b.y
+			&& min_a.z <= max_b.z && max_a.z >= min_b.z;
+	}
+
+
+	void Bvh::clear()
+	{
+		m_nodes.clear();
+		m_node_parents.clear();
+		m_entities.clear();
+		m_bounds.clear();
+		m_item_leaves.clear();
+		m_slots.clear();
+	}
+
+
+	void Bvh::build(const std::vector<Entity>& entities, const std::vector<Bounds>& world_bounds)
+	{
+		clear();
+		if (entities.empty())
+		{
+			return;
+		}
+
+		m_entities = entities;
+		m_bounds = world_bounds;
+		m_centroids.resize(m_bounds.size());
+		for (size_t i = 0; i < m_bounds.size(); ++i)
+		{
+			m_centroids[i] = (m_bounds[i].min + m_bounds[i].max) * 0.5f;
+		}
+
+		m_nodes.reserve(m_entities.size() * 2);
+		m_node_parents.reserve(m_entities.size() * 2);
+		m_nodes.push_back({ glm::vec3(0.f), 0, glm::vec3(0.f), static_cast<uint32_t>(m_entities.size()) });
+		m_node_parents.push_back(invalid_index);
+		update_node_bounds(0);
+
+		std::vector<uint32_t> stack{ 0 };
+		while (!stack.empty())
+		{
+			const uint32_t node_index = stack.back();
+			stack.pop_back();
+			subdivide(node_index);
+			if (m_nodes[node_index].count == 0)
+			{
+				stack.push_back(m_nodes[node_index].first + 1);
+				stack.push_back(m_nodes[node_index].first);
+			}
+		}
+		m_centroids.clear();
+
+		m_item_leaves.resize(m_entities.size());
+		for (uint32_t node_index = 0; node_index < m_nodes.size(); ++node_index)
+		{
+			const Node& node = m_nodes[node_index];
+			for (uint32_t item = node.first; item < node.first + node.count; ++item)
+			{
+				m_item_leaves[item] = node_index;
+			}
+		}
+
+		for (uint32_t item = 0; item < m_entities.size(); ++item)
+		{
+			const Entity entity = m_entities[item];
+			if (entity.index >= m_slots.size())
+			{
+				m_slots.resize(entity.index + 1, invalid_index);
+			}
+			m_slots[entity.index] = item;
+		}
+	}
+
+
+	// binned SAH: centroids go into bins along each axis, the cheapest border between bins wins.
+	// Cost of a side is its surface area * number of items
+	void Bvh::subdivide(const uint32_t node_index)
+	{
+		const uint32_t first = m_nodes[node_index].first;
+		const uint32_t count = m_nodes[node_index].count;
+		if (count <= max_leaf_items)
+		{
+			return;
+		}
+
+		glm::vec3 centroid_min = m_centroids[first];
+		glm::vec3 centroid_max = m_centroids[first];
+		for (uint32_t item = first + 1; item < first + count; ++item)
+		{
+			centroid_min = min_components(centroid_min, m_centroids[item]);
+			centroid_max = max_components(centroid_max, m_centroids[item]);
+		}
+
+		struct Bin
+		{
+			glm::vec3 min{ FLT_MAX };
+			glm::vec3 max{ -FLT_MAX };
+			uint32_t count = 0;
+		};
+
+		// all three axes are binned in one pass over the items
+		Bin bins[3][bins_count];
+		float scales[3];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float extent = centroid_max[axis] - centroid_min[axis];
+			scales[axis] = extent > 0.f ? bins_count / extent : 0.f;
+		}
+		for (uint32_t item = first; item < first + count; ++item)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const uint32_t bin_index = std::min(bins_count - 1, static_cast<uint32_t>((m_centroids[item][axis] - centroid_min[axis]) * scales[axis]));
+				Bin& bin = bins[axis][bin_index];
+				bin.min = min_components(bin.min, m_bounds[item].min);
+				bin.max = max_components(bin.max, m_bounds[item].max);
+				++bin.count;
+			}
+		}
+
+		float best_cost = FLT_MAX;
+		int best_axis = -1;
+		uint32_t best_split = 0; // bins below go to the left
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (scales[axis] == 0.f)
+			{
+				continue;
+			}
+
+			float left_costs[bins_count - 1];
+			Bin left;
+			for (uint32_t split = 1; split < bins_count; ++split)
+			{
+				const Bin& bin = bins[axis][split - 1];
+				left.min = min_components(left.min, bin.min);
+				left.max = max_components(left.max, bin.max);
+				left.count += bin.count;
+				left_costs[split - 1] = left.count == 0 ? 0.f : left.count * half_area(left.min, left.max);
+			}
+
+			Bin right;
+			for (uint32_t split = bins_count - 1; split > 0; --split)
+			{
+				const Bin& bin = bins[axis][split];
+				right.min = min_components(right.min, bin.min);
+				right.max = max_components(right.max, bin.max);
+				right.count += bin.count;
+				if (right.count == 0 || right.count == count)
+				{
+					continue;
+				}
+				const float cost = left_costs[split - 1] + right.count * half_area(right.min, right.max);
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_split = split;
+				}
+			}
+		}
+
+		const Node& node = m_nodes[node_index];
+		const float leaf_cost = count * half_area(node.min, node.max);
+		if (best_axis >= 0 && best_cost >= leaf_cost && count <= max_leaf_items * 4)
+		{
+			return;
+		}
+
+		uint32_t left_count = 0;
+		if (best_axis >= 0)
+		{
+			const float scale = scales[best_axis];
+			uint32_t i = first;
+			uint32_t j = first + count;
+			while (i < j)
+			{
+				const uint32_t bin_index = std::min(bins_count - 1, static_cast<uint32_t>((m_centroids[i][best_axis] - centroid_min[best_axis]) * scale));
+				if (bin_index < best_split)
+				{
+					++i;
+				}
+				else
+				{
+					--j;
+					std::swap(m_entities[i], m_entities[j]);
+					std::swap(m_bounds[i], m_bounds[j]);
+					std::swap(m_centroids[i], m_centroids[j]);
+				}
+			}
+			left_count = i - first;
+		}
+		if (left_count == 0 || left_count == count)
+		{
+			// all centroids in one point, split the list in half to keep leaves small
+			left_count = count / 2;
+		}
+
+		const uint32_t left_index = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.push_back({ glm::vec3(0.f), first, glm::vec3(0.f), left_count });
+		m_nodes.push_back({ glm::vec3(0.f), first + left_count, glm::vec3(0.f), count - left_count });
+		m_node_parents.push_back(node_index);
+		m_node_parents.push_back(node_index);
+		update_node_bounds(left_index);
+		update_node_bounds(left_index + 1);
+
+		m_nodes[node_index].first = left_index;
+		m_nodes[node_index].count = 0;
+	}
+
+
+	void Bvh::update_node_bounds(const uint32_t node_index)
+	{
+		Node& node = m_nodes[node_index];
+		if (node.count == 0)
+		{
+			const Node& left = m_nodes[node.first];
+			const Node& right = m_nodes[node.first + 1];
+			node.min = min_components(left.min, right.min);
+			node.max = max_components(left.max, right.max);
+			return;
+		}
+
+		node.min = glm::vec3(FLT_MAX);
+		node.max = glm::vec3(-FLT_MAX);
+		for (uint32_t item = node.first; item < node.first + node.count; ++item)
+		{
+			node.min = min_components(node.min, m_bounds[item].min);
+			node.max = max_components(node.max, m_bounds[item].max);
+		}
+	}
+
+
+	void Bvh::update(const Entity entity, const Bounds& world_bounds)
+	{
+		if (!contains(entity))
+		{
+			return;
+		}
+
+		const uint32_t item = m_slots[entity.index];
+		m_bounds[item] = world_bounds;
+		for (uint32_t node_index = m_item_leaves[item]; node_index != invalid_index; node_index = m_node_parents[node_index])
+		{
+			const glm::vec3 old_min = m_nodes[node_index].min;
+			const glm::vec3 old_max = m_nodes[node_index].max;
+			update_node_bounds(node_index);
+			if (m_nodes[node_index].min == old_min && m_nodes[node_index].max == old_max)
+			{
+				break;
+			}
+		}
+	}
+
+
+	void Bvh::update_bounds_only(const Entity entity, const Bounds& world_bounds)
+	{
+		if (contains(entity))
+		{
+			m_bounds[m_slots[entity.index]] = world_bounds;
+		}
+	}
+
+
+	void Bvh::refit()
+	{
+		// children are always after their parent
+		for (size_t node_index = m_nodes.size(); node_index > 0; --node_index)
+		{
+			update_node_bounds(static_cast<uint32_t>(node_index - 1));
+		}
+	}
+
+
+	void Bvh::raycast(const Ray* rays, RayHit* hits, const size_t count) const
+	{
+		std::vector<uint32_t> stack;
+		stack.reserve(64);
+		for (size_t ray_index = 0; ray_index < count; ++ray_index)
+		{
+			const Ray& ray = rays[ray_index];
+			RayHit& hit = hits[ray_index];
+			hit = RayHit();
+			if (m_nodes.empty())
+			{
+				continue;
+			}
+
+			const glm::vec3 inverse_direction = get_inverse_direction(ray.direction);
+			float root_distance;
+			if (!intersect_ray_box(ray.origin, inverse_direction, ray.max_distance, m_nodes[0].min, m_nodes[0].max, root_distance))
+			{
+				continue;
+			}
+
+			stack.assign(1, 0);
+			while (!stack.empty())
+			{
+				const Node& node = m_nodes[stack.back()];
+				stack.pop_back();
+				if (node.count > 0)
+				{
+					for (uint32_t item = node.first; item < node.first + node.count; ++item)
+					{
+						float distance;
+						if (intersect_ray_box(ray.origin, inverse_direction, std::min(hit.distance, ray.max_distance), m_bounds[item].min, m_bounds[item].max, distance))
+						{
+							hit.entity = m_entities[item];
+							hit.distance = distance;
+						}
+					}
+					continue;
+				}
+
+				// closer child is visited first, the farther one is skipped if a closer hit is found by then
+				uint32_t near_child = node.first;
+				uint32_t far_child = node.first + 1;
+				float near_distance;
+				float far_distance;
+				const float limit = std::min(hit.distance, ray.max_distance);
+				bool near_hit = intersect_ray_box(ray.origin, inverse_direction, limit, m_nodes[near_child].min, m_nodes[near_child].max, near_distance);
+				bool far_hit = intersect_ray_box(ray.origin, inverse_direction, limit, m_nodes[far_child].min, m_nodes[far_child].max, far_distance);
+				if (far_hit && (!near_hit || far_distance < near_distance))
+				{
+					std::swap(near_child, far_child);
+					std::swap(near_hit, far_hit);
+				}
+				if (far_hit)
+				{
+					stack.push_back(far_child);
+				}
+				if (near_hit)
+				{
+					stack.push_back(near_child);
+				}
+			}
+		}
+	}
+
+
+	RayHit Bvh::raycast(const Ray& ray) const
+	{
+		RayHit hit;
+		raycast(&ray, &hit, 1);
+		return hit;
+	}
+
+
+	void Bvh::query_frustum(const Frustum* frustums, std::vector<Entity>* results, const size_t count) const
+	{
+		if (m_nodes.empty())
+		{
+			return;
+		}
+
+		// node + a bit per frustum that only partly overlaps its parent. Fully overlapped subtrees are
+		// collected right away, outside ones are dropped, so each frustum leaves the walk as early as it can
+		std::vector<std::pair<uint32_t, uint32_t>> stack;
+		for (size_t first = 0; first < count; first += 32)
+		{
+			const uint32_t batch_count = static_cast<uint32_t>(std::min<size_t>(32, count - first));
+			const Frustum* batch_frustums = frustums + first;
+			std::vector<Entity>* batch_results = results + first;
+			stack.push_back({ 0, batch_count == 32 ? UINT32_MAX : (1u << batch_count) - 1 });
+			while (!stack.empty())
+			{
+				const uint32_t node_index = stack.back().first;
+				const uint32_t active = stack.back().second;
+				stack.pop_back();
+				const Node& node = m_nodes[node_index];
+
+				uint32_t intersecting = 0;
+				for (uint32_t i = 0; i < batch_count; ++i)
+				{
+					if (!(active & (1u << i)))
+					{
+						continue;
+					}
+					const FrustumOverlap overlap = test_frustum_box(batch_frustums[i], node.min, node.max);
+					if (overlap == FrustumOverlap::Inside)
+					{
+						collect_subtree(node_index, batch_results[i]);
+					}
+					else if (overlap == FrustumOverlap::Intersects)
+					{
+						intersecting |= 1u << i;
+					}
+				}
+				if (intersecting == 0)
+				{
+					continue;
+				}
+
+				if (node.count > 0)
+				{
+					for (uint32_t item = node.first; item < node.first + node.count; ++item)
+					{
+						for (uint32_t i = 0; i < batch_count; ++i)
+						{
+							if ((intersecting & (1u << i))
+								&& test_frustum_box(batch_frustums[i], m_bounds[item].min, m_bounds[item].max) != FrustumOverlap::Outside)
+							{
+								batch_results[i].push_back(m_entities[item]);
+							}
+						}
+					}
+				}
+				else
+				{
+					stack.push_back({ node.first + 1, intersecting });
+					stack.push_back({ node.first, intersecting });
+				}
+			}
+		}
+	}
+
+
+	void Bvh::query_frustum(const Frustum& frustum, std::vector<Entity>& result) const
+	{
+		query_frustum(&frustum, &result, 1);
+	}
+
+
+	void Bvh::query_box(const Bounds& box, std::vector<Entity>& result) const
+	{
+		if (m_nodes.empty())
+		{
+			return;
+		}
+
+		std::vector<uint32_t> stack{ 0 };
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (!overlap_boxes(node.min, node.max, box.min, box.max))
+			{
+				continue;
+			}
+
+			if (node.count > 0)
+			{
+				for (uint32_t item = node.first; item < node.first + node.count; ++item)
+				{
+					if (overlap_boxes(m_bounds[item].min, m_bounds[item].max, box.min, box.max))
+					{
+						result.push_back(m_entities[item]);
+					}
+				}
+			}
+			else
+			{
+				stack.push_back(node.first + 1);
+				stack.push_back(node.first);
+			}
+		}
+	}
+
+
+	// node is fully inside, take everything without tests
+	void Bvh::collect_subtree(const uint32_t node_index, std::vector<Entity>& result) const
+	{
+		std::vector<uint32_t> stack{ node_index };
+		while (!stack.empty())
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (node.count > 0)
+			{
+				result.insert(result.end(), m_entities.begin() + node.first, m_entities.begin() + node.first + node.count);
+			}
+			else
+			{
+				stack.push_back(node.first + 1);
+				stack.push_back(node.first);
+			}
+		}
+	}
+
+}
@@ -3,6 +3,8 @@
 #include <glm/trigonometric.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
+#include <algorithm>
+
 namespace SimpleEngine {
     Camera::Camera(const glm::vec3& position,
         const glm::vec3& rotation,
@@ -76,6 +78,17 @@ namespace SimpleEngine {
         }
     }
 
+    float Camera::get_pixels_per_unit(const float distance, const float viewport_height) const
+    {
+        // [1][1] maps view space y to [-1, 1], half the viewport per unit of ndc
+        const float pixels_per_ndc = m_projection_matrix[1][1] * viewport_height * 0.5f;
+        if (m_projection_mode == ProjectionMode::Orthographic)
+        {
+            return pixels_per_ndc;
+        }
+        return pixels_per_ndc / std::max(distance, 1e-4f);
+    }
+
     void Camera::set_position(const glm::vec3& position)
     {
         m_position = position;
@@ -0,0 +1,213 @@
+#include "SimpleEngineCore/FrustumCuller.hpp"
+#include "SimpleEngineCore/Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SimpleEngine {
+
+	// smaller sets are not worth splitting into jobs
+	static constexpr size_t min_items_per_chunk = 16384;
+
+	Frustum Frustum::from_matrix(const glm::mat4& view_projection)
+	{
+		const glm::vec4 row_x(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+		const glm::vec4 row_y(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+		const glm::vec4 row_z(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+		const glm::vec4 row_w(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+		Frustum frustum;
+		frustum.planes = { row_w + row_x, row_w - row_x, row_w + row_y, row_w - row_y, row_w + row_z, row_w - row_z };
+		for (glm::vec4& plane : frustum.planes)
+		{
+			const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			plane = plane * (1.f / length);
+		}
+		return frustum;
+	}
+
+
+	void FrustumCuller::clear()
+	{
+		m_entities.clear();
+		m_center_x.clear();
+		m_center_y.clear();
+		m_center_z.clear();
+		m_extent_x.clear();
+		m_extent_y.clear();
+		m_extent_z.clear();
+		m_radius.clear();
+		m_visible.clear();
+	}
+
+
+	void FrustumCuller::reserve(const size_t count)
+	{
+		m_entities.reserve(count);
+		m_center_x.reserve(count);
+		m_center_y.reserve(count);
+		m_center_z.reserve(count);
+		m_extent_x.reserve(count);
+		m_extent_y.reserve(count);
+		m_extent_z.reserve(count);
+		m_radius.reserve(count);
+		m_visible.reserve(count);
+	}
+
+
+	Bounds transform_bounds(const Bounds& local_bounds, const glm::mat4& world_matrix)
+	{
+		const glm::vec3 center = (local_bounds.min + local_bounds.max) * 0.5f;
+		const glm::vec3 extent = (local_bounds.max - local_bounds.min) * 0.5f;
+
+		// extent along each world axis is |M| * extent
+		const glm::vec4 world_center = world_matrix * glm::vec4(center, 1.f);
+		glm::vec3 world_extent;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			world_extent[axis] = std::fabs(world_matrix[0][axis]) * extent.x
+				+ std::fabs(world_matrix[1][axis]) * extent.y
+				+ std::fabs(world_matrix[2][axis]) * extent.z;
+		}
+
+		const glm::vec3 world_center3(world_center.x, world_center.y, world_center.z);
+		return { world_center3 - world_extent, world_center3 + world_extent };
+	}
+
+
+	void FrustumCuller::add_box(const Entity entity, const Bounds& local_bounds, const glm::mat4& world_matrix)
+	{
+		const Bounds world_bounds = transform_bounds(local_bounds, world_matrix);
+		const glm::vec3 center = (world_bounds.min + world_bounds.max) * 0.5f;
+		const glm::vec3 extent = (world_bounds.max - world_bounds.min) * 0.5f;
+
+		m_entities.push_back(entity);
+		m_center_x.push_back(center.x);
+		m_center_y.push_back(center.y);
+		m_center_z.push_back(center.z);
+		m_extent_x.push_back(extent.x);
+		m_extent_y.push_back(extent.y);
+		m_extent_z.push_back(extent.z);
+		m_radius.push_back(0.f);
+	}
+
+
+	void FrustumCuller::add_sphere(const Entity entity, const glm::vec3& center, const float radius)
+	{
+		m_entities.push_back(entity);
+		m_center_x.push_back(center.x);
+		m_center_y.push_back(center.y);
+		m_center_z.push_back(center.z);
+		m_extent_x.push_back(0.f);
+		m_extent_y.push_back(0.f);
+		m_extent_z.push_back(0.f);
+		m_radius.push_back(radius);
+	}
+
+
+	void FrustumCuller::cull(const glm::mat4& view_projection, JobSystem* job_system)
+	{
+		const Frustum frustum = Frustum::from_matrix(view_projection);
+		const size_t count = m_entities.size();
+
+		const size_t max_chunks = job_system ? job_system->get_thread_count() : 1;
+		const size_t chunks_count = std::max<size_t>(1, std::min(max_chunks, count / min_items_per_chunk));
+		// chunk borders on multiples of 4, the last chunk takes the tail
+		const size_t chunk_size = (count / chunks_count + 3) & ~size_t(3);
+
+		m_chunk_visible.resize(chunks_count);
+		const auto cull_chunks = [this, &frustum, count, chunks_count, chunk_size](const size_t first_chunk, const size_t last_chunk)
+			{
+				for (size_t chunk = first_chunk; chunk < last_chunk; ++chunk)
+				{
+					const size_t begin = std::min(count, chunk * chunk_size);
+					const size_t end = chunk + 1 == chunks_count ? count : std::min(count, begin + chunk_size);
+					cull_range(frustum, begin, end, m_chunk_visible[chunk]);
+				}
+			};
+		if (chunks_count == 1)
+		{
+			cull_chunks(0, 1);
+		}
+		else
+		{
+			job_system->parallel_for(chunks_count, 1, cull_chunks);
+		}
+
+		m_visible.clear();
+		for (const std::vector<uint32_t>& chunk_visible : m_chunk_visible)
+		{
+			for (const uint32_t index : chunk_visible)
+			{
+				m_visible.push_back(m_entities[index]);
+			}
+		}
+	}
+
+
+	// item is outside when it is fully behind any plane: distance(center) + projected radius < 0
+	void FrustumCuller::cull_range(const Frustum& frustum, const size_t begin, const size_t end, std::vector<uint32_t>& visible) const
+	{
+		visible.clear();
+		const Float4 zero = Float4::broadcast(0.f);
+
+		size_t first = begin;
+		for (; first + 4 <= end; first += 4)
+		{
+			const Float4 center_x = Float4::load(&m_center_x[first]);
+			const Float4 center_y = Float4::load(&m_center_y[first]);
+			const Float4 center_z = Float4::load(&m_center_z[first]);
+			const Float4 extent_x = Float4::load(&m_extent_x[first]);
+			const Float4 extent_y = Float4::load(&m_extent_y[first]);
+			const Float4 extent_z = Float4::load(&m_extent_z[first]);
+			const Float4 radius = Float4::load(&m_radius[first]);
+
+			int inside_mask = 0xF;
+			for (const glm::vec4& plane : frustum.planes)
+			{
+				const Float4 distance = Float4::broadcast(plane.x) * center_x
+					+ Float4::broadcast(plane.y) * center_y
+					+ Float4::broadcast(plane.z) * center_z
+					+ Float4::broadcast(plane.w);
+				const Float4 projected_radius = Float4::broadcast(std::fabs(plane.x)) * extent_x
+					+ Float4::broadcast(std::fabs(plane.y)) * extent_y
+					+ Float4::broadcast(std::fabs(plane.z)) * extent_z
+					+ radius;
+				inside_mask &= ~less_mask(distance + projected_radius, zero);
+				if (inside_mask == 0)
+				{
+					break;
+				}
+			}
+
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				if (inside_mask & (1 << lane))
+				{
+					visible.push_back(static_cast<uint32_t>(first + lane));
+				}
+			}
+		}
+
+		for (; first < end; ++first)
+		{
+			bool inside = true;
+			for (const glm::vec4& plane : frustum.planes)
+			{
+				const float distance = plane.x * m_center_x[first] + plane.y * m_center_y[first] + plane.z * m_center_z[first] + plane.w;
+				const float projected_radius = std::fabs(plane.x) * m_extent_x[first] + std::fabs(plane.y) * m_extent_y[first]
+					+ std::fabs(plane.z) * m_extent_z[first] + m_radius[first];
+				if (distance + projected_radius < 0.f)
+				{
+					inside = false;
+					break;
+				}
+			}
+			if (inside)
+			{
+				visible.push_back(static_cast<uint32_t>(first));
+			}
+		}
+	}
+
+}
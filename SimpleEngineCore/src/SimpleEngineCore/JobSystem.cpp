@@ -0,0 +1,358 @@
+#include "SimpleEngineCore/JobSystem.hpp"
+
+#include <functional>
+
+namespace SimpleEngine {
+
+	static constexpr size_t jobs_per_thread = 4096; // power of 2
+	static constexpr unsigned int spins_before_sleep = 64;
+
+	// Chase-Lev deque (C11 version by Le et al.). The owner pushes and pops at the bottom,
+	// other threads steal from the top. Fixed capacity, push fails when full
+	class WorkStealingQueue
+	{
+	public:
+		WorkStealingQueue()
+			: m_buffer(new std::atomic<Job*>[jobs_per_thread])
+		{
+		}
+
+		bool push(Job* job)
+		{
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64_t top = m_top.load(std::memory_order_acquire);
+			if (bottom - top >= static_cast<int64_t>(jobs_per_thread))
+			{
+				return false;
+			}
+			m_buffer[bottom & (jobs_per_thread - 1)].store(job, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		Job* pop()
+		{
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_top.load(std::memory_order_relaxed);
+			if (top > bottom)
+			{
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* job = m_buffer[bottom & (jobs_per_thread - 1)].load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				// last one, race with stealers
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					job = nullptr;
+				}
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job* steal()
+		{
+			int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+			if (top >= bottom)
+			{
+				return nullptr;
+			}
+
+			Job* job = m_buffer[top & (jobs_per_thread - 1)].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+			return job;
+		}
+
+	private:
+		alignas(64) std::atomic<int64_t> m_top{ 0 };
+		alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+		std::unique_ptr<std::atomic<Job*>[]> m_buffer;
+	};
+
+
+	struct JobSystem::ThreadData
+	{
+		WorkStealingQueue queue;
+		// jobs are taken in a ring and given back by whichever thread runs them
+		std::unique_ptr<Job[]> jobs{ new Job[jobs_per_thread] };
+		size_t next_job = 0;
+		uint32_t random_state = 0;
+	};
+
+
+	// set once by each worker, a worker belongs to one system. The owner thread is found by its id,
+	// so it can create several systems
+	static thread_local const JobSystem* s_current_job_system = nullptr;
+	static thread_local unsigned int s_current_thread_index = 0;
+
+
+	JobSystem::JobSystem(const unsigned int worker_count)
+		: m_owner_thread_id(std::this_thread::get_id())
+	{
+		const unsigned int hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+		const unsigned int workers = worker_count == 0 ? hardware_threads - 1 : worker_count;
+
+		for (unsigned int i = 0; i <= workers; ++i)
+		{
+			m_threads_data.push_back(std::make_unique<ThreadData>());
+			m_threads_data.back()->random_state = 0x9E3779B9u * (i + 1);
+		}
+
+		for (unsigned int i = 1; i <= workers; ++i)
+		{
+			m_workers.emplace_back(&JobSystem::worker_main, this, i);
+		}
+	}
+
+
+	JobSystem::~JobSystem()
+	{
+		m_quit.store(true);
+		{
+			std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		}
+		m_wake_condition.notify_all();
+		for (std::thread& worker : m_workers)
+		{
+			worker.join();
+		}
+
+		// workers quit once they find nothing, what is left (and what it schedules) runs here
+		const unsigned int thread_index = get_current_thread_index();
+		while (Job* job = find_job(thread_index))
+		{
+			execute(job);
+		}
+	}
+
+
+	unsigned int JobSystem::get_current_thread_index() const
+	{
+		if (s_current_job_system == this)
+		{
+			return s_current_thread_index;
+		}
+		return std::this_thread::get_id() == m_owner_thread_id ? 0 : UINT32_MAX;
+	}
+
+
+	Job* JobSystem::allocate_job()
+	{
+		const unsigned int thread_index = get_current_thread_index();
+		if (thread_index != UINT32_MAX)
+		{
+			ThreadData& data = *m_threads_data[thread_index];
+			for (size_t attempt = 0; attempt < jobs_per_thread; ++attempt)
+			{
+				Job& job = data.jobs[data.next_job++ & (jobs_per_thread - 1)];
+				if (job.free.load(std::memory_order_acquire))
+				{
+					job.free.store(false, std::memory_order_relaxed);
+					job.heap_allocated = false;
+					return &job;
+				}
+			}
+		}
+
+		// outside the pool or the whole ring is in flight
+		Job* job = new Job();
+		job->free.store(false, std::memory_order_relaxed);
+		job->heap_allocated = true;
+		return job;
+	}
+
+
+	void JobSystem::submit(Job* job, JobCounter* counter, JobCounter* dependency)
+	{
+		job->counter = counter;
+		if (counter)
+		{
+			counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		if (dependency)
+		{
+			std::lock_guard<std::mutex> lock(dependency->m_mutex);
+			if (dependency->m_pending.load(std::memory_order_acquire) != 0)
+			{
+				dependency->m_continuations.push_back(job);
+				return;
+			}
+		}
+		push(job);
+	}
+
+
+	void JobSystem::push(Job* job)
+	{
+		// seq_cst pairs with the sleeping worker: either it sees the job or we see it sleeping
+		m_queued_jobs.fetch_add(1);
+
+		const unsigned int thread_index = get_current_thread_index();
+		if (thread_index == UINT32_MAX || !m_threads_data[thread_index]->queue.push(job))
+		{
+			std::lock_guard<std::mutex> lock(m_overflow_mutex);
+			m_overflow_jobs.push_back(job);
+			m_overflow_count.fetch_add(1, std::memory_order_release);
+		}
+
+		if (m_sleeping_workers.load() > 0)
+		{
+			// lock so a worker can't miss the notification between checking and sleeping
+			{
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+			}
+			m_wake_condition.notify_one();
+		}
+	}
+
+
+	Job* JobSystem::find_job(const unsigned int thread_index)
+	{
+		Job* job = nullptr;
+		if (thread_index != UINT32_MAX)
+		{
+			job = m_threads_data[thread_index]->queue.pop();
+		}
+
+		if (!job && m_overflow_count.load(std::memory_order_acquire) > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_overflow_mutex);
+			if (!m_overflow_jobs.empty())
+			{
+				job = m_overflow_jobs.back();
+				m_overflow_jobs.pop_back();
+				m_overflow_count.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (!job)
+		{
+			// random victim, then the rest in order
+			uint32_t foreign_random_state = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+			uint32_t& random_state = thread_index == UINT32_MAX ? foreign_random_state : m_threads_data[thread_index]->random_state;
+			random_state ^= random_state << 13;
+			random_state ^= random_state >> 17;
+			random_state ^= random_state << 5;
+			const size_t threads_count = m_threads_data.size();
+			const size_t first_victim = random_state % threads_count;
+			for (size_t i = 0; i < threads_count && !job; ++i)
+			{
+				const size_t victim = (first_victim + i) % threads_count;
+				if (victim != thread_index)
+				{
+					job = m_threads_data[victim]->queue.steal();
+				}
+			}
+		}
+
+		if (job)
+		{
+			m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+
+	void JobSystem::execute(Job* job)
+	{
+		job->run(job->storage);
+
+		JobCounter* counter = job->counter;
+		if (job->heap_allocated)
+		{
+			delete job;
+		}
+		else
+		{
+			job->free.store(true, std::memory_order_release);
+		}
+
+		if (!counter)
+		{
+			return;
+		}
+
+		// decremented under the lock: wait() takes the lock once before returning,
+		// so the counter isn't destroyed while it is still locked here
+		std::vector<Job*> continuations;
+		{
+			std::lock_guard<std::mutex> lock(counter->m_mutex);
+			if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				continuations.swap(counter->m_continuations);
+			}
+		}
+		for (Job* continuation : continuations)
+		{
+			push(continuation);
+		}
+	}
+
+
+	void JobSystem::wait(JobCounter& counter)
+	{
+		const unsigned int thread_index = get_current_thread_index();
+		while (counter.m_pending.load(std::memory_order_acquire) != 0)
+		{
+			if (Job* job = find_job(thread_index))
+			{
+				execute(job);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		std::lock_guard<std::mutex> lock(counter.m_mutex);
+	}
+
+
+	void JobSystem::worker_main(const unsigned int thread_index)
+	{
+		s_current_job_system = this;
+		s_current_thread_index = thread_index;
+
+		unsigned int idle_spins = 0;
+		while (true)
+		{
+			if (Job* job = find_job(thread_index))
+			{
+				execute(job);
+				idle_spins = 0;
+				continue;
+			}
+
+			if (m_quit.load(std::memory_order_acquire))
+			{
+				return;
+			}
+
+			if (++idle_spins < spins_before_sleep)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_sleep_mutex);
+			m_sleeping_workers.fetch_add(1);
+			m_wake_condition.wait(lock, [this]()
+				{
+					return m_queued_jobs.load() > 0 || m_quit.load();
+				});
+			m_sleeping_workers.fetch_sub(1);
+			idle_spins = 0;
+		}
+	}
+
+}
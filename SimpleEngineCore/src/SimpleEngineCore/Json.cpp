@@ -0,0 +1,293 @@
+#include "Json.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	static constexpr size_t max_depth = 256;
+
+	class JsonParser
+	{
+	public:
+		JsonParser(const char* text, const size_t size)
+			: m_current(text)
+			, m_end(text + size)
+		{
+		}
+
+		bool parse(JsonValue& result)
+		{
+			if (!parse_value(result, 0))
+			{
+				return false;
+			}
+			skip_whitespace();
+			return m_current == m_end || *m_current == '\0';
+		}
+
+	private:
+		void skip_whitespace()
+		{
+			while (m_current < m_end && (*m_current == ' ' || *m_current == '\t' || *m_current == '\n' || *m_current == '\r'))
+			{
+				++m_current;
+			}
+		}
+
+		bool consume(const char symbol)
+		{
+			skip_whitespace();
+			if (m_current < m_end && *m_current == symbol)
+			{
+				++m_current;
+				return true;
+			}
+			return false;
+		}
+
+		bool consume_literal(const char* literal)
+		{
+			const size_t length = std::strlen(literal);
+			if (static_cast<size_t>(m_end - m_current) < length || std::strncmp(m_current, literal, length) != 0)
+			{
+				return false;
+			}
+			m_current += length;
+			return true;
+		}
+
+		bool parse_value(JsonValue& value, const size_t depth)
+		{
+			if (depth > max_depth)
+			{
+				return false;
+			}
+
+			skip_whitespace();
+			if (m_current >= m_end)
+			{
+				return false;
+			}
+
+			switch (*m_current)
+			{
+			case '{': return parse_object(value, depth);
+			case '[': return parse_array(value, depth);
+			case '"':
+				value.m_type = JsonValue::Type::String;
+				return parse_string(value.m_string);
+			case 't':
+				value.m_type = JsonValue::Type::Bool;
+				value.m_bool = true;
+				return consume_literal("true");
+			case 'f':
+				value.m_type = JsonValue::Type::Bool;
+				value.m_bool = false;
+				return consume_literal("false");
+			case 'n':
+				return consume_literal("null");
+			default:
+				return parse_number(value);
+			}
+		}
+
+		bool parse_object(JsonValue& value, const size_t depth)
+		{
+			value.m_type = JsonValue::Type::Object;
+			++m_current;
+			if (consume('}'))
+			{
+				return true;
+			}
+
+			do
+			{
+				skip_whitespace();
+				if (m_current >= m_end || *m_current != '"')
+				{
+					return false;
+				}
+				value.m_keys.emplace_back();
+				if (!parse_string(value.m_keys.back()) || !consume(':'))
+				{
+					return false;
+				}
+				value.m_elements.emplace_back();
+				if (!parse_value(value.m_elements.back(), depth + 1))
+				{
+					return false;
+				}
+			} while (consume(','));
+
+			return consume('}');
+		}
+
+		bool parse_array(JsonValue& value, const size_t depth)
+		{
+			value.m_type = JsonValue::Type::Array;
+			++m_current;
+			if (consume(']'))
+			{
+				return true;
+			}
+
+			do
+			{
+				value.m_elements.emplace_back();
+				if (!parse_value(value.m_elements.back(), depth + 1))
+				{
+					return false;
+				}
+			} while (consume(','));
+
+			return consume(']');
+		}
+
+		// \u escapes outside of ASCII are written as UTF-8, surrogate pairs are not joined
+		bool parse_string(std::string& result)
+		{
+			++m_current;
+			while (m_current < m_end && *m_current != '"')
+			{
+				if (*m_current != '\\')
+				{
+					result.push_back(*m_current++);
+					continue;
+				}
+
+				if (++m_current >= m_end)
+				{
+					return false;
+				}
+				switch (*m_current++)
+				{
+				case '"': result.push_back('"'); break;
+				case '\\': result.push_back('\\'); break;
+				case '/': result.push_back('/'); break;
+				case 'b': result.push_back('\b'); break;
+				case 'f': result.push_back('\f'); break;
+				case 'n': result.push_back('\n'); break;
+				case 'r': result.push_back('\r'); break;
+				case 't': result.push_back('\t'); break;
+				case 'u':
+				{
+					if (m_end - m_current < 4)
+					{
+						return false;
+					}
+					char digits[5] = { m_current[0], m_current[1], m_current[2], m_current[3], '\0' };
+					char* digits_end = nullptr;
+					const unsigned long code = std::strtoul(digits, &digits_end, 16);
+					if (digits_end != digits + 4)
+					{
+						return false;
+					}
+					m_current += 4;
+					if (code < 0x80)
+					{
+						result.push_back(static_cast<char>(code));
+					}
+					else if (code < 0x800)
+					{
+						result.push_back(static_cast<char>(0xC0 | (code >> 6)));
+						result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+					}
+					else
+					{
+						result.push_back(static_cast<char>(0xE0 | (code >> 12)));
+						result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+						result.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+					}
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+
+			if (m_current >= m_end)
+			{
+				return false;
+			}
+			++m_current;
+			return true;
+		}
+
+		bool parse_number(JsonValue& value)
+		{
+			// text is not always null terminated (glb chunks), strtod gets a copy
+			char buffer[64];
+			size_t length = 0;
+			while (m_current + length < m_end && length < sizeof(buffer) - 1
+				&& std::strchr("+-0123456789.eE", m_current[length]) && m_current[length] != '\0')
+			{
+				buffer[length] = m_current[length];
+				++length;
+			}
+			buffer[length] = '\0';
+
+			char* number_end = nullptr;
+			value.m_number = std::strtod(buffer, &number_end);
+			if (length == 0 || number_end != buffer + length)
+			{
+				return false;
+			}
+			value.m_type = JsonValue::Type::Number;
+			m_current += length;
+			return true;
+		}
+
+		const char* m_current;
+		const char* m_end;
+	};
+
+
+	bool JsonValue::parse(const char* text, const size_t size, JsonValue& result)
+	{
+		result = JsonValue();
+		JsonParser parser(text, size);
+		if (!parser.parse(result))
+		{
+			result = JsonValue();
+			return false;
+		}
+		return true;
+	}
+
+
+	size_t JsonValue::as_index(const size_t default_value) const
+	{
+		if (m_type == Type::Null)
+		{
+			return default_value;
+		}
+		const bool valid = m_type == Type::Number && m_number >= 0.0 && m_number < 9007199254740992.0 && m_number == static_cast<double>(static_cast<uint64_t>(m_number));
+		return valid ? static_cast<size_t>(m_number) : SIZE_MAX;
+	}
+
+
+	static const JsonValue null_value;
+
+	const JsonValue& JsonValue::operator[](const size_t index) const
+	{
+		return m_type == Type::Array && index < m_elements.size() ? m_elements[index] : null_value;
+	}
+
+
+	const JsonValue& JsonValue::operator[](const char* key) const
+	{
+		if (m_type == Type::Object)
+		{
+			for (size_t i = 0; i < m_keys.size(); ++i)
+			{
+				if (m_keys[i] == key)
+				{
+					return m_elements[i];
+				}
+			}
+		}
+		return null_value;
+	}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // read-only JSON tree, just enough for asset files like glTF.
+    // Missing keys and out of range indices give a null value, so lookups can be chained
+    class JsonValue
+    {
+    public:
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        // false on syntax error, result is left null
+        static bool parse(const char* text, const size_t size, JsonValue& result);
+
+        Type get_type() const { return m_type; }
+        bool is_null() const { return m_type == Type::Null; }
+        bool is_number() const { return m_type == Type::Number; }
+        bool is_string() const { return m_type == Type::String; }
+        bool is_array() const { return m_type == Type::Array; }
+        bool is_object() const { return m_type == Type::Object; }
+
+        bool as_bool(const bool default_value = false) const { return m_type == Type::Bool ? m_bool : default_value; }
+        double as_number(const double default_value = 0.0) const { return m_type == Type::Number ? m_number : default_value; }
+        const std::string& as_string() const { return m_string; }
+        // non-negative integer numbers, SIZE_MAX for anything else that is present
+        size_t as_index(const size_t default_value = SIZE_MAX) const;
+
+        // elements of an array or members of an object
+        size_t size() const { return m_elements.size(); }
+        const JsonValue& operator[](const size_t index) const;
+        // literal 0 would be ambiguous between index and key otherwise
+        const JsonValue& operator[](const int index) const { return (*this)[static_cast<size_t>(index)]; }
+        const JsonValue& operator[](const char* key) const;
+        bool contains(const char* key) const { return !(*this)[key].is_null(); }
+
+    private:
+        friend class JsonParser;
+
+        Type m_type = Type::Null;
+        bool m_bool = false;
+        double m_number = 0.0;
+        std::string m_string;
+        std::vector<JsonValue> m_elements;
+        std::vector<std::string> m_keys; // object member names, same order as m_elements
+    };
+
+}
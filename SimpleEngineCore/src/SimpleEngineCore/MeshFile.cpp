@@ -0,0 +1,441 @@
+#include "MeshFile.hpp"
+#include "SimpleEngineCore/MeshLoader.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SimpleEngine {
+
+#ifdef _WIN32
+	bool MappedFile::open(const std::string& path)
+	{
+		close();
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		LARGE_INTEGER size;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		{
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			if (mapping)
+			{
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			return false;
+		}
+		m_file_handle = file;
+		m_mapping_handle = mapping;
+		m_data = static_cast<const char*>(data);
+		m_size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+
+	void MappedFile::close()
+	{
+		if (m_data)
+		{
+			UnmapViewOfFile(m_data);
+			CloseHandle(m_mapping_handle);
+			CloseHandle(m_file_handle);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_file_handle = nullptr;
+		m_mapping_handle = nullptr;
+	}
+#else
+	bool MappedFile::open(const std::string& path)
+	{
+		close();
+		const int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+		{
+			return false;
+		}
+		struct stat file_stat;
+		void* data = MAP_FAILED;
+		if (fstat(file, &file_stat) == 0 && file_stat.st_size > 0)
+		{
+			data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		}
+		// the mapping keeps its own reference to the file
+		::close(file);
+		if (data == MAP_FAILED)
+		{
+			return false;
+		}
+		m_data = static_cast<const char*>(data);
+		m_size = static_cast<size_t>(file_stat.st_size);
+		return true;
+	}
+
+
+	void MappedFile::close()
+	{
+		if (m_data)
+		{
+			munmap(const_cast<char*>(m_data), m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+
+
+	static bool is_valid_shader_data_type(const uint32_t type)
+	{
+		return type <= static_cast<uint32_t>(ShaderDataType::Mat4);
+	}
+
+
+	bool MeshFile::open(const std::string& path)
+	{
+		close();
+		if (!m_file.open(path))
+		{
+			LOG_ERROR("Can't map file {0}", path);
+			return false;
+		}
+
+		const uint64_t file_size = m_file.get_size();
+		const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(m_file.get_data());
+		const auto fail = [this, &path](const char* message)
+		{
+			LOG_ERROR("Mesh file {0}: {1}", path, message);
+			m_file.close();
+			return false;
+		};
+
+		if (file_size < MeshFileHeader::version_1_size || header->magic != MeshFileHeader::magic_value)
+		{
+			return fail("not a mesh file");
+		}
+		if (header->version != 1 && header->version != MeshFileHeader::current_version)
+		{
+			return fail("unsupported version");
+		}
+		const uint64_t header_size = header->version == 1 ? MeshFileHeader::version_1_size : sizeof(MeshFileHeader);
+		if (file_size < header_size)
+		{
+			return fail("truncated header");
+		}
+		const uint32_t lods_count = header->version == 1 ? 0 : header->lods_count;
+		if (header->elements_count == 0 || header->elements_count > MeshFileHeader::max_elements)
+		{
+			return fail("bad vertex layout");
+		}
+		if (header->index_size != 2 && header->index_size != 4)
+		{
+			return fail("bad index size");
+		}
+
+		const uint64_t tables_end = header_size
+			+ static_cast<uint64_t>(header->elements_count) * sizeof(MeshFileElement)
+			+ static_cast<uint64_t>(header->submeshes_count) * sizeof(MeshFileSubmesh)
+			+ static_cast<uint64_t>(lods_count) * sizeof(MeshFileLod);
+		if (tables_end > file_size)
+		{
+			return fail("truncated header");
+		}
+
+		// offsets are checked against the packing BufferLayout will compute
+		const MeshFileElement* elements = reinterpret_cast<const MeshFileElement*>(m_file.get_data() + header_size);
+		uint64_t stride = 0;
+		for (uint32_t i = 0; i < header->elements_count; ++i)
+		{
+			if (!is_valid_shader_data_type(elements[i].type) || elements[i].offset != stride)
+			{
+				return fail("bad vertex layout");
+			}
+			stride += BufferElement(static_cast<ShaderDataType>(elements[i].type)).size;
+		}
+		if (stride != header->vertex_stride)
+		{
+			return fail("vertex stride doesn't match the layout");
+		}
+
+		// written this way so huge counts can't overflow
+		const auto fits = [file_size, tables_end](const uint64_t offset, const uint64_t count, const uint64_t element_size)
+		{
+			return offset >= tables_end && offset <= file_size && offset % 4 == 0 && count <= (file_size - offset) / element_size;
+		};
+		if (!fits(header->vertex_data_offset, header->vertices_count, header->vertex_stride)
+			|| !fits(header->index_data_offset, header->indices_count, header->index_size))
+		{
+			return fail("data is out of the file");
+		}
+
+		const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(elements + header->elements_count);
+		for (uint32_t i = 0; i < header->submeshes_count; ++i)
+		{
+			if (static_cast<uint64_t>(submeshes[i].first_index) + submeshes[i].indices_count > header->indices_count)
+			{
+				return fail("submesh is out of the index data");
+			}
+		}
+		const MeshFileLod* lods = reinterpret_cast<const MeshFileLod*>(submeshes + header->submeshes_count);
+		for (uint32_t i = 0; i < lods_count; ++i)
+		{
+			if (static_cast<uint64_t>(lods[i].first_index) + lods[i].indices_count > header->indices_count)
+			{
+				return fail("lod is out of the index data");
+			}
+		}
+
+		m_header = header;
+		m_elements = elements;
+		m_lods_count = lods_count;
+		return true;
+	}
+
+
+	bool MeshFile::check_indices() const
+	{
+		const uint64_t indices_count = m_header->indices_count;
+		const uint64_t vertices_count = m_header->vertices_count;
+		uint32_t max_index = 0;
+		if (m_header->index_size == 2)
+		{
+			const uint16_t* indices = static_cast<const uint16_t*>(get_index_data());
+			for (uint64_t i = 0; i < indices_count; ++i)
+			{
+				max_index = std::max<uint32_t>(max_index, indices[i]);
+			}
+		}
+		else
+		{
+			const uint32_t* indices = static_cast<const uint32_t*>(get_index_data());
+			for (uint64_t i = 0; i < indices_count; ++i)
+			{
+				max_index = std::max(max_index, indices[i]);
+			}
+		}
+		return indices_count == 0 || max_index < vertices_count;
+	}
+
+
+	BufferLayout MeshFile::get_layout() const
+	{
+		std::vector<BufferElement> elements;
+		elements.reserve(m_header->elements_count);
+		for (uint32_t i = 0; i < m_header->elements_count; ++i)
+		{
+			elements.emplace_back(static_cast<ShaderDataType>(get_elements()[i].type));
+		}
+		return BufferLayout(std::move(elements));
+	}
+
+
+	IndexBuffer::EIndexType MeshFile::get_index_type() const
+	{
+		return m_header->index_size == 2 ? IndexBuffer::EIndexType::UInt16 : IndexBuffer::EIndexType::UInt32;
+	}
+
+
+	Bounds MeshFile::get_bounds() const
+	{
+		Bounds bounds;
+		bounds.min = glm::vec3(m_header->bounds_min[0], m_header->bounds_min[1], m_header->bounds_min[2]);
+		bounds.max = glm::vec3(m_header->bounds_max[0], m_header->bounds_max[1], m_header->bounds_max[2]);
+		return bounds;
+	}
+
+
+	static uint64_t align_up(const uint64_t value, const uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+
+	bool write_mesh_file(const std::string& path, const MeshFileContent& content)
+	{
+		const std::vector<ShaderDataType>& types = *content.elements;
+		if (types.empty() || types.size() > MeshFileHeader::max_elements)
+		{
+			LOG_ERROR("Mesh file {0}: bad vertex layout", path);
+			return false;
+		}
+
+		std::vector<MeshFileElement> elements;
+		uint32_t stride = 0;
+		for (const ShaderDataType type : types)
+		{
+			elements.push_back({ static_cast<uint32_t>(type), stride });
+			stride += static_cast<uint32_t>(BufferElement(type).size);
+		}
+
+		MeshFileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		header.magic = MeshFileHeader::magic_value;
+		header.version = MeshFileHeader::current_version;
+		header.elements_count = static_cast<uint32_t>(elements.size());
+		header.vertex_stride = stride;
+		header.index_size = static_cast<uint32_t>(IndexBuffer::get_index_size(content.index_type));
+		header.submeshes_count = content.submeshes_count;
+		header.lods_count = content.lods_count;
+		header.vertices_count = content.vertices_count;
+		header.indices_count = content.indices_count;
+		const uint64_t tables_end = sizeof(MeshFileHeader) + elements.size() * sizeof(MeshFileElement)
+			+ content.submeshes_count * sizeof(MeshFileSubmesh) + content.lods_count * sizeof(MeshFileLod);
+		const uint64_t vertex_data_size = content.vertices_count * stride;
+		header.vertex_data_offset = align_up(tables_end, MeshFileHeader::data_alignment);
+		header.index_data_offset = align_up(header.vertex_data_offset + vertex_data_size, MeshFileHeader::data_alignment);
+		for (int i = 0; i < 3; ++i)
+		{
+			header.bounds_min[i] = content.bounds.min[i];
+			header.bounds_max[i] = content.bounds.max[i];
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			LOG_ERROR("Can't create file {0}", path);
+			return false;
+		}
+
+		const std::vector<char> padding(MeshFileHeader::data_alignment, 0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(elements.data()), elements.size() * sizeof(MeshFileElement));
+		file.write(reinterpret_cast<const char*>(content.submeshes), content.submeshes_count * sizeof(MeshFileSubmesh));
+		file.write(reinterpret_cast<const char*>(content.lods), content.lods_count * sizeof(MeshFileLod));
+		file.write(padding.data(), static_cast<std::streamsize>(header.vertex_data_offset - tables_end));
+		file.write(static_cast<const char*>(content.vertex_data), static_cast<std::streamsize>(vertex_data_size));
+		file.write(padding.data(), static_cast<std::streamsize>(header.index_data_offset - header.vertex_data_offset - vertex_data_size));
+		file.write(static_cast<const char*>(content.index_data), static_cast<std::streamsize>(content.indices_count * header.index_size));
+		if (!file)
+		{
+			LOG_ERROR("Can't write file {0}", path);
+			return false;
+		}
+		return true;
+	}
+
+
+	//------------------------------ MeshData -------------------------------//
+
+	static const std::vector<ShaderDataType> mesh_data_elements = { ShaderDataType::Float3, ShaderDataType::Float3, ShaderDataType::Float2 };
+
+	bool save_mesh_file(const std::string& path, const MeshData& mesh)
+	{
+		const size_t vertices_count = mesh.get_vertices_count();
+		std::vector<MeshFileSubmesh> submeshes;
+		for (const MeshData::Submesh& submesh : mesh.submeshes)
+		{
+			submeshes.push_back({ submesh.first_index, submesh.indices_count });
+		}
+
+		std::vector<MeshFileLod> lods;
+		for (const MeshLod& lod : mesh.lods)
+		{
+			lods.push_back({ lod.first_index, lod.indices_count, lod.error, 0 });
+		}
+
+		MeshFileContent content;
+		content.elements = &mesh_data_elements;
+		content.vertex_data = mesh.vertices.data();
+		content.vertices_count = vertices_count;
+		content.indices_count = mesh.indices.size();
+		content.bounds = mesh.bounds;
+		content.submeshes = submeshes.data();
+		content.submeshes_count = static_cast<uint32_t>(submeshes.size());
+		content.lods = lods.data();
+		content.lods_count = static_cast<uint32_t>(lods.size());
+
+		// half the index memory and bandwidth whenever every index fits
+		std::vector<uint16_t> short_indices;
+		if (vertices_count <= 65536)
+		{
+			short_indices.assign(mesh.indices.begin(), mesh.indices.end());
+			content.index_data = short_indices.data();
+			content.index_type = IndexBuffer::EIndexType::UInt16;
+		}
+		else
+		{
+			content.index_data = mesh.indices.data();
+			content.index_type = IndexBuffer::EIndexType::UInt32;
+		}
+		return write_mesh_file(path, content);
+	}
+
+
+	bool load_mesh_file(const std::string& path, MeshData& mesh)
+	{
+		mesh = MeshData();
+		MeshFile file;
+		if (!file.open(path))
+		{
+			return false;
+		}
+
+		const MeshFileHeader& header = file.get_header();
+		bool standard_layout = header.elements_count == mesh_data_elements.size();
+		for (uint32_t i = 0; standard_layout && i < header.elements_count; ++i)
+		{
+			standard_layout = file.get_elements()[i].type == static_cast<uint32_t>(mesh_data_elements[i]);
+		}
+		if (!standard_layout)
+		{
+			LOG_ERROR("Mesh file {0}: layout is not position, normal, uv", path);
+			return false;
+		}
+
+		const size_t vertices_count = static_cast<size_t>(header.vertices_count);
+		mesh.vertices.resize(vertices_count * MeshData::vertex_floats);
+		std::memcpy(mesh.vertices.data(), file.get_vertex_data(), file.get_vertex_data_size());
+
+		mesh.indices.resize(static_cast<size_t>(header.indices_count));
+		if (file.get_index_type() == IndexBuffer::EIndexType::UInt16)
+		{
+			const uint16_t* indices = static_cast<const uint16_t*>(file.get_index_data());
+			mesh.indices.assign(indices, indices + mesh.indices.size());
+		}
+		else
+		{
+			std::memcpy(mesh.indices.data(), file.get_index_data(), file.get_index_data_size());
+		}
+		// the GPU path doesn't care, code on the CPU side indexes vertices with these
+		for (const uint32_t index : mesh.indices)
+		{
+			if (index >= vertices_count)
+			{
+				LOG_ERROR("Mesh file {0}: index out of range", path);
+				mesh = MeshData();
+				return false;
+			}
+		}
+
+		for (uint32_t i = 0; i < header.submeshes_count; ++i)
+		{
+			mesh.submeshes.push_back({ file.get_submeshes()[i].first_index, file.get_submeshes()[i].indices_count });
+		}
+		for (uint32_t i = 0; i < file.get_lods_count(); ++i)
+		{
+			mesh.lods.push_back({ file.get_lods()[i].first_index, file.get_lods()[i].indices_count, file.get_lods()[i].error });
+		}
+		mesh.bounds = file.get_bounds();
+		return true;
+	}
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // read-only view of a whole file in memory, pages are loaded by the OS on first access
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        const char* get_data() const { return m_data; }
+        size_t get_size() const { return m_size; }
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file_handle = nullptr;
+        void* m_mapping_handle = nullptr;
+#endif
+    };
+
+
+    // .smesh layout, little endian:
+    //   MeshFileHeader
+    //   MeshFileElement[elements_count]  - vertex layout, same packing as BufferLayout
+    //   MeshFileSubmesh[submeshes_count]
+    //   MeshFileLod[lods_count]  - since version 2
+    //   vertex data at vertex_data_offset, index data at index_data_offset, both page aligned,
+    //   so the mapped blobs go to glBufferData / glBufferSubData without any conversion
+    struct MeshFileHeader
+    {
+        static constexpr uint32_t magic_value = 0x48534D53; // "SMSH"
+        static constexpr uint32_t current_version = 2;
+        static constexpr size_t version_1_size = 80; // without lods_count
+        static constexpr uint32_t max_elements = 16;
+        static constexpr uint64_t data_alignment = 4096;
+
+        uint32_t magic;
+        uint32_t version;
+        uint32_t elements_count;
+        uint32_t vertex_stride;
+        uint32_t index_size; // 2 or 4 bytes
+        uint32_t submeshes_count;
+        uint64_t vertices_count;
+        uint64_t indices_count;
+        uint64_t vertex_data_offset;
+        uint64_t index_data_offset;
+        float bounds_min[3];
+        float bounds_max[3];
+        uint32_t lods_count;
+        uint32_t reserved;
+    };
+
+    struct MeshFileElement
+    {
+        uint32_t type; // ShaderDataType
+        uint32_t offset; // in bytes inside a vertex
+    };
+
+    struct MeshFileSubmesh
+    {
+        uint32_t first_index;
+        uint32_t indices_count;
+    };
+
+    struct MeshFileLod
+    {
+        uint32_t first_index;
+        uint32_t indices_count;
+        float error;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(MeshFileHeader) == 88, "MeshFileHeader layout is part of the file format");
+    static_assert(sizeof(MeshFileElement) == 8 && sizeof(MeshFileSubmesh) == 8 && sizeof(MeshFileLod) == 16, "layout is part of the file format");
+
+
+    // mapped .smesh file. Everything returned points into the mapping and lives until close()
+    class MeshFile
+    {
+    public:
+        // maps the file and checks the header and that all ranges are inside the file.
+        // Index values are not checked here, see check_indices(). Reads versions 1 and 2
+        bool open(const std::string& path);
+        // every index points at a vertex of the file. Reads all the index data
+        bool check_indices() const;
+        void close() { m_file.close(); m_header = nullptr; m_elements = nullptr; m_lods_count = 0; }
+        bool is_open() const { return m_header != nullptr; }
+
+        const MeshFileHeader& get_header() const { return *m_header; }
+        BufferLayout get_layout() const;
+        IndexBuffer::EIndexType get_index_type() const;
+        Bounds get_bounds() const;
+
+        const void* get_vertex_data() const { return m_file.get_data() + m_header->vertex_data_offset; }
+        size_t get_vertex_data_size() const { return static_cast<size_t>(m_header->vertices_count * m_header->vertex_stride); }
+        const void* get_index_data() const { return m_file.get_data() + m_header->index_data_offset; }
+        size_t get_index_data_size() const { return static_cast<size_t>(m_header->indices_count * m_header->index_size); }
+        const MeshFileElement* get_elements() const { return m_elements; }
+        const MeshFileSubmesh* get_submeshes() const { return reinterpret_cast<const MeshFileSubmesh*>(m_elements + m_header->elements_count); }
+        // lods_count of the header is not there in version 1
+        uint32_t get_lods_count() const { return m_lods_count; }
+        const MeshFileLod* get_lods() const { return reinterpret_cast<const MeshFileLod*>(get_submeshes() + m_header->submeshes_count); }
+
+    private:
+        MappedFile m_file;
+        const MeshFileHeader* m_header = nullptr;
+        const MeshFileElement* m_elements = nullptr;
+        uint32_t m_lods_count = 0;
+    };
+
+
+    struct MeshFileContent
+    {
+        const std::vector<ShaderDataType>* elements;
+        const void* vertex_data;
+        uint64_t vertices_count;
+        const void* index_data;
+        uint64_t indices_count;
+        IndexBuffer::EIndexType index_type;
+        Bounds bounds;
+        const MeshFileSubmesh* submeshes;
+        uint32_t submeshes_count;
+        const MeshFileLod* lods;
+        uint32_t lods_count;
+    };
+
+    bool write_mesh_file(const std::string& path, const MeshFileContent& content);
+
+}
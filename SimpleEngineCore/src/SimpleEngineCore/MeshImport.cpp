@@ -0,0 +1,850 @@
+#include "SimpleEngineCore/MeshLoader.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "Json.hpp"
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	static bool read_file(const std::string& path, std::vector<char>& content)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			LOG_ERROR("Can't open file {0}", path);
+			return false;
+		}
+		const std::streamsize size = file.tellg();
+		file.seekg(0);
+		content.resize(static_cast<size_t>(size));
+		if (!file.read(content.data(), size))
+		{
+			LOG_ERROR("Can't read file {0}", path);
+			return false;
+		}
+		return true;
+	}
+
+
+	static bool ends_with(const std::string& text, const char* suffix)
+	{
+		const size_t length = std::strlen(suffix);
+		if (text.size() < length)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < length; ++i)
+		{
+			if (std::tolower(static_cast<unsigned char>(text[text.size() - length + i])) != suffix[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	// area weighted sum of face normals for vertices starting from first_vertex
+	static void compute_normals(MeshData& mesh, const size_t first_vertex, const size_t first_index)
+	{
+		float* vertices = mesh.vertices.data();
+		for (size_t vertex = first_vertex; vertex < mesh.get_vertices_count(); ++vertex)
+		{
+			std::fill_n(vertices + vertex * MeshData::vertex_floats + 3, 3, 0.f);
+		}
+
+		for (size_t i = first_index; i + 2 < mesh.indices.size(); i += 3)
+		{
+			float* v0 = vertices + mesh.indices[i] * MeshData::vertex_floats;
+			float* v1 = vertices + mesh.indices[i + 1] * MeshData::vertex_floats;
+			float* v2 = vertices + mesh.indices[i + 2] * MeshData::vertex_floats;
+			const glm::vec3 edge_1(v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]);
+			const glm::vec3 edge_2(v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]);
+			const glm::vec3 face_normal = glm::cross(edge_1, edge_2); // length is twice the area
+			for (float* vertex : { v0, v1, v2 })
+			{
+				vertex[3] += face_normal.x;
+				vertex[4] += face_normal.y;
+				vertex[5] += face_normal.z;
+			}
+		}
+
+		for (size_t vertex = first_vertex; vertex < mesh.get_vertices_count(); ++vertex)
+		{
+			float* normal = vertices + vertex * MeshData::vertex_floats + 3;
+			const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length > 0.f)
+			{
+				normal[0] /= length;
+				normal[1] /= length;
+				normal[2] /= length;
+			}
+		}
+	}
+
+
+	static void compute_bounds(MeshData& mesh)
+	{
+		glm::vec3 min(FLT_MAX);
+		glm::vec3 max(-FLT_MAX);
+		for (size_t i = 0; i < mesh.vertices.size(); i += MeshData::vertex_floats)
+		{
+			const glm::vec3 position(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
+		mesh.bounds.min = min;
+		mesh.bounds.max = max;
+	}
+
+
+	//------------------------------- OBJ -------------------------------//
+
+	struct ObjCorner
+	{
+		int position;
+		int uv; // -1 if missing
+		int normal; // -1 if missing
+
+		bool operator==(const ObjCorner& other) const { return position == other.position && uv == other.uv && normal == other.normal; }
+	};
+
+	struct ObjCornerHash
+	{
+		size_t operator()(const ObjCorner& corner) const
+		{
+			return (static_cast<size_t>(corner.position) * 73856093u) ^ (static_cast<size_t>(corner.uv) * 19349663u) ^ (static_cast<size_t>(corner.normal) * 83492791u);
+		}
+	};
+
+	// 1 based, negative - relative to the end. Returns -1 if out of range
+	static int resolve_obj_index(const long index, const size_t count)
+	{
+		const long resolved = index > 0 ? index - 1 : static_cast<long>(count) + index;
+		return resolved >= 0 && resolved < static_cast<long>(count) ? static_cast<int>(resolved) : -1;
+	}
+
+
+	bool load_obj(const std::string& path, MeshData& mesh)
+	{
+		std::vector<char> text;
+		if (!read_file(path, text))
+		{
+			return false;
+		}
+		text.push_back('\0'); // number parsing can't run past the end
+
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+		std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> corner_vertices;
+		std::vector<uint32_t> polygon;
+		bool all_corners_have_normals = true;
+
+		mesh = MeshData();
+		const char* cursor = text.data();
+		const char* const end = text.data() + text.size() - 1;
+		size_t line_number = 0;
+		while (cursor < end)
+		{
+			const char* line_end = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+			if (!line_end)
+			{
+				line_end = end;
+			}
+			++line_number;
+
+			while (cursor < line_end && (*cursor == ' ' || *cursor == '\t'))
+			{
+				++cursor;
+			}
+
+			const auto read_floats = [&](const char* from, const size_t count, std::vector<float>& result) -> bool
+				{
+					char* number_end = nullptr;
+					for (size_t i = 0; i < count; ++i)
+					{
+						result.push_back(std::strtof(from, &number_end));
+						if (number_end == from || number_end > line_end)
+						{
+							return false;
+						}
+						from = number_end;
+					}
+					return true;
+				};
+
+			bool valid = true;
+			if (cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t'))
+			{
+				valid = read_floats(cursor + 2, 3, positions);
+			}
+			else if (cursor[0] == 'v' && cursor[1] == 't' && (cursor[2] == ' ' || cursor[2] == '\t'))
+			{
+				valid = read_floats(cursor + 3, 2, uvs);
+			}
+			else if (cursor[0] == 'v' && cursor[1] == 'n' && (cursor[2] == ' ' || cursor[2] == '\t'))
+			{
+				valid = read_floats(cursor + 3, 3, normals);
+			}
+			else if (cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t'))
+			{
+				// v, v/vt, v//vn or v/vt/vn per corner, polygons are split into a fan
+				polygon.clear();
+				const char* token = cursor + 2;
+				while (valid)
+				{
+					while (token < line_end && (*token == ' ' || *token == '\t' || *token == '\r'))
+					{
+						++token;
+					}
+					if (token >= line_end)
+					{
+						break;
+					}
+
+					char* number_end = nullptr;
+					ObjCorner corner{ -1, -1, -1 };
+					corner.position = resolve_obj_index(std::strtol(token, &number_end, 10), positions.size() / 3);
+					token = number_end;
+					if (*token == '/')
+					{
+						++token;
+						if (*token != '/')
+						{
+							corner.uv = resolve_obj_index(std::strtol(token, &number_end, 10), uvs.size() / 2);
+							valid &= corner.uv >= 0;
+							token = number_end;
+						}
+						if (*token == '/')
+						{
+							++token;
+							corner.normal = resolve_obj_index(std::strtol(token, &number_end, 10), normals.size() / 3);
+							valid &= corner.normal >= 0;
+							token = number_end;
+						}
+					}
+					valid &= corner.position >= 0 && token <= line_end;
+					if (!valid)
+					{
+						break;
+					}
+					all_corners_have_normals &= corner.normal >= 0;
+
+					const auto [it, inserted] = corner_vertices.emplace(corner, static_cast<uint32_t>(mesh.get_vertices_count()));
+					if (inserted)
+					{
+						const float* position = &positions[corner.position * 3];
+						const float* normal = corner.normal >= 0 ? &normals[corner.normal * 3] : nullptr;
+						const float* uv = corner.uv >= 0 ? &uvs[corner.uv * 2] : nullptr;
+						mesh.vertices.insert(mesh.vertices.end(), {
+							position[0], position[1], position[2],
+							normal ? normal[0] : 0.f, normal ? normal[1] : 0.f, normal ? normal[2] : 0.f,
+							uv ? uv[0] : 0.f, uv ? uv[1] : 0.f });
+					}
+					polygon.push_back(it->second);
+				}
+
+				for (size_t i = 2; valid && i < polygon.size(); ++i)
+				{
+					mesh.indices.insert(mesh.indices.end(), { polygon[0], polygon[i - 1], polygon[i] });
+				}
+			}
+			// everything else (groups, materials, smoothing, comments) is ignored
+
+			if (!valid)
+			{
+				LOG_ERROR("OBJ {0}: bad data on line {1}", path, line_number);
+				mesh = MeshData();
+				return false;
+			}
+			cursor = line_end + 1;
+		}
+
+		if (mesh.indices.empty())
+		{
+			LOG_ERROR("OBJ {0}: no faces", path);
+			return false;
+		}
+		if (!all_corners_have_normals)
+		{
+			compute_normals(mesh, 0, 0);
+		}
+		mesh.submeshes.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()) });
+		compute_bounds(mesh);
+		return true;
+	}
+
+
+	//------------------------------ glTF -------------------------------//
+
+	enum GltfComponentType
+	{
+		Byte = 5120,
+		UnsignedByte = 5121,
+		Short = 5122,
+		UnsignedShort = 5123,
+		UnsignedInt = 5125,
+		Float = 5126
+	};
+
+	static size_t gltf_component_size(const int component_type)
+	{
+		switch (component_type)
+		{
+		case Byte:
+		case UnsignedByte:
+			return 1;
+		case Short:
+		case UnsignedShort:
+			return 2;
+		case UnsignedInt:
+		case Float:
+			return 4;
+		}
+		return 0;
+	}
+
+	static size_t gltf_components_count(const std::string& type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0;
+	}
+
+
+	static bool decode_base64(const char* text, const size_t size, std::vector<char>& result)
+	{
+		static const auto decode_symbol = [](const char symbol) -> int
+			{
+				if (symbol >= 'A' && symbol <= 'Z') return symbol - 'A';
+				if (symbol >= 'a' && symbol <= 'z') return symbol - 'a' + 26;
+				if (symbol >= '0' && symbol <= '9') return symbol - '0' + 52;
+				if (symbol == '+') return 62;
+				if (symbol == '/') return 63;
+				return -1;
+			};
+
+		result.clear();
+		result.reserve(size / 4 * 3);
+		uint32_t bits = 0;
+		int bits_count = 0;
+		for (size_t i = 0; i < size && text[i] != '='; ++i)
+		{
+			const int value = decode_symbol(text[i]);
+			if (value < 0)
+			{
+				return false;
+			}
+			bits = (bits << 6) | static_cast<uint32_t>(value);
+			bits_count += 6;
+			if (bits_count >= 8)
+			{
+				bits_count -= 8;
+				result.push_back(static_cast<char>((bits >> bits_count) & 0xFF));
+			}
+		}
+		return true;
+	}
+
+
+	class GltfReader
+	{
+	public:
+		GltfReader(const std::string& path, MeshData& mesh)
+			: m_path(path)
+			, m_mesh(mesh)
+		{
+		}
+
+		bool read()
+		{
+			std::vector<char> file;
+			if (!read_file(m_path, file))
+			{
+				return false;
+			}
+
+			std::vector<char> binary_chunk;
+			const char* json_text = file.data();
+			size_t json_size = file.size();
+			if (ends_with(m_path, ".glb"))
+			{
+				// header: magic, version, length. Then chunks: length, type, data
+				uint32_t header[5];
+				if (file.size() < sizeof(header))
+				{
+					return error("file is too small");
+				}
+				std::memcpy(header, file.data(), sizeof(header));
+				// lengths in the file are checked against its size before anything is copied
+				const size_t glb_size = header[2];
+				if (header[0] != 0x46546C67 || header[1] != 2 || header[4] != 0x4E4F534A || glb_size > file.size()
+					|| 20 + static_cast<size_t>(header[3]) > glb_size)
+				{
+					return error("not a glTF 2.0 binary");
+				}
+				json_text = file.data() + 20;
+				json_size = header[3];
+
+				const size_t binary_offset = (20 + json_size + 3) & ~size_t(3);
+				uint32_t binary_header[2];
+				if (binary_offset + sizeof(binary_header) <= glb_size)
+				{
+					std::memcpy(binary_header, file.data() + binary_offset, sizeof(binary_header));
+					const size_t binary_size = binary_header[0];
+					if (binary_size > glb_size - binary_offset - sizeof(binary_header))
+					{
+						return error("binary chunk is longer than the file");
+					}
+					if (binary_header[1] == 0x004E4942)
+					{
+						const char* binary_data = file.data() + binary_offset + sizeof(binary_header);
+						binary_chunk.assign(binary_data, binary_data + binary_size);
+					}
+				}
+			}
+
+			if (!JsonValue::parse(json_text, json_size, m_document))
+			{
+				return error("bad JSON");
+			}
+			if (!load_buffers(binary_chunk))
+			{
+				return false;
+			}
+
+			m_mesh = MeshData();
+			const JsonValue& scenes = m_document["scenes"];
+			if (scenes.size() > 0)
+			{
+				const JsonValue& scene = scenes[m_document["scene"].as_index(0)];
+				const JsonValue& nodes = scene["nodes"];
+				for (size_t i = 0; i < nodes.size(); ++i)
+				{
+					if (!add_node(nodes[i].as_index(), glm::mat4(1.f), 0))
+					{
+						return false;
+					}
+				}
+			}
+			else
+			{
+				// no scene - meshes as they are
+				for (size_t i = 0; i < m_document["meshes"].size(); ++i)
+				{
+					if (!add_mesh(i, glm::mat4(1.f)))
+					{
+						return false;
+					}
+				}
+			}
+
+			if (m_mesh.indices.empty())
+			{
+				return error("no triangles");
+			}
+			compute_bounds(m_mesh);
+			return true;
+		}
+
+	private:
+		bool error(const char* message)
+		{
+			LOG_ERROR("glTF {0}: {1}", m_path, message);
+			m_mesh = MeshData();
+			return false;
+		}
+
+		bool load_buffers(std::vector<char>& binary_chunk)
+		{
+			const JsonValue& buffers = m_document["buffers"];
+			m_buffers.resize(buffers.size());
+			const size_t directory_end = m_path.find_last_of("/\\");
+			const std::string directory = directory_end == std::string::npos ? std::string() : m_path.substr(0, directory_end + 1);
+
+			for (size_t i = 0; i < buffers.size(); ++i)
+			{
+				const JsonValue& uri = buffers[i]["uri"];
+				if (uri.is_null())
+				{
+					// glb: the first buffer without uri is the binary chunk
+					if (i != 0 || binary_chunk.empty())
+					{
+						return error("buffer without data");
+					}
+					m_buffers[i].swap(binary_chunk);
+				}
+				else if (uri.as_string().compare(0, 5, "data:") == 0)
+				{
+					const size_t data_start = uri.as_string().find(";base64,");
+					if (data_start == std::string::npos
+						|| !decode_base64(uri.as_string().data() + data_start + 8, uri.as_string().size() - data_start - 8, m_buffers[i]))
+					{
+						return error("bad data uri");
+					}
+				}
+				else if (!read_file(directory + uri.as_string(), m_buffers[i]))
+				{
+					return false;
+				}
+
+				if (m_buffers[i].size() < buffers[i]["byteLength"].as_index(0))
+				{
+					return error("buffer is shorter than byteLength");
+				}
+			}
+			return true;
+		}
+
+		bool add_node(const size_t node_index, const glm::mat4& parent_matrix, const size_t depth)
+		{
+			const JsonValue& node = m_document["nodes"][node_index];
+			if (!node.is_object() || depth > 64)
+			{
+				return error("bad node hierarchy");
+			}
+
+			glm::mat4 local_matrix(1.f);
+			const JsonValue& matrix = node["matrix"];
+			if (matrix.size() == 16)
+			{
+				for (size_t column = 0; column < 4; ++column)
+				{
+					local_matrix[column] = glm::vec4(
+						static_cast<float>(matrix[column * 4].as_number()), static_cast<float>(matrix[column * 4 + 1].as_number()),
+						static_cast<float>(matrix[column * 4 + 2].as_number()), static_cast<float>(matrix[column * 4 + 3].as_number()));
+				}
+			}
+			else
+			{
+				// T * R * S, rotation is a quaternion x, y, z, w
+				const JsonValue& translation = node["translation"];
+				const JsonValue& rotation = node["rotation"];
+				const JsonValue& scale = node["scale"];
+				const float x = static_cast<float>(rotation[0].as_number(0));
+				const float y = static_cast<float>(rotation[1].as_number(0));
+				const float z = static_cast<float>(rotation[2].as_number(0));
+				const float w = static_cast<float>(rotation[3].as_number(1));
+				const float scale_x = static_cast<float>(scale[0].as_number(1));
+				const float scale_y = static_cast<float>(scale[1].as_number(1));
+				const float scale_z = static_cast<float>(scale[2].as_number(1));
+				local_matrix[0] = glm::vec4(1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y), 0.f) * scale_x;
+				local_matrix[1] = glm::vec4(2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x), 0.f) * scale_y;
+				local_matrix[2] = glm::vec4(2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y), 0.f) * scale_z;
+				local_matrix[3] = glm::vec4(static_cast<float>(translation[0].as_number(0)), static_cast<float>(translation[1].as_number(0)),
+					static_cast<float>(translation[2].as_number(0)), 1.f);
+			}
+
+			const glm::mat4 world_matrix = parent_matrix * local_matrix;
+			if (node.contains("mesh") && !add_mesh(node["mesh"].as_index(), world_matrix))
+			{
+				return false;
+			}
+
+			const JsonValue& children = node["children"];
+			for (size_t i = 0; i < children.size(); ++i)
+			{
+				if (!add_node(children[i].as_index(), world_matrix, depth + 1))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool add_mesh(const size_t mesh_index, const glm::mat4& world_matrix)
+		{
+			const JsonValue& primitives = m_document["meshes"][mesh_index]["primitives"];
+			for (size_t i = 0; i < primitives.size(); ++i)
+			{
+				const JsonValue& primitive = primitives[i];
+				if (primitive["mode"].as_number(4) != 4)
+				{
+					LOG_WARN("glTF {0}: skipped a primitive that is not a triangle list", m_path);
+					continue;
+				}
+
+				const JsonValue& attributes = primitive["attributes"];
+				if (!attributes.contains("POSITION"))
+				{
+					return error("primitive without POSITION");
+				}
+				if (!read_floats(attributes["POSITION"], 3, m_positions))
+				{
+					return false;
+				}
+				const size_t vertices_count = m_positions.size() / 3;
+
+				const bool has_normals = attributes.contains("NORMAL");
+				const bool has_uvs = attributes.contains("TEXCOORD_0");
+				if ((has_normals && (!read_floats(attributes["NORMAL"], 3, m_normals) || m_normals.size() != vertices_count * 3))
+					|| (has_uvs && (!read_floats(attributes["TEXCOORD_0"], 2, m_uvs) || m_uvs.size() != vertices_count * 2)))
+				{
+					return error("attribute counts don't match");
+				}
+
+				const size_t first_vertex = m_mesh.get_vertices_count();
+				const size_t first_index = m_mesh.indices.size();
+				m_mesh.vertices.reserve(m_mesh.vertices.size() + vertices_count * MeshData::vertex_floats);
+				for (size_t vertex = 0; vertex < vertices_count; ++vertex)
+				{
+					const glm::vec4 position = world_matrix * glm::vec4(m_positions[vertex * 3], m_positions[vertex * 3 + 1], m_positions[vertex * 3 + 2], 1.f);
+					// upper 3x3 of the matrix, exact for rotations and uniform scale
+					glm::vec4 normal(0.f);
+					if (has_normals)
+					{
+						normal = world_matrix * glm::vec4(m_normals[vertex * 3], m_normals[vertex * 3 + 1], m_normals[vertex * 3 + 2], 0.f);
+						const float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+						normal = length > 0.f ? normal * (1.f / length) : normal;
+					}
+					// glTF has uv origin at the top left, OpenGL at the bottom left
+					const float u = has_uvs ? m_uvs[vertex * 2] : 0.f;
+					const float v = has_uvs ? 1.f - m_uvs[vertex * 2 + 1] : 0.f;
+					m_mesh.vertices.insert(m_mesh.vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z, u, v });
+				}
+
+				if (primitive.contains("indices"))
+				{
+					if (!read_indices(primitive["indices"], vertices_count, first_vertex))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					for (size_t vertex = 0; vertex + 2 < vertices_count; vertex += 3)
+					{
+						const uint32_t first = static_cast<uint32_t>(first_vertex + vertex);
+						m_mesh.indices.insert(m_mesh.indices.end(), { first, first + 1, first + 2 });
+					}
+				}
+
+				// mirroring transforms flip the winding
+				const glm::vec3 axis_x(world_matrix[0].x, world_matrix[0].y, world_matrix[0].z);
+				const glm::vec3 axis_y(world_matrix[1].x, world_matrix[1].y, world_matrix[1].z);
+				const glm::vec3 axis_z(world_matrix[2].x, world_matrix[2].y, world_matrix[2].z);
+				if (glm::dot(glm::cross(axis_x, axis_y), axis_z) < 0.f)
+				{
+					for (size_t index = first_index; index + 2 < m_mesh.indices.size(); index += 3)
+					{
+						std::swap(m_mesh.indices[index + 1], m_mesh.indices[index + 2]);
+					}
+				}
+
+				if (!has_normals)
+				{
+					compute_normals(m_mesh, first_vertex, first_index);
+				}
+				m_mesh.submeshes.push_back({ static_cast<uint32_t>(first_index), static_cast<uint32_t>(m_mesh.indices.size() - first_index) });
+			}
+			return true;
+		}
+
+		struct AccessorView
+		{
+			const char* data = nullptr;
+			size_t count = 0;
+			size_t stride = 0;
+			size_t components_count = 0;
+			int component_type = 0;
+			bool normalized = false;
+		};
+
+		bool get_accessor(const JsonValue& accessor_index, AccessorView& view)
+		{
+			const JsonValue& accessor = m_document["accessors"][accessor_index.as_index()];
+			if (!accessor.is_object())
+			{
+				return error("bad accessor");
+			}
+			if (accessor.contains("sparse"))
+			{
+				return error("sparse accessors are not supported");
+			}
+
+			view.count = accessor["count"].as_index(0);
+			view.components_count = gltf_components_count(accessor["type"].as_string());
+			view.component_type = static_cast<int>(accessor["componentType"].as_number(0));
+			view.normalized = accessor["normalized"].as_bool(false);
+			const size_t element_size = gltf_component_size(view.component_type) * view.components_count;
+			if (element_size == 0)
+			{
+				return error("unsupported accessor type");
+			}
+
+			const JsonValue& buffer_view = m_document["bufferViews"][accessor["bufferView"].as_index()];
+			const size_t buffer_index = buffer_view["buffer"].as_index();
+			if (!buffer_view.is_object() || buffer_index >= m_buffers.size())
+			{
+				return error("accessor without buffer view");
+			}
+
+			view.stride = buffer_view["byteStride"].as_index(0);
+			view.stride = view.stride == 0 ? element_size : view.stride;
+			const size_t view_offset = buffer_view["byteOffset"].as_index(0);
+			const size_t view_length = buffer_view["byteLength"].as_index(0);
+			const size_t accessor_offset = accessor["byteOffset"].as_index(0);
+			const std::vector<char>& buffer = m_buffers[buffer_index];
+			const bool view_fits = view_offset <= buffer.size() && view_length <= buffer.size() - view_offset;
+			const bool accessor_fits = view.count == 0 || (accessor_offset <= view_length && element_size <= view_length - accessor_offset
+				&& view.count - 1 <= (view_length - accessor_offset - element_size) / view.stride);
+			if (!view_fits || !accessor_fits)
+			{
+				return error("accessor is out of its buffer");
+			}
+			view.data = buffer.data() + view_offset + accessor_offset;
+			return true;
+		}
+
+		bool read_floats(const JsonValue& accessor_index, const size_t components_count, std::vector<float>& result)
+		{
+			AccessorView view;
+			if (!get_accessor(accessor_index, view))
+			{
+				return false;
+			}
+			if (view.components_count != components_count)
+			{
+				return error("unexpected attribute type");
+			}
+
+			result.resize(view.count * components_count);
+			for (size_t element = 0; element < view.count; ++element)
+			{
+				const char* source = view.data + element * view.stride;
+				for (size_t component = 0; component < components_count; ++component)
+				{
+					float& value = result[element * components_count + component];
+					switch (view.component_type)
+					{
+					case Float:
+						std::memcpy(&value, source + component * 4, 4);
+						break;
+					case UnsignedByte:
+						value = static_cast<uint8_t>(source[component]);
+						value = view.normalized ? value / 255.f : value;
+						break;
+					case Byte:
+						value = static_cast<int8_t>(source[component]);
+						value = view.normalized ? std::max(value / 127.f, -1.f) : value;
+						break;
+					case UnsignedShort:
+					{
+						uint16_t short_value;
+						std::memcpy(&short_value, source + component * 2, 2);
+						value = view.normalized ? short_value / 65535.f : short_value;
+						break;
+					}
+					case Short:
+					{
+						int16_t short_value;
+						std::memcpy(&short_value, source + component * 2, 2);
+						value = view.normalized ? std::max(short_value / 32767.f, -1.f) : short_value;
+						break;
+					}
+					default:
+						return error("unsupported attribute component type");
+					}
+				}
+			}
+			return true;
+		}
+
+		bool read_indices(const JsonValue& accessor_index, const size_t vertices_count, const size_t first_vertex)
+		{
+			AccessorView view;
+			if (!get_accessor(accessor_index, view))
+			{
+				return false;
+			}
+			if (view.components_count != 1)
+			{
+				return error("indices must be scalars");
+			}
+
+			const size_t first_index = m_mesh.indices.size();
+			m_mesh.indices.resize(first_index + view.count / 3 * 3);
+			for (size_t i = 0; i < view.count / 3 * 3; ++i)
+			{
+				const char* source = view.data + i * view.stride;
+				uint32_t index = 0;
+				switch (view.component_type)
+				{
+				case UnsignedByte:
+					index = static_cast<uint8_t>(source[0]);
+					break;
+				case UnsignedShort:
+				{
+					uint16_t short_index;
+					std::memcpy(&short_index, source, 2);
+					index = short_index;
+					break;
+				}
+				case UnsignedInt:
+					std::memcpy(&index, source, 4);
+					break;
+				default:
+					return error("unsupported index type");
+				}
+
+				if (index >= vertices_count)
+				{
+					return error("index is out of range");
+				}
+				m_mesh.indices[first_index + i] = static_cast<uint32_t>(first_vertex + index);
+			}
+			return true;
+		}
+
+		const std::string& m_path;
+		MeshData& m_mesh;
+		JsonValue m_document;
+		std::vector<std::vector<char>> m_buffers;
+		// attributes of the current primitive
+		std::vector<float> m_positions;
+		std::vector<float> m_normals;
+		std::vector<float> m_uvs;
+	};
+
+
+	bool load_gltf(const std::string& path, MeshData& mesh)
+	{
+		GltfReader reader(path, mesh);
+		return reader.read();
+	}
+
+
+	bool load_mesh_data(const std::string& path, MeshData& mesh)
+	{
+		if (ends_with(path, ".obj"))
+		{
+			return load_obj(path, mesh);
+		}
+		if (ends_with(path, ".gltf") || ends_with(path, ".glb"))
+		{
+			return load_gltf(path, mesh);
+		}
+		if (ends_with(path, ".smesh"))
+		{
+			return load_mesh_file(path, mesh);
+		}
+
+		LOG_ERROR("Unknown mesh format: {0}", path);
+		return false;
+	}
+
+}
@@ -0,0 +1,405 @@
+#include "SimpleEngineCore/MeshLoader.hpp"
+#include "SimpleEngineCore/MeshOptimizer.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "MeshFile.hpp"
+
+#include "SimpleEngineCore/Rendering/OpenGL/VertexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/IndexBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/VertexArray.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/MeshPool.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace SimpleEngine {
+
+	struct MeshLoader::Mesh
+	{
+		std::string path;
+		MeshData data; // freed after upload except bounds, submeshes and lods
+		MeshFile file; // .smesh, unmapped after upload
+		bool optimize = true;
+		bool generate_lods = true;
+		bool use_pool = true;
+		bool parsed = false; // set by the worker before the mesh is put in m_parsed
+		MeshState state = MeshState::Loading;
+
+		// what gets uploaded, points into data or into the mapped file
+		const char* vertex_data = nullptr;
+		size_t vertex_bytes = 0;
+		const char* index_data = nullptr;
+		size_t indices_count = 0;
+		IndexBuffer::EIndexType index_type = IndexBuffer::EIndexType::UInt32;
+
+		// either a place in a pool or own buffers
+		MeshPool* pool = nullptr;
+		MeshPool::Handle pool_handle = MeshPool::invalid_handle;
+		std::unique_ptr<VertexBuffer> vertex_buffer;
+		std::unique_ptr<IndexBuffer> index_buffer;
+		std::unique_ptr<VertexArray> vertex_array;
+		size_t uploaded_vertex_bytes = 0;
+		size_t uploaded_indices = 0;
+	};
+
+
+	static bool is_mesh_file(const std::string& path)
+	{
+		static const char extension[] = ".smesh";
+		const size_t length = sizeof(extension) - 1;
+		if (path.size() < length)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < length; ++i)
+		{
+			if (std::tolower(static_cast<unsigned char>(path[path.size() - length + i])) != extension[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	static BufferLayout get_vertex_layout(const MeshFile& file)
+	{
+		return file.is_open() ? file.get_layout() : BufferLayout
+		{
+			ShaderDataType::Float3,
+			ShaderDataType::Float3,
+			ShaderDataType::Float2
+		};
+	}
+
+
+	// runs on a worker
+	bool MeshLoader::parse(Mesh& mesh)
+	{
+		if (!is_mesh_file(mesh.path))
+		{
+			if (!load_mesh_data(mesh.path, mesh.data))
+			{
+				return false;
+			}
+			if (mesh.optimize)
+			{
+				const MeshOptimizationStatistics statistics = optimize_mesh(mesh.data);
+				LOG_INFO("Mesh {0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}", mesh.path,
+					statistics.before.acmr, statistics.after.acmr, statistics.before.atvr, statistics.after.atvr);
+			}
+			if (mesh.generate_lods)
+			{
+				generate_lods(mesh.data);
+			}
+			mesh.vertex_data = reinterpret_cast<const char*>(mesh.data.vertices.data());
+			mesh.vertex_bytes = mesh.data.vertices.size() * sizeof(float);
+			mesh.index_data = reinterpret_cast<const char*>(mesh.data.indices.data());
+			mesh.indices_count = mesh.data.indices.size();
+			return true;
+		}
+
+		// .smesh files are expected to be saved from optimized data.
+		// Only the header and the indices are read here, vertex pages are touched first by the upload.
+		// Indices are checked because an index past the vertices reads other meshes of the pool on the GPU
+		if (!mesh.file.open(mesh.path))
+		{
+			return false;
+		}
+		if (!mesh.file.check_indices())
+		{
+			LOG_ERROR("Mesh file {0}: index is out of the vertex data", mesh.path);
+			mesh.file.close();
+			return false;
+		}
+		const MeshFileHeader& header = mesh.file.get_header();
+		mesh.vertex_data = static_cast<const char*>(mesh.file.get_vertex_data());
+		mesh.vertex_bytes = mesh.file.get_vertex_data_size();
+		mesh.index_data = static_cast<const char*>(mesh.file.get_index_data());
+		mesh.indices_count = static_cast<size_t>(header.indices_count);
+		mesh.index_type = mesh.file.get_index_type();
+		mesh.data.bounds = mesh.file.get_bounds();
+		for (uint32_t i = 0; i < header.submeshes_count; ++i)
+		{
+			mesh.data.submeshes.push_back({ mesh.file.get_submeshes()[i].first_index, mesh.file.get_submeshes()[i].indices_count });
+		}
+		for (uint32_t i = 0; i < mesh.file.get_lods_count(); ++i)
+		{
+			mesh.data.lods.push_back({ mesh.file.get_lods()[i].first_index, mesh.file.get_lods()[i].indices_count, mesh.file.get_lods()[i].error });
+		}
+		return true;
+	}
+
+
+	MeshLoader::MeshLoader(JobSystem& job_system)
+		: m_job_system(job_system)
+	{
+	}
+
+
+	MeshLoader::~MeshLoader()
+	{
+		m_job_system.wait(m_parsing_jobs);
+	}
+
+
+	MeshHandle MeshLoader::load(const std::string& path)
+	{
+		const uint32_t index = static_cast<uint32_t>(m_meshes.size());
+		m_meshes.push_back(std::make_unique<Mesh>());
+		Mesh* mesh = m_meshes.back().get();
+		mesh->path = path;
+		mesh->optimize = m_optimize_meshes;
+		mesh->generate_lods = m_generate_lods;
+		mesh->use_pool = m_use_mesh_pools;
+		++m_pending_count;
+
+		m_job_system.schedule([this, mesh, index]()
+			{
+				mesh->parsed = parse(*mesh);
+				std::lock_guard<std::mutex> lock(m_parsed_mutex);
+				m_parsed.push_back(index);
+			}, &m_parsing_jobs);
+		return { index };
+	}
+
+
+	void MeshLoader::update()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_parsed_mutex);
+			for (const uint32_t index : m_parsed)
+			{
+				Mesh& mesh = *m_meshes[index];
+				if (mesh.parsed)
+				{
+					mesh.state = MeshState::Uploading;
+					m_upload_queue.push_back(index);
+				}
+				else
+				{
+					LOG_ERROR("MeshLoader: failed to load {0}", mesh.path);
+					mesh.state = MeshState::Failed;
+					--m_pending_count;
+				}
+			}
+			m_parsed.clear();
+		}
+
+		m_last_uploaded_bytes = 0;
+		m_last_compacted_bytes = 0;
+		size_t budget = m_upload_budget == 0 ? SIZE_MAX : m_upload_budget;
+		while (m_upload_queue_first < m_upload_queue.size() && budget > 0)
+		{
+			if (!upload(*m_meshes[m_upload_queue[m_upload_queue_first]], budget))
+			{
+				break;
+			}
+			++m_upload_queue_first;
+		}
+
+		if (m_upload_queue_first == m_upload_queue.size())
+		{
+			m_upload_queue.clear();
+			m_upload_queue_first = 0;
+		}
+
+		// copies on the GPU count against the same budget as uploads
+		for (const std::unique_ptr<MeshPool>& pool : m_pools)
+		{
+			if (budget == 0)
+			{
+				break;
+			}
+			if (m_compaction_threshold > 0.f && pool->get_fragmentation() >= m_compaction_threshold)
+			{
+				const size_t copied = pool->compact(budget);
+				m_last_compacted_bytes += copied;
+				budget -= std::min(budget, copied);
+			}
+		}
+	}
+
+
+	void MeshLoader::unload(const MeshHandle handle)
+	{
+		if (get_state(handle) != MeshState::Ready)
+		{
+			LOG_WARN("MeshLoader: only loaded meshes can be unloaded");
+			return;
+		}
+
+		Mesh& mesh = *m_meshes[handle.index];
+		if (mesh.pool)
+		{
+			mesh.pool->free(mesh.pool_handle);
+			mesh.pool = nullptr;
+			mesh.pool_handle = MeshPool::invalid_handle;
+		}
+		mesh.vertex_array = nullptr;
+		mesh.vertex_buffer = nullptr;
+		mesh.index_buffer = nullptr;
+		mesh.data = MeshData();
+		mesh.state = MeshState::Unloaded;
+	}
+
+
+	// vertices first, then indices, both in pieces that fit the budget. True when the mesh is Ready
+	bool MeshLoader::upload(Mesh& mesh, size_t& budget)
+	{
+		const size_t index_size = IndexBuffer::get_index_size(mesh.index_type);
+		if (mesh.use_pool && !mesh.pool)
+		{
+			mesh.pool = get_pool(mesh);
+			mesh.pool_handle = mesh.pool->allocate(mesh.vertex_bytes / mesh.pool->get_layout().get_stride(), mesh.indices_count);
+		}
+		else if (!mesh.use_pool && !mesh.vertex_buffer)
+		{
+			// storage without data, filled below
+			mesh.vertex_buffer = std::make_unique<VertexBuffer>(nullptr, mesh.vertex_bytes, get_vertex_layout(mesh.file));
+			mesh.index_buffer = std::make_unique<IndexBuffer>(nullptr, mesh.indices_count, VertexBuffer::EUsage::Static, mesh.index_type);
+		}
+
+		if (mesh.uploaded_vertex_bytes < mesh.vertex_bytes)
+		{
+			const size_t size = std::min(budget, mesh.vertex_bytes - mesh.uploaded_vertex_bytes);
+			if (mesh.pool)
+			{
+				mesh.pool->set_vertex_data(mesh.pool_handle, mesh.vertex_data + mesh.uploaded_vertex_bytes, size, mesh.uploaded_vertex_bytes);
+			}
+			else
+			{
+				mesh.vertex_buffer->set_data(mesh.vertex_data + mesh.uploaded_vertex_bytes, size, mesh.uploaded_vertex_bytes);
+			}
+			mesh.uploaded_vertex_bytes += size;
+			m_last_uploaded_bytes += size;
+			budget -= size;
+		}
+
+		if (mesh.uploaded_vertex_bytes == mesh.vertex_bytes && mesh.uploaded_indices < mesh.indices_count)
+		{
+			const size_t count = std::min(budget / index_size, mesh.indices_count - mesh.uploaded_indices);
+			if (count > 0)
+			{
+				if (mesh.pool)
+				{
+					mesh.pool->set_index_data(mesh.pool_handle, mesh.index_data + mesh.uploaded_indices * index_size, count, mesh.uploaded_indices);
+				}
+				else
+				{
+					mesh.index_buffer->set_data(mesh.index_data + mesh.uploaded_indices * index_size, count, mesh.uploaded_indices);
+				}
+				mesh.uploaded_indices += count;
+				m_last_uploaded_bytes += count * index_size;
+				budget -= count * index_size;
+			}
+		}
+
+		if (mesh.uploaded_vertex_bytes < mesh.vertex_bytes || mesh.uploaded_indices < mesh.indices_count)
+		{
+			return false;
+		}
+
+		if (!mesh.pool)
+		{
+			mesh.vertex_array = std::make_unique<VertexArray>();
+			mesh.vertex_array->add_vertex_buffer(*mesh.vertex_buffer);
+			mesh.vertex_array->set_index_buffer(*mesh.index_buffer);
+		}
+
+		// bounds, submeshes and lods stay, the geometry lives on the GPU now
+		std::vector<float>().swap(mesh.data.vertices);
+		std::vector<uint32_t>().swap(mesh.data.indices);
+		mesh.file.close();
+		mesh.vertex_data = nullptr;
+		mesh.index_data = nullptr;
+		mesh.state = MeshState::Ready;
+		--m_pending_count;
+		return true;
+	}
+
+
+	MeshPool* MeshLoader::get_pool(const Mesh& mesh)
+	{
+		const BufferLayout layout = get_vertex_layout(mesh.file);
+		for (const std::unique_ptr<MeshPool>& pool : m_pools)
+		{
+			if (pool->is_compatible(layout, mesh.index_type))
+			{
+				return pool.get();
+			}
+		}
+		m_pools.push_back(std::make_unique<MeshPool>(layout, mesh.index_type));
+		return m_pools.back().get();
+	}
+
+
+	float MeshLoader::get_fragmentation() const
+	{
+		float fragmentation = 0.f;
+		for (const std::unique_ptr<MeshPool>& pool : m_pools)
+		{
+			fragmentation = std::max(fragmentation, pool->get_fragmentation());
+		}
+		return fragmentation;
+	}
+
+
+	MeshState MeshLoader::get_state(const MeshHandle handle) const
+	{
+		return handle.index < m_meshes.size() ? m_meshes[handle.index]->state : MeshState::Failed;
+	}
+
+
+	VertexArray* MeshLoader::get_vertex_array(const MeshHandle handle) const
+	{
+		if (handle.index >= m_meshes.size() || m_meshes[handle.index]->state != MeshState::Ready)
+		{
+			return nullptr;
+		}
+		const Mesh& mesh = *m_meshes[handle.index];
+		return mesh.pool ? mesh.pool->get_vertex_array() : mesh.vertex_array.get();
+	}
+
+
+	MeshRef MeshLoader::get_mesh_ref(const MeshHandle handle) const
+	{
+		MeshRef mesh_ref;
+		mesh_ref.vertex_array = get_vertex_array(handle);
+		if (!mesh_ref.vertex_array)
+		{
+			return mesh_ref;
+		}
+
+		const Mesh& mesh = *m_meshes[handle.index];
+		mesh_ref.lods = mesh.data.lods.empty() ? nullptr : mesh.data.lods.data();
+		mesh_ref.lods_count = static_cast<uint32_t>(mesh.data.lods.size());
+		mesh_ref.range = mesh.pool ? &mesh.pool->get_range(mesh.pool_handle) : nullptr;
+		return mesh_ref;
+	}
+
+
+	const Bounds& MeshLoader::get_bounds(const MeshHandle handle) const
+	{
+		static const Bounds empty_bounds;
+		// still written by the worker while Loading
+		const bool parsed = handle.index < m_meshes.size() && m_meshes[handle.index]->state != MeshState::Loading;
+		return parsed ? m_meshes[handle.index]->data.bounds : empty_bounds;
+	}
+
+
+	const std::vector<MeshData::Submesh>& MeshLoader::get_submeshes(const MeshHandle handle) const
+	{
+		static const std::vector<MeshData::Submesh> no_submeshes;
+		const bool parsed = handle.index < m_meshes.size() && m_meshes[handle.index]->state != MeshState::Loading;
+		return parsed ? m_meshes[handle.index]->data.submeshes : no_submeshes;
+	}
+
+
+	const std::vector<MeshLod>& MeshLoader::get_lods(const MeshHandle handle) const
+	{
+		static const std::vector<MeshLod> no_lods;
+		const bool parsed = handle.index < m_meshes.size() && m_meshes[handle.index]->state != MeshState::Loading;
+		return parsed ? m_meshes[handle.index]->data.lods : no_lods;
+	}
+
+}
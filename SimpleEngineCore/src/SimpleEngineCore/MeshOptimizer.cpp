@@ -0,0 +1,370 @@
+#include "SimpleEngineCore/MeshOptimizer.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	// FIFO cache with timestamps: a vertex is still cached while less than cache_size misses happened after it came in
+	class VertexCacheSimulator
+	{
+	public:
+		VertexCacheSimulator(const size_t vertices_count, const size_t cache_size)
+			: m_timestamps(vertices_count, 0)
+			, m_cache_size(static_cast<uint32_t>(cache_size))
+			, m_timestamp(static_cast<uint32_t>(cache_size) + 1)
+		{
+		}
+
+		bool is_cached(const uint32_t vertex) const { return m_timestamp - m_timestamps[vertex] <= m_cache_size; }
+
+		// returns 1 on a miss
+		uint32_t access(const uint32_t vertex)
+		{
+			if (is_cached(vertex))
+			{
+				return 0;
+			}
+			m_timestamps[vertex] = m_timestamp++;
+			return 1;
+		}
+
+		uint32_t access_triangle(const uint32_t* triangle) { return access(triangle[0]) + access(triangle[1]) + access(triangle[2]); }
+		void flush() { m_timestamp += m_cache_size + 1; }
+
+		// for Tipsify priorities
+		uint32_t get_age(const uint32_t vertex) const { return m_timestamp - m_timestamps[vertex]; }
+
+	private:
+		std::vector<uint32_t> m_timestamps;
+		uint32_t m_cache_size;
+		uint32_t m_timestamp;
+	};
+
+
+	VertexCacheStatistics analyze_vertex_cache(const uint32_t* indices, const size_t indices_count, const size_t vertices_count, const size_t cache_size)
+	{
+		VertexCacheStatistics statistics;
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count == 0)
+		{
+			return statistics;
+		}
+
+		VertexCacheSimulator cache(vertices_count, cache_size);
+		std::vector<bool> referenced(vertices_count, false);
+		size_t referenced_count = 0;
+		for (size_t i = 0; i < triangles_count * 3; ++i)
+		{
+			statistics.vertices_transformed += cache.access(indices[i]);
+			if (!referenced[indices[i]])
+			{
+				referenced[indices[i]] = true;
+				++referenced_count;
+			}
+		}
+		statistics.acmr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(triangles_count);
+		statistics.atvr = static_cast<float>(statistics.vertices_transformed) / static_cast<float>(referenced_count);
+		return statistics;
+	}
+
+
+	void optimize_vertex_cache(uint32_t* indices, const size_t indices_count, const size_t vertices_count, const size_t cache_size)
+	{
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count < 2)
+		{
+			return;
+		}
+		const std::vector<uint32_t> source(indices, indices + triangles_count * 3);
+
+		// triangles of every vertex, packed one vertex after another
+		std::vector<uint32_t> live_triangles(vertices_count, 0);
+		for (const uint32_t vertex : source)
+		{
+			++live_triangles[vertex];
+		}
+		std::vector<uint32_t> adjacency_offsets(vertices_count + 1, 0);
+		for (size_t vertex = 0; vertex < vertices_count; ++vertex)
+		{
+			adjacency_offsets[vertex + 1] = adjacency_offsets[vertex] + live_triangles[vertex];
+		}
+		std::vector<uint32_t> adjacency(source.size());
+		{
+			std::vector<uint32_t> cursors(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (size_t i = 0; i < source.size(); ++i)
+			{
+				adjacency[cursors[source[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		VertexCacheSimulator cache(vertices_count, cache_size);
+		std::vector<bool> emitted(triangles_count, false);
+		std::vector<uint32_t> dead_end_stack;
+		dead_end_stack.reserve(source.size());
+		std::vector<uint32_t> candidates;
+		size_t next_vertex = 0; // for dead ends with an empty stack
+		size_t output = 0;
+
+		uint32_t fanning_vertex = source[0];
+		while (true)
+		{
+			// emit all remaining triangles around the fanning vertex
+			candidates.clear();
+			for (uint32_t i = adjacency_offsets[fanning_vertex]; i < adjacency_offsets[fanning_vertex + 1]; ++i)
+			{
+				const uint32_t triangle = adjacency[i];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+				emitted[triangle] = true;
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex = source[triangle * 3 + corner];
+					indices[output++] = vertex;
+					dead_end_stack.push_back(vertex);
+					candidates.push_back(vertex);
+					--live_triangles[vertex];
+					cache.access(vertex);
+				}
+			}
+
+			// the next one is the oldest vertex that will still be in the cache after its remaining triangles are emitted
+			int64_t best_priority = -1;
+			uint32_t best_vertex = UINT32_MAX;
+			for (const uint32_t vertex : candidates)
+			{
+				if (live_triangles[vertex] == 0)
+				{
+					continue;
+				}
+				const uint32_t age = cache.get_age(vertex);
+				const int64_t priority = age + 2 * live_triangles[vertex] <= cache_size ? age : 0;
+				if (priority > best_priority)
+				{
+					best_priority = priority;
+					best_vertex = vertex;
+				}
+			}
+
+			// dead end: recently used vertices first, then anything left
+			while (best_vertex == UINT32_MAX && !dead_end_stack.empty())
+			{
+				const uint32_t vertex = dead_end_stack.back();
+				dead_end_stack.pop_back();
+				if (live_triangles[vertex] > 0)
+				{
+					best_vertex = vertex;
+				}
+			}
+			while (best_vertex == UINT32_MAX && next_vertex < vertices_count)
+			{
+				if (live_triangles[next_vertex] > 0)
+				{
+					best_vertex = static_cast<uint32_t>(next_vertex);
+				}
+				++next_vertex;
+			}
+			if (best_vertex == UINT32_MAX)
+			{
+				break;
+			}
+			fanning_vertex = best_vertex;
+		}
+	}
+
+
+	void optimize_overdraw(uint32_t* indices, const size_t indices_count, const float* vertices, const size_t vertices_count,
+		const size_t vertex_stride_floats, const float threshold, const size_t cache_size)
+	{
+		const size_t triangles_count = indices_count / 3;
+		if (triangles_count < 2)
+		{
+			return;
+		}
+		const std::vector<uint32_t> source(indices, indices + triangles_count * 3);
+		VertexCacheSimulator cache(vertices_count, cache_size);
+
+		// hard boundaries: a triangle with three misses starts a new patch of the mesh anyway
+		std::vector<uint32_t> patches;
+		for (size_t triangle = 0; triangle < triangles_count; ++triangle)
+		{
+			if (cache.access_triangle(&source[triangle * 3]) == 3 || triangle == 0)
+			{
+				patches.push_back(static_cast<uint32_t>(triangle));
+			}
+		}
+		patches.push_back(static_cast<uint32_t>(triangles_count));
+
+		// soft boundaries: a patch is cut as soon as the piece so far is within threshold of the patch ACMR,
+		// each piece starts with a cold cache, like it would after sorting
+		std::vector<uint32_t> clusters;
+		for (size_t patch = 0; patch + 1 < patches.size(); ++patch)
+		{
+			const uint32_t begin = patches[patch];
+			const uint32_t end = patches[patch + 1];
+
+			cache.flush();
+			uint32_t patch_misses = 0;
+			for (uint32_t triangle = begin; triangle < end; ++triangle)
+			{
+				patch_misses += cache.access_triangle(&source[triangle * 3]);
+			}
+			const float target_acmr = threshold * static_cast<float>(patch_misses) / static_cast<float>(end - begin);
+
+			clusters.push_back(begin);
+			cache.flush();
+			uint32_t misses = 0;
+			uint32_t triangles = 0;
+			for (uint32_t triangle = begin; triangle < end; ++triangle)
+			{
+				misses += cache.access_triangle(&source[triangle * 3]);
+				++triangles;
+				if (triangle + 1 < end && static_cast<float>(misses) <= target_acmr * static_cast<float>(triangles))
+				{
+					clusters.push_back(triangle + 1);
+					cache.flush();
+					misses = 0;
+					triangles = 0;
+				}
+			}
+		}
+		clusters.push_back(static_cast<uint32_t>(triangles_count));
+
+		const auto position = [vertices, vertex_stride_floats](const uint32_t vertex)
+		{
+			const float* p = vertices + static_cast<size_t>(vertex) * vertex_stride_floats;
+			return glm::vec3(p[0], p[1], p[2]);
+		};
+
+		glm::vec3 mesh_center(0.f);
+		for (const uint32_t vertex : source)
+		{
+			mesh_center += position(vertex);
+		}
+		mesh_center = mesh_center * (1.f / static_cast<float>(source.size()));
+
+		// clusters facing away from the center are on the outside of the mesh and go first
+		struct Cluster
+		{
+			uint32_t begin;
+			uint32_t end;
+			float sort_key;
+		};
+		std::vector<Cluster> sorted_clusters;
+		sorted_clusters.reserve(clusters.size() - 1);
+		for (size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster)
+		{
+			glm::vec3 normal(0.f);
+			glm::vec3 center(0.f);
+			float area = 0.f;
+			for (uint32_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+			{
+				const glm::vec3 p0 = position(source[triangle * 3]);
+				const glm::vec3 p1 = position(source[triangle * 3 + 1]);
+				const glm::vec3 p2 = position(source[triangle * 3 + 2]);
+				const glm::vec3 triangle_normal = glm::cross(p1 - p0, p2 - p0);
+				const float triangle_area = glm::length(triangle_normal);
+				normal += triangle_normal;
+				center += (p0 + p1 + p2) * (triangle_area / 3.f);
+				area += triangle_area;
+			}
+
+			float sort_key = 0.f;
+			const float normal_length = glm::length(normal);
+			if (area > 0.f && normal_length > 0.f)
+			{
+				sort_key = glm::dot(center * (1.f / area) - mesh_center, normal * (1.f / normal_length));
+			}
+			sorted_clusters.push_back({ clusters[cluster], clusters[cluster + 1], sort_key });
+		}
+		std::stable_sort(sorted_clusters.begin(), sorted_clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+		size_t output = 0;
+		for (const Cluster& cluster : sorted_clusters)
+		{
+			std::copy(source.begin() + cluster.begin * 3, source.begin() + cluster.end * 3, indices + output);
+			output += (cluster.end - cluster.begin) * 3;
+		}
+	}
+
+
+	size_t build_vertex_fetch_remap(std::vector<uint32_t>& remap, const uint32_t* indices, const size_t indices_count, const size_t vertices_count)
+	{
+		remap.assign(vertices_count, UINT32_MAX);
+		uint32_t next_vertex = 0;
+		for (size_t i = 0; i < indices_count; ++i)
+		{
+			if (remap[indices[i]] == UINT32_MAX)
+			{
+				remap[indices[i]] = next_vertex++;
+			}
+		}
+		return next_vertex;
+	}
+
+
+	MeshOptimizationStatistics optimize_mesh(MeshData& mesh)
+	{
+		MeshOptimizationStatistics statistics;
+		const size_t vertices_count = mesh.get_vertices_count();
+		statistics.before = analyze_vertex_cache(mesh.indices.data(), mesh.indices.size(), vertices_count);
+
+		std::vector<MeshData::Submesh> submeshes = mesh.submeshes;
+		if (submeshes.empty())
+		{
+			submeshes.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()) });
+		}
+
+		// glTF primitives use their own vertex ranges, per submesh arrays only cover that range
+		std::vector<uint32_t> local_indices;
+		for (const MeshData::Submesh& submesh : submeshes)
+		{
+			if (submesh.indices_count < 6)
+			{
+				continue;
+			}
+			const uint32_t* begin = mesh.indices.data() + submesh.first_index;
+			const uint32_t* end = begin + submesh.indices_count;
+			const uint32_t first_vertex = *std::min_element(begin, end);
+			const uint32_t local_vertices_count = *std::max_element(begin, end) - first_vertex + 1;
+
+			local_indices.resize(submesh.indices_count);
+			for (size_t i = 0; i < local_indices.size(); ++i)
+			{
+				local_indices[i] = begin[i] - first_vertex;
+			}
+			optimize_vertex_cache(local_indices.data(), local_indices.size(), local_vertices_count);
+			optimize_overdraw(local_indices.data(), local_indices.size(), mesh.vertices.data() + static_cast<size_t>(first_vertex) * MeshData::vertex_floats,
+				local_vertices_count, MeshData::vertex_floats);
+			for (size_t i = 0; i < local_indices.size(); ++i)
+			{
+				mesh.indices[submesh.first_index + i] = local_indices[i] + first_vertex;
+			}
+		}
+
+		std::vector<uint32_t> remap;
+		const size_t used_vertices_count = build_vertex_fetch_remap(remap, mesh.indices.data(), mesh.indices.size(), vertices_count);
+		std::vector<float> vertices(used_vertices_count * MeshData::vertex_floats);
+		for (size_t vertex = 0; vertex < vertices_count; ++vertex)
+		{
+			if (remap[vertex] != UINT32_MAX)
+			{
+				std::copy_n(mesh.vertices.begin() + vertex * MeshData::vertex_floats, MeshData::vertex_floats,
+					vertices.begin() + static_cast<size_t>(remap[vertex]) * MeshData::vertex_floats);
+			}
+		}
+		mesh.vertices.swap(vertices);
+		for (uint32_t& index : mesh.indices)
+		{
+			index = remap[index];
+		}
+
+		statistics.after = analyze_vertex_cache(mesh.indices.data(), mesh.indices.size(), used_vertices_count);
+		return statistics;
+	}
+
+}
@@ -0,0 +1,494 @@
+#include "SimpleEngineCore/MeshOptimizer.hpp"
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace SimpleEngine {
+
+	// sum of squared distances to planes, weighted by triangle area
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+		double c = 0.0;
+		double weight = 0.0;
+
+		void add_plane(const glm::vec3& normal, const float distance, const double plane_weight)
+		{
+			const double x = normal.x, y = normal.y, z = normal.z, d = distance;
+			a00 += plane_weight * x * x; a01 += plane_weight * x * y; a02 += plane_weight * x * z;
+			a11 += plane_weight * y * y; a12 += plane_weight * y * z; a22 += plane_weight * z * z;
+			b0 += plane_weight * x * d; b1 += plane_weight * y * d; b2 += plane_weight * z * d;
+			c += plane_weight * d * d;
+			weight += plane_weight;
+		}
+
+		void add(const Quadric& other)
+		{
+			a00 += other.a00; a01 += other.a01; a02 += other.a02;
+			a11 += other.a11; a12 += other.a12; a22 += other.a22;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		// weighted mean squared distance
+		double get_error(const glm::vec3& point) const
+		{
+			const double x = point.x, y = point.y, z = point.z;
+			const double error = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z + a22 * z * z
+				+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0.0 ? std::max(error, 0.0) / weight : 0.0;
+		}
+	};
+
+
+	// vertices split on uv or normal seams share a position. The simplifier works on positions ("welded" vertices),
+	// indices keep pointing at the original vertices ("wedges")
+	class Simplifier
+	{
+	public:
+		Simplifier(const uint32_t* indices, const size_t indices_count, const float* vertices, const size_t vertices_count, const size_t vertex_stride_floats)
+			: m_triangles(indices, indices + indices_count / 3 * 3)
+			, m_welded(vertices_count)
+		{
+			weld(vertices, vertices_count, vertex_stride_floats);
+			lock_borders_and_seams();
+			compute_quadrics();
+		}
+
+		float run(const size_t target_indices_count, const float max_error)
+		{
+			const double max_cost = static_cast<double>(max_error) * max_error;
+			double reached_cost = 0.0;
+			while (m_triangles.size() > target_indices_count)
+			{
+				build_adjacency();
+				const size_t collapses_count = collapse_pass(target_indices_count, max_cost, reached_cost);
+				remove_degenerate_triangles();
+				if (collapses_count == 0)
+				{
+					break;
+				}
+			}
+			return static_cast<float>(std::sqrt(reached_cost));
+		}
+
+		std::vector<uint32_t>& get_indices() { return m_triangles; }
+
+	private:
+		struct Collapse
+		{
+			uint32_t from; // welded
+			uint32_t to;
+			double cost;
+		};
+
+		void weld(const float* vertices, const size_t vertices_count, const size_t vertex_stride_floats)
+		{
+			struct PositionHash
+			{
+				size_t operator()(const glm::vec3& position) const
+				{
+					uint32_t bits[3];
+					std::memcpy(bits, &position, sizeof(bits));
+					return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+				}
+			};
+			struct PositionEqual
+			{
+				bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+			};
+
+			std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> welded_ids;
+			welded_ids.reserve(vertices_count);
+			for (size_t vertex = 0; vertex < vertices_count; ++vertex)
+			{
+				const float* p = vertices + vertex * vertex_stride_floats;
+				// + 0.f turns -0 into 0, so both hash the same
+				const glm::vec3 position(p[0] + 0.f, p[1] + 0.f, p[2] + 0.f);
+				const auto inserted = welded_ids.emplace(position, static_cast<uint32_t>(m_positions.size()));
+				if (inserted.second)
+				{
+					m_positions.push_back(position);
+				}
+				m_welded[vertex] = inserted.first->second;
+			}
+		}
+
+		// collapsing one of these away would open holes or tear seams, they are only collapsed into
+		void lock_borders_and_seams()
+		{
+			const size_t welded_count = m_positions.size();
+			m_locked.assign(welded_count, false);
+
+			std::vector<uint32_t> first_wedge(welded_count, UINT32_MAX);
+			for (const uint32_t wedge : m_triangles)
+			{
+				uint32_t& first = first_wedge[m_welded[wedge]];
+				if (first == UINT32_MAX)
+				{
+					first = wedge;
+				}
+				else if (first != wedge)
+				{
+					m_locked[m_welded[wedge]] = true;
+				}
+			}
+
+			// edges used by one triangle are borders, by more than two - non-manifold
+			std::unordered_map<uint64_t, uint32_t> edge_uses;
+			edge_uses.reserve(m_triangles.size());
+			for (size_t i = 0; i < m_triangles.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t a = m_welded[m_triangles[i + corner]];
+					const uint32_t b = m_welded[m_triangles[i + (corner + 1) % 3]];
+					++edge_uses[static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b)];
+				}
+			}
+			for (const auto& edge : edge_uses)
+			{
+				if (edge.second != 2)
+				{
+					m_locked[static_cast<uint32_t>(edge.first >> 32)] = true;
+					m_locked[static_cast<uint32_t>(edge.first)] = true;
+				}
+			}
+		}
+
+		void compute_quadrics()
+		{
+			m_quadrics.assign(m_positions.size(), Quadric());
+			for (size_t i = 0; i < m_triangles.size(); i += 3)
+			{
+				const uint32_t a = m_welded[m_triangles[i]];
+				const uint32_t b = m_welded[m_triangles[i + 1]];
+				const uint32_t c = m_welded[m_triangles[i + 2]];
+				const glm::vec3 normal = glm::cross(m_positions[b] - m_positions[a], m_positions[c] - m_positions[a]);
+				const float length = glm::length(normal);
+				if (length <= 0.f)
+				{
+					continue;
+				}
+				const glm::vec3 unit_normal = normal * (1.f / length);
+				const float distance = -glm::dot(unit_normal, m_positions[a]);
+				for (const uint32_t vertex : { a, b, c })
+				{
+					m_quadrics[vertex].add_plane(unit_normal, distance, 0.5 * length);
+				}
+			}
+		}
+
+		// triangles of every welded vertex
+		void build_adjacency()
+		{
+			const size_t welded_count = m_positions.size();
+			m_adjacency_offsets.assign(welded_count + 1, 0);
+			for (const uint32_t wedge : m_triangles)
+			{
+				++m_adjacency_offsets[m_welded[wedge] + 1];
+			}
+			for (size_t i = 0; i < welded_count; ++i)
+			{
+				m_adjacency_offsets[i + 1] += m_adjacency_offsets[i];
+			}
+			m_adjacency.resize(m_triangles.size());
+			std::vector<uint32_t> cursors(m_adjacency_offsets.begin(), m_adjacency_offsets.end() - 1);
+			for (size_t i = 0; i < m_triangles.size(); ++i)
+			{
+				m_adjacency[cursors[m_welded[m_triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		bool is_degenerate(const uint32_t triangle) const
+		{
+			const uint32_t a = m_welded[m_triangles[triangle * 3]];
+			const uint32_t b = m_welded[m_triangles[triangle * 3 + 1]];
+			const uint32_t c = m_welded[m_triangles[triangle * 3 + 2]];
+			return a == b || b == c || a == c;
+		}
+
+		// collapses in order of cost, every vertex takes part in one collapse per pass at most,
+		// so the costs computed at the start of the pass stay valid
+		size_t collapse_pass(const size_t target_indices_count, const double max_cost, double& reached_cost)
+		{
+			m_collapses.clear();
+			for (size_t i = 0; i < m_triangles.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t a = m_welded[m_triangles[i + corner]];
+					const uint32_t b = m_welded[m_triangles[i + (corner + 1) % 3]];
+					// interior edges are seen from both triangles, take them once
+					if (a < b)
+					{
+						if (!m_locked[a])
+						{
+							m_collapses.push_back({ a, b, get_collapse_cost(a, b) });
+						}
+						if (!m_locked[b])
+						{
+							m_collapses.push_back({ b, a, get_collapse_cost(b, a) });
+						}
+					}
+				}
+			}
+			std::sort(m_collapses.begin(), m_collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			m_touched.assign(m_positions.size(), false);
+			size_t indices_left = m_triangles.size();
+			size_t collapses_count = 0;
+			for (const Collapse& collapse : m_collapses)
+			{
+				if (collapse.cost > max_cost || indices_left <= target_indices_count)
+				{
+					break;
+				}
+				if (m_touched[collapse.from] || m_touched[collapse.to] || !can_collapse(collapse.from, collapse.to))
+				{
+					continue;
+				}
+
+				indices_left -= 3 * perform_collapse(collapse.from, collapse.to);
+				m_touched[collapse.from] = true;
+				m_touched[collapse.to] = true;
+				reached_cost = std::max(reached_cost, collapse.cost);
+				++collapses_count;
+			}
+			return collapses_count;
+		}
+
+		double get_collapse_cost(const uint32_t from, const uint32_t to) const
+		{
+			Quadric quadric = m_quadrics[from];
+			quadric.add(m_quadrics[to]);
+			return quadric.get_error(m_positions[to]);
+		}
+
+		// link condition (no folded or non-manifold result) and no flipped triangles
+		bool can_collapse(const uint32_t from, const uint32_t to)
+		{
+			m_neighbours.clear();
+			size_t shared_triangles = 0;
+			for (uint32_t i = m_adjacency_offsets[from]; i < m_adjacency_offsets[from + 1]; ++i)
+			{
+				const uint32_t triangle = m_adjacency[i];
+				if (is_degenerate(triangle))
+				{
+					continue;
+				}
+
+				uint32_t corner = 0;
+				while (m_welded[m_triangles[triangle * 3 + corner]] != from)
+				{
+					++corner;
+				}
+				const uint32_t next = m_welded[m_triangles[triangle * 3 + (corner + 1) % 3]];
+				const uint32_t previous = m_welded[m_triangles[triangle * 3 + (corner + 2) % 3]];
+				m_neighbours.push_back(next);
+				m_neighbours.push_back(previous);
+				if (next == to || previous == to)
+				{
+					++shared_triangles;
+					continue;
+				}
+
+				const glm::vec3& p1 = m_positions[next];
+				const glm::vec3& p2 = m_positions[previous];
+				const glm::vec3 old_normal = glm::cross(p1 - m_positions[from], p2 - m_positions[from]);
+				const glm::vec3 new_normal = glm::cross(p1 - m_positions[to], p2 - m_positions[to]);
+				if (glm::dot(old_normal, new_normal) < 0.1f * glm::length(old_normal) * glm::length(new_normal))
+				{
+					return false;
+				}
+			}
+			if (shared_triangles == 0)
+			{
+				return false;
+			}
+
+			std::sort(m_neighbours.begin(), m_neighbours.end());
+			m_neighbours.erase(std::unique(m_neighbours.begin(), m_neighbours.end()), m_neighbours.end());
+			m_to_neighbours.clear();
+			for (uint32_t i = m_adjacency_offsets[to]; i < m_adjacency_offsets[to + 1]; ++i)
+			{
+				const uint32_t triangle = m_adjacency[i];
+				if (is_degenerate(triangle))
+				{
+					continue;
+				}
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex = m_welded[m_triangles[triangle * 3 + corner]];
+					if (vertex != to && vertex != from && std::binary_search(m_neighbours.begin(), m_neighbours.end(), vertex))
+					{
+						m_to_neighbours.push_back(vertex);
+					}
+				}
+			}
+			// only the vertices opposite the edge may be neighbours of both
+			std::sort(m_to_neighbours.begin(), m_to_neighbours.end());
+			return static_cast<size_t>(std::unique(m_to_neighbours.begin(), m_to_neighbours.end()) - m_to_neighbours.begin()) == shared_triangles;
+		}
+
+		// returns how many triangles became degenerate
+		size_t perform_collapse(const uint32_t from, const uint32_t to)
+		{
+			// "from" is not on a seam, so its triangles lie in one uv chart and see one wedge of "to"
+			uint32_t to_wedge = UINT32_MAX;
+			for (uint32_t i = m_adjacency_offsets[from]; i < m_adjacency_offsets[from + 1] && to_wedge == UINT32_MAX; ++i)
+			{
+				const uint32_t triangle = m_adjacency[i];
+				for (size_t corner = 0; corner < 3 && !is_degenerate(triangle); ++corner)
+				{
+					if (m_welded[m_triangles[triangle * 3 + corner]] == to)
+					{
+						to_wedge = m_triangles[triangle * 3 + corner];
+					}
+				}
+			}
+
+			size_t degenerate_count = 0;
+			for (uint32_t i = m_adjacency_offsets[from]; i < m_adjacency_offsets[from + 1]; ++i)
+			{
+				const uint32_t triangle = m_adjacency[i];
+				if (is_degenerate(triangle))
+				{
+					continue;
+				}
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					uint32_t& wedge = m_triangles[triangle * 3 + corner];
+					if (m_welded[wedge] == from)
+					{
+						wedge = to_wedge;
+					}
+				}
+				degenerate_count += is_degenerate(triangle) ? 1 : 0;
+			}
+			m_quadrics[to].add(m_quadrics[from]);
+			return degenerate_count;
+		}
+
+		void remove_degenerate_triangles()
+		{
+			size_t output = 0;
+			for (size_t i = 0; i < m_triangles.size(); i += 3)
+			{
+				if (!is_degenerate(static_cast<uint32_t>(i / 3)))
+				{
+					m_triangles[output++] = m_triangles[i];
+					m_triangles[output++] = m_triangles[i + 1];
+					m_triangles[output++] = m_triangles[i + 2];
+				}
+			}
+			m_triangles.resize(output);
+		}
+
+		std::vector<uint32_t> m_triangles; // wedge indices
+		std::vector<uint32_t> m_welded; // wedge -> welded vertex
+		std::vector<glm::vec3> m_positions; // per welded vertex
+		std::vector<bool> m_locked;
+		std::vector<Quadric> m_quadrics;
+
+		// rebuilt every pass
+		std::vector<uint32_t> m_adjacency_offsets;
+		std::vector<uint32_t> m_adjacency;
+		std::vector<Collapse> m_collapses;
+		std::vector<bool> m_touched;
+		std::vector<uint32_t> m_neighbours;
+		std::vector<uint32_t> m_to_neighbours;
+	};
+
+
+	float simplify(std::vector<uint32_t>& result, const uint32_t* indices, const size_t indices_count, const float* vertices, const size_t vertices_count,
+		const size_t vertex_stride_floats, const size_t target_indices_count, const float max_error)
+	{
+		Simplifier simplifier(indices, indices_count, vertices, vertices_count, vertex_stride_floats);
+		const float error = simplifier.run(target_indices_count, max_error);
+		result.swap(simplifier.get_indices());
+		return error;
+	}
+
+
+	void generate_lods(MeshData& mesh, const size_t max_lods_count, const float ratio, const float max_relative_error)
+	{
+		mesh.lods.clear();
+		if (mesh.indices.empty())
+		{
+			return;
+		}
+
+		std::vector<MeshData::Submesh> submeshes = mesh.submeshes;
+		if (submeshes.empty())
+		{
+			submeshes.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()) });
+		}
+
+		const float max_error = glm::length(mesh.bounds.max - mesh.bounds.min) * max_relative_error;
+		const size_t vertices_count = mesh.get_vertices_count();
+		mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.f });
+
+		// every level is simplified from the original, so errors don't pile up through the chain
+		std::vector<uint32_t> level;
+		std::vector<uint32_t> simplified;
+		float scale = 1.f;
+		for (size_t lod = 1; lod < max_lods_count; ++lod)
+		{
+			scale *= ratio;
+			level.clear();
+			float level_error = mesh.lods.back().error;
+			for (const MeshData::Submesh& submesh : submeshes)
+			{
+				const size_t target = static_cast<size_t>(submesh.indices_count * scale) / 3 * 3;
+				const float error = simplify(simplified, mesh.indices.data() + submesh.first_index, submesh.indices_count,
+					mesh.vertices.data(), vertices_count, MeshData::vertex_floats, target, max_error);
+				level.insert(level.end(), simplified.begin(), simplified.end());
+				level_error = std::max(level_error, error);
+			}
+
+			// stuck at the error limit, more levels would be the same
+			if (level.empty() || level.size() > static_cast<uint64_t>(mesh.lods.back().indices_count) * 85 / 100)
+			{
+				break;
+			}
+			optimize_vertex_cache(level.data(), level.size(), vertices_count);
+			mesh.lods.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(level.size()), level_error });
+			mesh.indices.insert(mesh.indices.end(), level.begin(), level.end());
+		}
+
+		if (mesh.lods.size() == 1)
+		{
+			mesh.lods.clear();
+		}
+	}
+
+
+	uint32_t select_lod(const MeshLod* lods, const uint32_t lods_count, const uint32_t current_lod, const float pixels_per_unit,
+		const float threshold_pixels, const float hysteresis)
+	{
+		if (lods_count == 0)
+		{
+			return 0;
+		}
+
+		uint32_t lod = std::min(current_lod, lods_count - 1);
+		while (lod > 0 && lods[lod].error * pixels_per_unit > threshold_pixels * (1.f + hysteresis))
+		{
+			--lod;
+		}
+		while (lod + 1 < lods_count && lods[lod + 1].error * pixels_per_unit <= threshold_pixels * (1.f - hysteresis))
+		{
+			++lod;
+		}
+		return lod;
+	}
+
+}
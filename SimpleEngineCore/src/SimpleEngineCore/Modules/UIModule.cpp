@@ -1,4 +1,5 @@
 #include "UIModule.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/StateCache.hpp"
 
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
@@ -6,14 +7,17 @@
 #include <GLFW/glfw3.h>
 
 namespace SimpleEngine {
-    void UIModule::on_window_create(GLFWwindow* pWindow)
+    void UIModule::on_window_create(GLFWwindow* pWindow, const bool enable_viewports)
     {
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
 
         ImGuiIO& io = ImGui::GetIO();
         io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_DockingEnable;
-        io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_ViewportsEnable;
+        if (enable_viewports)
+        {
+            io.ConfigFlags |= ImGuiConfigFlags_::ImGuiConfigFlags_ViewportsEnable;
+        }
 
         ImGui_ImplOpenGL3_Init();
         ImGui_ImplGlfw_InitForOpenGL(pWindow, true);
@@ -44,6 +48,8 @@ namespace SimpleEngine {
             ImGui::RenderPlatformWindowsDefault();
             glfwMakeContextCurrent(backup_current_context);
         }
+        // the backend sets its own program, vertex array, blending and viewport past the state cache
+        StateCache::invalidate();
     }
 
     void UIModule::ShowExampleAppDockSpace(bool* p_open)
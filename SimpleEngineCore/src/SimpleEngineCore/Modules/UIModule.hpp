@@ -6,7 +6,7 @@ namespace SimpleEngine {
 
 	class UIModule {
 	public:
-		static void on_window_create(GLFWwindow* pWindow);
+		static void on_window_create(GLFWwindow* pWindow, const bool enable_viewports = true);
 		static void on_window_close();
 		static void on_ui_draw_begin();
 		static void on_ui_draw_end();
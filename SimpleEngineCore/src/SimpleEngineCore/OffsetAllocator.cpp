@@ -0,0 +1,357 @@
+#include "OffsetAllocator.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace SimpleEngine {
+
+	static constexpr uint32_t mantissa_bits = 3;
+	static constexpr uint32_t mantissa_value = 1 << mantissa_bits;
+	static constexpr uint32_t mantissa_mask = mantissa_value - 1;
+
+
+	static uint32_t highest_bit(const uint32_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse(&index, value);
+		return index;
+#else
+		return 31 - __builtin_clz(value);
+#endif
+	}
+
+
+	static uint32_t lowest_bit(const uint32_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+#else
+		return __builtin_ctz(value);
+#endif
+	}
+
+
+	// lowest set bit at start or above, UINT32_MAX if none
+	static uint32_t lowest_bit_from(const uint32_t mask, const uint32_t start)
+	{
+		const uint32_t masked = start >= 32 ? 0 : mask & ~((1u << start) - 1);
+		return masked == 0 ? UINT32_MAX : lowest_bit(masked);
+	}
+
+
+	// size to bin: exponent in the high bits, 3 bits of mantissa below. Values under 8 are exact
+	static uint32_t size_to_bin(const uint32_t size, const bool round_up)
+	{
+		if (size < mantissa_value)
+		{
+			return size;
+		}
+		const uint32_t mantissa_start = highest_bit(size) - mantissa_bits;
+		const uint32_t exponent = mantissa_start + 1;
+		uint32_t mantissa = (size >> mantissa_start) & mantissa_mask;
+		if (round_up && (size & ((1u << mantissa_start) - 1)) != 0)
+		{
+			++mantissa; // may carry into the exponent, that's the next bin anyway
+		}
+		return (exponent << mantissa_bits) + mantissa;
+	}
+
+
+	OffsetAllocator::OffsetAllocator(const uint32_t size)
+	{
+		std::fill(std::begin(m_bin_heads), std::end(m_bin_heads), null_node);
+		grow(size);
+	}
+
+
+	OffsetAllocator::Allocation OffsetAllocator::allocate(const uint32_t size, const uint32_t alignment)
+	{
+		if (size == 0 || alignment == 0)
+		{
+			return {};
+		}
+		// worst case padding, so any block from the bin fits after aligning
+		const uint64_t padded_size = static_cast<uint64_t>(size) + alignment - 1;
+		if (padded_size > m_free_size)
+		{
+			return {};
+		}
+
+		uint32_t node_index = find_free_node(static_cast<uint32_t>(padded_size));
+		if (node_index == null_node)
+		{
+			return {};
+		}
+		remove_free_node(node_index);
+
+		// padding in front goes back to the bins as a block of its own
+		Node& node = m_nodes[node_index];
+		const uint32_t padding = (alignment - node.offset % alignment) % alignment;
+		if (padding > 0)
+		{
+			const uint32_t neighbor_prev = node.neighbor_prev;
+			const uint32_t padding_node = insert_free_node(node.offset, padding);
+			Node& aligned = m_nodes[node_index];
+			m_nodes[padding_node].neighbor_prev = neighbor_prev;
+			m_nodes[padding_node].neighbor_next = node_index;
+			if (neighbor_prev != null_node)
+			{
+				m_nodes[neighbor_prev].neighbor_next = padding_node;
+			}
+			aligned.neighbor_prev = padding_node;
+			aligned.offset += padding;
+			aligned.size -= padding;
+		}
+
+		const uint32_t remainder = m_nodes[node_index].size - size;
+		if (remainder > 0)
+		{
+			const uint32_t remainder_node = insert_free_node(m_nodes[node_index].offset + size, remainder);
+			Node& allocated = m_nodes[node_index];
+			m_nodes[remainder_node].neighbor_prev = node_index;
+			m_nodes[remainder_node].neighbor_next = allocated.neighbor_next;
+			if (allocated.neighbor_next != null_node)
+			{
+				m_nodes[allocated.neighbor_next].neighbor_prev = remainder_node;
+			}
+			else
+			{
+				m_last_node = remainder_node;
+			}
+			allocated.neighbor_next = remainder_node;
+			allocated.size = size;
+		}
+
+		Node& allocated = m_nodes[node_index];
+		allocated.used = true;
+		m_free_size -= size;
+		++m_allocations_count;
+		return { allocated.offset, node_index };
+	}
+
+
+	void OffsetAllocator::free(const Allocation allocation)
+	{
+		if (allocation.node >= m_nodes.size() || !m_nodes[allocation.node].used)
+		{
+			return;
+		}
+
+		uint32_t node_index = allocation.node;
+		Node& node = m_nodes[node_index];
+		node.used = false;
+		m_free_size += node.size;
+		--m_allocations_count;
+		uint32_t offset = node.offset;
+		uint32_t size = node.size;
+
+		// free neighbours are taken out of their bins and merged into one block
+		const uint32_t prev = node.neighbor_prev;
+		if (prev != null_node && !m_nodes[prev].used)
+		{
+			remove_free_node(prev);
+			offset = m_nodes[prev].offset;
+			size += m_nodes[prev].size;
+			m_nodes[node_index].neighbor_prev = m_nodes[prev].neighbor_prev;
+			if (m_nodes[prev].neighbor_prev != null_node)
+			{
+				m_nodes[m_nodes[prev].neighbor_prev].neighbor_next = node_index;
+			}
+			m_free_nodes.push_back(prev);
+		}
+
+		const uint32_t next = m_nodes[node_index].neighbor_next;
+		if (next != null_node && !m_nodes[next].used)
+		{
+			remove_free_node(next);
+			size += m_nodes[next].size;
+			m_nodes[node_index].neighbor_next = m_nodes[next].neighbor_next;
+			if (m_nodes[next].neighbor_next != null_node)
+			{
+				m_nodes[m_nodes[next].neighbor_next].neighbor_prev = node_index;
+			}
+			else
+			{
+				m_last_node = node_index;
+			}
+			m_free_nodes.push_back(next);
+		}
+
+		// the merged block takes node_index back with its neighbour links
+		const uint32_t neighbor_prev = m_nodes[node_index].neighbor_prev;
+		const uint32_t neighbor_next = m_nodes[node_index].neighbor_next;
+		m_free_nodes.push_back(node_index);
+		const uint32_t merged = insert_free_node(offset, size);
+		m_nodes[merged].neighbor_prev = neighbor_prev;
+		m_nodes[merged].neighbor_next = neighbor_next;
+		if (neighbor_prev != null_node)
+		{
+			m_nodes[neighbor_prev].neighbor_next = merged;
+		}
+		if (neighbor_next != null_node)
+		{
+			m_nodes[neighbor_next].neighbor_prev = merged;
+		}
+		else
+		{
+			m_last_node = merged;
+		}
+	}
+
+
+	void OffsetAllocator::grow(const uint32_t new_size)
+	{
+		if (new_size <= m_size)
+		{
+			return;
+		}
+
+		uint32_t offset = m_size;
+		uint32_t size = new_size - m_size;
+		uint32_t neighbor_prev = m_last_node;
+		if (m_last_node != null_node && !m_nodes[m_last_node].used)
+		{
+			remove_free_node(m_last_node);
+			offset = m_nodes[m_last_node].offset;
+			size += m_nodes[m_last_node].size;
+			neighbor_prev = m_nodes[m_last_node].neighbor_prev;
+			m_free_nodes.push_back(m_last_node);
+		}
+
+		const uint32_t node = insert_free_node(offset, size);
+		m_nodes[node].neighbor_prev = neighbor_prev;
+		m_nodes[node].neighbor_next = null_node;
+		if (neighbor_prev != null_node)
+		{
+			m_nodes[neighbor_prev].neighbor_next = node;
+		}
+		m_last_node = node;
+		m_free_size += new_size - m_size;
+		m_size = new_size;
+	}
+
+
+	uint32_t OffsetAllocator::get_largest_free_block() const
+	{
+		if (m_used_top_bins == 0)
+		{
+			return 0;
+		}
+		// blocks in one bin differ in size, the biggest bin is walked
+		const uint32_t top = highest_bit(m_used_top_bins);
+		const uint32_t leaf = highest_bit(m_used_leaf_bins[top]);
+		uint32_t largest = 0;
+		for (uint32_t node = m_bin_heads[top * leaf_bins_count + leaf]; node != null_node; node = m_nodes[node].bin_next)
+		{
+			largest = std::max(largest, m_nodes[node].size);
+		}
+		return largest;
+	}
+
+
+	float OffsetAllocator::get_fragmentation() const
+	{
+		return m_free_size == 0 ? 0.f : 1.f - static_cast<float>(get_largest_free_block()) / static_cast<float>(m_free_size);
+	}
+
+
+	uint32_t OffsetAllocator::new_node()
+	{
+		if (!m_free_nodes.empty())
+		{
+			const uint32_t node = m_free_nodes.back();
+			m_free_nodes.pop_back();
+			m_nodes[node] = Node();
+			return node;
+		}
+		m_nodes.emplace_back();
+		return static_cast<uint32_t>(m_nodes.size() - 1);
+	}
+
+
+	uint32_t OffsetAllocator::insert_free_node(const uint32_t offset, const uint32_t size)
+	{
+		// rounded down: every block in a bin is at least the bin's size
+		const uint32_t bin = size_to_bin(size, false);
+		const uint32_t top = bin / leaf_bins_count;
+		const uint32_t leaf = bin % leaf_bins_count;
+		m_used_top_bins |= 1u << top;
+		m_used_leaf_bins[top] |= static_cast<uint8_t>(1u << leaf);
+
+		const uint32_t node_index = new_node();
+		Node& node = m_nodes[node_index];
+		node.offset = offset;
+		node.size = size;
+		node.bin_next = m_bin_heads[bin];
+		if (node.bin_next != null_node)
+		{
+			m_nodes[node.bin_next].bin_prev = node_index;
+		}
+		m_bin_heads[bin] = node_index;
+		return node_index;
+	}
+
+
+	void OffsetAllocator::remove_free_node(const uint32_t node_index)
+	{
+		Node& node = m_nodes[node_index];
+		if (node.bin_prev != null_node)
+		{
+			m_nodes[node.bin_prev].bin_next = node.bin_next;
+		}
+		else
+		{
+			const uint32_t bin = size_to_bin(node.size, false);
+			m_bin_heads[bin] = node.bin_next;
+			if (node.bin_next == null_node)
+			{
+				const uint32_t top = bin / leaf_bins_count;
+				m_used_leaf_bins[top] &= static_cast<uint8_t>(~(1u << (bin % leaf_bins_count)));
+				if (m_used_leaf_bins[top] == 0)
+				{
+					m_used_top_bins &= ~(1u << top);
+				}
+			}
+		}
+		if (node.bin_next != null_node)
+		{
+			m_nodes[node.bin_next].bin_prev = node.bin_prev;
+		}
+		node.bin_prev = null_node;
+		node.bin_next = null_node;
+	}
+
+
+	uint32_t OffsetAllocator::find_free_node(const uint32_t size) const
+	{
+		// rounded up: the bin's smallest block is still big enough
+		const uint32_t min_bin = size_to_bin(size, true);
+		uint32_t top = min_bin / leaf_bins_count;
+		if (top >= top_bins_count)
+		{
+			return null_node;
+		}
+
+		uint32_t leaf = UINT32_MAX;
+		if (m_used_top_bins & (1u << top))
+		{
+			leaf = lowest_bit_from(m_used_leaf_bins[top], min_bin % leaf_bins_count);
+		}
+		if (leaf == UINT32_MAX)
+		{
+			top = lowest_bit_from(m_used_top_bins, top + 1);
+			if (top == UINT32_MAX)
+			{
+				return null_node;
+			}
+			leaf = lowest_bit(m_used_leaf_bins[top]);
+		}
+		return m_bin_heads[top * leaf_bins_count + leaf];
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Hands out ranges of [0, size) without touching the memory, for sub-allocating GPU buffers.
+    // Two level segregated fit (TLSF): free blocks sit in 256 size bins (a tiny float of 5 exponent
+    // and 3 mantissa bits), bitmasks find the first bin that fits, so allocate() and free() are O(1).
+    // Freed blocks are merged with free neighbours right away. Units are up to the caller (bytes, vertices, indices)
+    class OffsetAllocator
+    {
+    public:
+        static constexpr uint32_t no_space = UINT32_MAX;
+
+        struct Allocation
+        {
+            uint32_t offset = no_space;
+            uint32_t node = no_space; // for free()
+
+            bool is_null() const { return offset == no_space; }
+        };
+
+        explicit OffsetAllocator(const uint32_t size);
+
+        // null when there is no free block big enough. alignment - any value, not only powers of two
+        Allocation allocate(const uint32_t size, const uint32_t alignment = 1);
+        void free(const Allocation allocation);
+        // more space at the end, merged with the last free block
+        void grow(const uint32_t new_size);
+
+        uint32_t get_size() const { return m_size; }
+        uint32_t get_allocation_size(const Allocation allocation) const { return m_nodes[allocation.node].size; }
+        uint32_t get_free_size() const { return m_free_size; }
+        uint32_t get_largest_free_block() const;
+        // 0 - all free space in one block, close to 1 - in many small ones
+        float get_fragmentation() const;
+        size_t get_allocations_count() const { return m_allocations_count; }
+
+    private:
+        static constexpr uint32_t top_bins_count = 32;
+        static constexpr uint32_t leaf_bins_count = 8;
+        static constexpr uint32_t bins_count = top_bins_count * leaf_bins_count;
+        static constexpr uint32_t null_node = UINT32_MAX;
+
+        struct Node
+        {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            // free nodes: list of their bin
+            uint32_t bin_prev = null_node;
+            uint32_t bin_next = null_node;
+            // all nodes by offset
+            uint32_t neighbor_prev = null_node;
+            uint32_t neighbor_next = null_node;
+            bool used = false;
+        };
+
+        uint32_t new_node();
+        // a free block, put in its bin
+        uint32_t insert_free_node(const uint32_t offset, const uint32_t size);
+        void remove_free_node(const uint32_t node);
+        // first free node of the smallest bin where every block is at least size
+        uint32_t find_free_node(const uint32_t size) const;
+
+        uint32_t m_size = 0;
+        uint32_t m_free_size = 0;
+        size_t m_allocations_count = 0;
+        uint32_t m_last_node = null_node; // the node at the end, grow() extends it
+        uint32_t m_used_top_bins = 0;
+        uint8_t m_used_leaf_bins[top_bins_count] = {};
+        uint32_t m_bin_heads[bins_count];
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_free_nodes; // unused entries of m_nodes
+    };
+
+}
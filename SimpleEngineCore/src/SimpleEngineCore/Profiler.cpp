@@ -0,0 +1,218 @@
+#include "SimpleEngineCore/Profiler.hpp"
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace SimpleEngine {
+
+	size_t Profiler::s_draw_calls = 0;
+	size_t Profiler::s_state_changes = 0;
+	size_t Profiler::s_redundant_state_changes = 0;
+
+	using History = std::array<float, Profiler::history_size>;
+
+	struct ProfilerSection
+	{
+		const char* name;
+		History cpu_milliseconds{};
+		History gpu_milliseconds{};
+		bool has_gpu_time = false;
+	};
+
+	static std::vector<ProfilerSection> s_sections;
+	static History s_frame_milliseconds{};
+	static History s_draw_calls_history{};
+	static History s_state_changes_history{};
+	static History s_redundant_state_changes_history{};
+	static size_t s_history_index = 0; // slot of the current frame
+	static size_t s_frames_recorded = 0;
+	static std::chrono::steady_clock::time_point s_frame_start;
+
+
+	static ProfilerSection& get_section(const char* name)
+	{
+		for (ProfilerSection& section : s_sections)
+		{
+			if (section.name == name || std::strcmp(section.name, name) == 0)
+			{
+				return section;
+			}
+		}
+		s_sections.push_back({ name });
+		return s_sections.back();
+	}
+
+
+	struct Percentiles
+	{
+		float p50 = 0.f;
+		float p95 = 0.f;
+		float p99 = 0.f;
+		float max = 0.f;
+	};
+
+	static Percentiles calculate_percentiles(const History& history, const size_t count)
+	{
+		Percentiles result;
+		if (count == 0)
+		{
+			return result;
+		}
+
+		// history is a ring, but order doesn't matter here
+		static std::vector<float> sorted;
+		sorted.assign(history.begin(), history.begin() + count);
+		std::sort(sorted.begin(), sorted.end());
+		result.p50 = sorted[count * 50 / 100];
+		result.p95 = sorted[count * 95 / 100];
+		result.p99 = sorted[count * 99 / 100];
+		result.max = sorted.back();
+		return result;
+	}
+
+
+	static float calculate_average(const History& history, const size_t count)
+	{
+		if (count == 0)
+		{
+			return 0.f;
+		}
+
+		float sum = 0.f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			sum += history[i];
+		}
+		return sum / count;
+	}
+
+
+	void Profiler::begin_frame()
+	{
+		s_frame_start = std::chrono::steady_clock::now();
+		s_draw_calls = 0;
+		s_state_changes = 0;
+		s_redundant_state_changes = 0;
+		for (ProfilerSection& section : s_sections)
+		{
+			section.cpu_milliseconds[s_history_index] = 0.f;
+			section.gpu_milliseconds[s_history_index] = 0.f;
+		}
+	}
+
+
+	void Profiler::end_frame()
+	{
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - s_frame_start;
+		s_frame_milliseconds[s_history_index] = static_cast<float>(elapsed.count());
+		s_draw_calls_history[s_history_index] = static_cast<float>(s_draw_calls);
+		s_state_changes_history[s_history_index] = static_cast<float>(s_state_changes);
+		s_redundant_state_changes_history[s_history_index] = static_cast<float>(s_redundant_state_changes);
+
+		s_history_index = (s_history_index + 1) % history_size;
+		s_frames_recorded = std::min(s_frames_recorded + 1, history_size);
+	}
+
+
+	Profiler::FrameStats Profiler::get_last_frame_stats()
+	{
+		const size_t last_frame = (s_history_index + history_size - 1) % history_size;
+		return { s_frame_milliseconds[last_frame],
+			static_cast<size_t>(s_draw_calls_history[last_frame]),
+			static_cast<size_t>(s_state_changes_history[last_frame]),
+			static_cast<size_t>(s_redundant_state_changes_history[last_frame]) };
+	}
+
+
+	void Profiler::add_cpu_time(const char* name, const double milliseconds)
+	{
+		get_section(name).cpu_milliseconds[s_history_index] += static_cast<float>(milliseconds);
+	}
+
+
+	void Profiler::add_gpu_time(const char* name, const double milliseconds)
+	{
+		// GPU results come a few frames late, they are put in the current frame
+		ProfilerSection& section = get_section(name);
+		section.gpu_milliseconds[s_history_index] += static_cast<float>(milliseconds);
+		section.has_gpu_time = true;
+	}
+
+
+	void Profiler::on_ui_draw()
+	{
+		ImGui::Begin("Profiler");
+
+		const size_t last_frame = (s_history_index + history_size - 1) % history_size;
+		const size_t plot_offset = s_frames_recorded < history_size ? 0 : s_history_index;
+		const Percentiles frame_percentiles = calculate_percentiles(s_frame_milliseconds, s_frames_recorded);
+
+		ImGui::Text("Frame: %.2f ms, average %.2f ms", s_frame_milliseconds[last_frame], calculate_average(s_frame_milliseconds, s_frames_recorded));
+		ImGui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", frame_percentiles.p50, frame_percentiles.p95, frame_percentiles.p99, frame_percentiles.max);
+		ImGui::PlotLines("Frame time", s_frame_milliseconds.data(), static_cast<int>(s_frames_recorded), static_cast<int>(plot_offset),
+			nullptr, 0.f, frame_percentiles.max * 1.2f, ImVec2(0, 80));
+
+		ImGui::Text("Draw calls: %.0f  State changes: %.0f  Skipped: %.0f", s_draw_calls_history[last_frame], s_state_changes_history[last_frame],
+			s_redundant_state_changes_history[last_frame]);
+		ImGui::PlotHistogram("Draw calls", s_draw_calls_history.data(), static_cast<int>(s_frames_recorded), static_cast<int>(plot_offset),
+			nullptr, 0.f, 3.4e38f, ImVec2(0, 40));
+
+		ImGui::Separator();
+		if (ImGui::BeginTable("Sections", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Section");
+			ImGui::TableSetupColumn("CPU avg ms");
+			ImGui::TableSetupColumn("CPU p99 ms");
+			ImGui::TableSetupColumn("GPU avg ms");
+			ImGui::TableSetupColumn("GPU p99 ms");
+			ImGui::TableHeadersRow();
+
+			for (const ProfilerSection& section : s_sections)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(section.name);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", calculate_average(section.cpu_milliseconds, s_frames_recorded));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", calculate_percentiles(section.cpu_milliseconds, s_frames_recorded).p99);
+				ImGui::TableNextColumn();
+				if (section.has_gpu_time)
+				{
+					ImGui::Text("%.3f", calculate_average(section.gpu_milliseconds, s_frames_recorded));
+					ImGui::TableNextColumn();
+					ImGui::Text("%.3f", calculate_percentiles(section.gpu_milliseconds, s_frames_recorded).p99);
+				}
+				else
+				{
+					ImGui::TextUnformatted("-");
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted("-");
+				}
+			}
+			ImGui::EndTable();
+		}
+
+		for (const ProfilerSection& section : s_sections)
+		{
+			if (ImGui::CollapsingHeader(section.name))
+			{
+				ImGui::PushID(section.name);
+				ImGui::PlotLines("CPU ms", section.cpu_milliseconds.data(), static_cast<int>(s_frames_recorded), static_cast<int>(plot_offset),
+					nullptr, 0.f, 3.4e38f, ImVec2(0, 50));
+				if (section.has_gpu_time)
+				{
+					ImGui::PlotLines("GPU ms", section.gpu_milliseconds.data(), static_cast<int>(s_frames_recorded), static_cast<int>(plot_offset),
+						nullptr, 0.f, 3.4e38f, ImVec2(0, 50));
+				}
+				ImGui::PopID();
+			}
+		}
+
+		ImGui::End();
+	}
+}
@@ -0,0 +1,37 @@
+#include "SimpleEngineCore/Registry.hpp"
+
+namespace SimpleEngine {
+
+	Entity Registry::create()
+	{
+		if (!m_free_indices.empty())
+		{
+			const uint32_t index = m_free_indices.back();
+			m_free_indices.pop_back();
+			return { index, m_generations[index] };
+		}
+
+		m_generations.push_back(0);
+		return { static_cast<uint32_t>(m_generations.size() - 1), 0 };
+	}
+
+
+	void Registry::destroy(const Entity entity)
+	{
+		if (!is_valid(entity))
+		{
+			return;
+		}
+
+		for (auto& pool : m_pools)
+		{
+			if (pool)
+			{
+				pool->remove(entity);
+			}
+		}
+		++m_generations[entity.index];
+		m_free_indices.push_back(entity.index);
+	}
+
+}
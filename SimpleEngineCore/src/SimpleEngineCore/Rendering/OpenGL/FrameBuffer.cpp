@@ -0,0 +1,99 @@
+#include "FrameBuffer.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+	FrameBuffer::FrameBuffer(const unsigned int width, const unsigned int height)
+		: m_width(width)
+		, m_height(height)
+	{
+		glGenFramebuffers(1, &m_id);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+
+		glGenRenderbuffers(1, &m_color_renderbuffer_id);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_color_renderbuffer_id);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color_renderbuffer_id);
+
+		glGenRenderbuffers(1, &m_depth_renderbuffer_id);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_depth_renderbuffer_id);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depth_renderbuffer_id);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		m_is_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+		if (!m_is_complete)
+		{
+			LOG_CRITICAL("FrameBuffer {0}x{1} is incomplete", width, height);
+		}
+	}
+
+
+	FrameBuffer::~FrameBuffer()
+	{
+		glDeleteRenderbuffers(1, &m_color_renderbuffer_id);
+		glDeleteRenderbuffers(1, &m_depth_renderbuffer_id);
+		glDeleteFramebuffers(1, &m_id);
+	}
+
+
+	FrameBuffer& FrameBuffer::operator=(FrameBuffer&& frame_buffer) noexcept
+	{
+		glDeleteRenderbuffers(1, &m_color_renderbuffer_id);
+		glDeleteRenderbuffers(1, &m_depth_renderbuffer_id);
+		glDeleteFramebuffers(1, &m_id);
+
+		m_id = frame_buffer.m_id;
+		m_color_renderbuffer_id = frame_buffer.m_color_renderbuffer_id;
+		m_depth_renderbuffer_id = frame_buffer.m_depth_renderbuffer_id;
+		m_width = frame_buffer.m_width;
+		m_height = frame_buffer.m_height;
+		m_is_complete = frame_buffer.m_is_complete;
+
+		frame_buffer.m_id = 0;
+		frame_buffer.m_color_renderbuffer_id = 0;
+		frame_buffer.m_depth_renderbuffer_id = 0;
+		frame_buffer.m_is_complete = false;
+		return *this;
+	}
+
+
+	FrameBuffer::FrameBuffer(FrameBuffer&& frame_buffer) noexcept
+		: m_id(frame_buffer.m_id)
+		, m_color_renderbuffer_id(frame_buffer.m_color_renderbuffer_id)
+		, m_depth_renderbuffer_id(frame_buffer.m_depth_renderbuffer_id)
+		, m_width(frame_buffer.m_width)
+		, m_height(frame_buffer.m_height)
+		, m_is_complete(frame_buffer.m_is_complete)
+	{
+		frame_buffer.m_id = 0;
+		frame_buffer.m_color_renderbuffer_id = 0;
+		frame_buffer.m_depth_renderbuffer_id = 0;
+		frame_buffer.m_is_complete = false;
+	}
+
+
+	void FrameBuffer::bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_id);
+	}
+
+
+	void FrameBuffer::unbind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+
+	void FrameBuffer::read_pixels(std::vector<uint8_t>& pixels) const
+	{
+		pixels.resize(static_cast<size_t>(m_width) * m_height * 4);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	}
+}
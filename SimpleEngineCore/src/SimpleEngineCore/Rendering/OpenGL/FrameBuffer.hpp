@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // offscreen render target: RGBA8 color + 24 bit depth renderbuffers
+    class FrameBuffer {
+    public:
+        FrameBuffer(const unsigned int width, const unsigned int height);
+        ~FrameBuffer();
+
+        FrameBuffer(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(const FrameBuffer&) = delete;
+        FrameBuffer& operator=(FrameBuffer&& frame_buffer) noexcept;
+        FrameBuffer(FrameBuffer&& frame_buffer) noexcept;
+
+        void bind() const;
+        static void unbind();
+        bool is_complete() const { return m_is_complete; }
+
+        unsigned int get_width() const { return m_width; }
+        unsigned int get_height() const { return m_height; }
+
+        // RGBA8 rows from bottom to top
+        void read_pixels(std::vector<uint8_t>& pixels) const;
+
+    private:
+        unsigned int m_id = 0;
+        unsigned int m_color_renderbuffer_id = 0;
+        unsigned int m_depth_renderbuffer_id = 0;
+        unsigned int m_width = 0;
+        unsigned int m_height = 0;
+        bool m_is_complete = false;
+    };
+
+}
@@ -0,0 +1,91 @@
+#include "GpuTimer.hpp"
+
+#include "Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct GpuTimerQueries
+	{
+		const char* name;
+		GLuint queries[Renderer_OpenGL::frames_in_flight] = {};
+		bool pending[Renderer_OpenGL::frames_in_flight] = {};
+	};
+
+	static std::vector<GpuTimerQueries> s_timers;
+	static bool s_is_active = false;
+
+
+	static GpuTimerQueries& get_timer(const char* name)
+	{
+		for (GpuTimerQueries& timer : s_timers)
+		{
+			if (timer.name == name || std::strcmp(timer.name, name) == 0)
+			{
+				return timer;
+			}
+		}
+		GpuTimerQueries timer{ name };
+		glGenQueries(Renderer_OpenGL::frames_in_flight, timer.queries);
+		s_timers.push_back(timer);
+		return s_timers.back();
+	}
+
+
+	void GpuTimer::begin(const char* name)
+	{
+		if (s_is_active)
+		{
+			LOG_ERROR("GpuTimer: {0} started inside another scope", name);
+			return;
+		}
+
+		GpuTimerQueries& timer = get_timer(name);
+		const size_t slot = Renderer_OpenGL::get_frame_index();
+		const GLuint query = timer.queries[slot];
+
+		if (timer.pending[slot])
+		{
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 elapsed_ns = 0;
+				glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+				Profiler::add_gpu_time(timer.name, elapsed_ns / 1000000.0);
+			}
+			// otherwise the result is dropped, we never wait for it
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		timer.pending[slot] = true;
+		s_is_active = true;
+	}
+
+
+	void GpuTimer::end()
+	{
+		if (!s_is_active)
+		{
+			return;
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+		s_is_active = false;
+	}
+
+
+	void GpuTimer::shutdown()
+	{
+		for (GpuTimerQueries& timer : s_timers)
+		{
+			glDeleteQueries(Renderer_OpenGL::frames_in_flight, timer.queries);
+		}
+		s_timers.clear();
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+namespace SimpleEngine {
+
+    // GL_TIME_ELAPSED queries, one per frame in flight for every named scope.
+    // A query is read back when its slot comes around again - by then Renderer_OpenGL::end_frame()
+    // has waited on that frame's fence, so reading never stalls. Results go to Profiler.
+    // Scopes can't be nested (OpenGL allows one active GL_TIME_ELAPSED query)
+    class GpuTimer {
+    public:
+        static void begin(const char* name);
+        static void end();
+        static void shutdown(); // deletes queries, needs the context
+    };
+
+    class GpuTimerScope {
+    public:
+        GpuTimerScope(const char* name) { GpuTimer::begin(name); }
+        ~GpuTimerScope() { GpuTimer::end(); }
+
+        GpuTimerScope(const GpuTimerScope&) = delete;
+        GpuTimerScope& operator=(const GpuTimerScope&) = delete;
+    };
+
+}
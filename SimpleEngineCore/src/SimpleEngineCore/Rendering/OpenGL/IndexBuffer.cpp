@@ -1,45 +1,51 @@
 #include "IndexBuffer.hpp"
+#include "StateCache.hpp"
 
 #include "SimpleEngineCore/Log.hpp"
 
 #include <glad/glad.h>
 
+#include <cstring>
+
 namespace SimpleEngine {
 
-    constexpr GLenum usage_to_GLenum(const VertexBuffer::EUsage usage)
+    IndexBuffer::IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage, const EIndexType index_type)
+        : m_count(count)
+        , m_usage(usage)
+        , m_index_type(index_type)
     {
-        switch (usage)
+        glCreateBuffers(1, &m_id);
+        if (usage == VertexBuffer::EUsage::Static)
         {
-        case VertexBuffer::EUsage::Static:  return GL_STATIC_DRAW;
-        case VertexBuffer::EUsage::Dynamic: return GL_DYNAMIC_DRAW;
-        case VertexBuffer::EUsage::Stream:  return GL_STREAM_DRAW;
+            // empty storage is an error, empty meshes get one index
+            glNamedBufferStorage(m_id, (count > 0 ? count : 1) * get_index_size(), count > 0 ? data : nullptr, GL_DYNAMIC_STORAGE_BIT);
+        }
+        else
+        {
+            m_stream_ring.init(m_id, count * get_index_size(), data, count * get_index_size());
         }
-
-        LOG_ERROR("Unknown VertexBuffer usage");
-        return GL_STREAM_DRAW;
-    }
-
-    IndexBuffer::IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage)
-        : m_count(count)
-    {
-        glGenBuffers(1, &m_id);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, usage_to_GLenum(usage));
     }
 
 
     IndexBuffer::~IndexBuffer()
     {
+        StateCache::on_buffer_deleted(m_id);
         glDeleteBuffers(1, &m_id);
     }
 
 
     IndexBuffer& IndexBuffer::operator=(IndexBuffer&& index_buffer) noexcept
     {
+        StateCache::on_buffer_deleted(m_id);
+        glDeleteBuffers(1, &m_id);
         m_id = index_buffer.m_id;
         m_count = index_buffer.m_count;
+        m_usage = index_buffer.m_usage;
+        m_index_type = index_buffer.m_index_type;
+        m_stream_ring = index_buffer.m_stream_ring;
         index_buffer.m_id = 0;
         index_buffer.m_count = 0;
+        index_buffer.m_stream_ring = StreamRing();
         return *this;
     }
 
@@ -47,20 +53,57 @@ namespace SimpleEngine {
     IndexBuffer::IndexBuffer(IndexBuffer&& index_buffer) noexcept
         : m_id(index_buffer.m_id)
         , m_count(index_buffer.m_count)
+        , m_usage(index_buffer.m_usage)
+        , m_index_type(index_buffer.m_index_type)
+        , m_stream_ring(index_buffer.m_stream_ring)
     {
         index_buffer.m_id = 0;
         index_buffer.m_count = 0;
+        index_buffer.m_stream_ring = StreamRing();
+    }
+
+
+    void IndexBuffer::set_data(const void* data, const size_t count, const size_t first_index)
+    {
+        if (m_usage != VertexBuffer::EUsage::Static)
+        {
+            LOG_ERROR("IndexBuffer: set_data() is only for Static buffers, use write()");
+            return;
+        }
+        glNamedBufferSubData(m_id, first_index * get_index_size(), count * get_index_size(), data);
+    }
+
+
+    size_t IndexBuffer::write(const void* data, const size_t count)
+    {
+        const StreamRing::Allocation allocation = allocate(count);
+        if (allocation.data)
+        {
+            std::memcpy(allocation.data, data, count * get_index_size());
+        }
+        return allocation.offset;
+    }
+
+
+    StreamRing::Allocation IndexBuffer::allocate(const size_t count)
+    {
+        if (!m_stream_ring.is_initialized())
+        {
+            LOG_ERROR("IndexBuffer: only Dynamic and Stream buffers can be written after creation");
+            return {};
+        }
+        return m_stream_ring.allocate(count * get_index_size(), get_index_size());
     }
 
 
     void IndexBuffer::bind() const
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+        StateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
     }
 
 
     void IndexBuffer::unbind()
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        StateCache::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 }
\ No newline at end of file
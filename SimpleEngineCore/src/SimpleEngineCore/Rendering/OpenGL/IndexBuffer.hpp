@@ -6,7 +6,17 @@ namespace SimpleEngine {
     class IndexBuffer {
     public:
 
-        IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static);
+        enum class EIndexType
+        {
+            UInt16,
+            UInt32
+        };
+
+        static size_t get_index_size(const EIndexType index_type) { return index_type == EIndexType::UInt16 ? 2 : 4; }
+
+        // for Dynamic and Stream usage count is the capacity of one frame region in indices
+        IndexBuffer(const void* data, const size_t count, const VertexBuffer::EUsage usage = VertexBuffer::EUsage::Static,
+            const EIndexType index_type = EIndexType::UInt32);
         ~IndexBuffer();
 
         IndexBuffer(const IndexBuffer&) = delete;
@@ -16,11 +26,25 @@ namespace SimpleEngine {
 
         void bind() const;
         static void unbind();
+        unsigned int get_id() const { return m_id; }
         size_t get_count() const { return m_count; }
+        EIndexType get_index_type() const { return m_index_type; }
+        size_t get_index_size() const { return get_index_size(m_index_type); }
+
+        // only for Static buffers. Replaces count indices starting at first_index.
+        // Nothing is bound, so a bound vertex array is left as it was
+        void set_data(const void* data, const size_t count, const size_t first_index = 0);
+
+        // only for Dynamic and Stream buffers. Returns offset in bytes, first index to draw is offset / get_index_size()
+        size_t write(const void* data, const size_t count);
+        StreamRing::Allocation allocate(const size_t count);
 
     private:
         unsigned int m_id = 0;
         size_t m_count;
+        VertexBuffer::EUsage m_usage = VertexBuffer::EUsage::Static;
+        EIndexType m_index_type = EIndexType::UInt32;
+        StreamRing m_stream_ring;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "MeshPool.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+namespace SimpleEngine {
+
+	static bool is_same_layout(const BufferLayout& a, const BufferLayout& b)
+	{
+		if (a.get_stride() != b.get_stride() || a.get_instance_divisor() != b.get_instance_divisor()
+			|| a.get_elements().size() != b.get_elements().size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.get_elements().size(); ++i)
+		{
+			if (a.get_elements()[i].type != b.get_elements()[i].type)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	MeshPool::MeshPool(BufferLayout layout, const IndexBuffer::EIndexType index_type, const size_t vertices_capacity, const size_t indices_capacity)
+		: m_layout(std::move(layout))
+		, m_index_type(index_type)
+		, m_vertex_allocator(0)
+		, m_index_allocator(0)
+	{
+		grow(std::max<size_t>(vertices_capacity, 1), std::max<size_t>(indices_capacity, 1));
+	}
+
+
+	bool MeshPool::is_compatible(const BufferLayout& layout, const IndexBuffer::EIndexType index_type) const
+	{
+		return index_type == m_index_type && is_same_layout(layout, m_layout);
+	}
+
+
+	MeshPool::Handle MeshPool::allocate(const size_t vertices_count, const size_t indices_count)
+	{
+		// empty meshes still get a place, so every handle owns both ranges
+		const uint32_t vertices_size = static_cast<uint32_t>(std::max<size_t>(vertices_count, 1));
+		const uint32_t indices_size = static_cast<uint32_t>(std::max<size_t>(indices_count, 1));
+		OffsetAllocator::Allocation vertices = m_vertex_allocator.allocate(vertices_size);
+		OffsetAllocator::Allocation indices = m_index_allocator.allocate(indices_size);
+		if (vertices.is_null() || indices.is_null())
+		{
+			// doubling keeps the copies amortized. The new space at the end fits the mesh on its own
+			size_t new_vertices_capacity = get_vertices_capacity();
+			while (vertices.is_null() && new_vertices_capacity < get_vertices_capacity() + vertices_size)
+			{
+				new_vertices_capacity *= 2;
+			}
+			size_t new_indices_capacity = get_indices_capacity();
+			while (indices.is_null() && new_indices_capacity < get_indices_capacity() + indices_size)
+			{
+				new_indices_capacity *= 2;
+			}
+			grow(new_vertices_capacity, new_indices_capacity);
+			if (vertices.is_null())
+			{
+				vertices = m_vertex_allocator.allocate(vertices_size);
+			}
+			if (indices.is_null())
+			{
+				indices = m_index_allocator.allocate(indices_size);
+			}
+		}
+
+		Handle handle;
+		if (m_free_handles.empty())
+		{
+			handle = static_cast<Handle>(m_meshes.size());
+			m_meshes.emplace_back();
+		}
+		else
+		{
+			handle = m_free_handles.back();
+			m_free_handles.pop_back();
+		}
+		Mesh& mesh = m_meshes[handle];
+		mesh.vertices = vertices;
+		mesh.indices = indices;
+		mesh.vertices_count = static_cast<uint32_t>(vertices_count);
+		mesh.range = { indices.offset, static_cast<uint32_t>(indices_count), static_cast<int32_t>(vertices.offset) };
+		return handle;
+	}
+
+
+	void MeshPool::free(const Handle handle)
+	{
+		Mesh& mesh = m_meshes[handle];
+		m_vertex_allocator.free(mesh.vertices);
+		m_index_allocator.free(mesh.indices);
+		mesh = Mesh();
+		m_free_handles.push_back(handle);
+		m_compacted = false;
+	}
+
+
+	void MeshPool::set_vertex_data(const Handle handle, const void* data, const size_t size, const size_t offset)
+	{
+		const Mesh& mesh = m_meshes[handle];
+		if (offset + size > mesh.vertices_count * m_layout.get_stride())
+		{
+			LOG_ERROR("MeshPool: {0} bytes at {1} don't fit the mesh of {2} vertices", size, offset, mesh.vertices_count);
+			return;
+		}
+		m_vertex_buffer->set_data(data, size, mesh.vertices.offset * m_layout.get_stride() + offset);
+	}
+
+
+	void MeshPool::set_index_data(const Handle handle, const void* data, const size_t count, const size_t first_index)
+	{
+		const Mesh& mesh = m_meshes[handle];
+		if (first_index + count > mesh.range.indices_count)
+		{
+			LOG_ERROR("MeshPool: {0} indices at {1} don't fit the mesh of {2} indices", count, first_index, mesh.range.indices_count);
+			return;
+		}
+		m_index_buffer->set_data(data, count, mesh.indices.offset + first_index);
+	}
+
+
+	size_t MeshPool::compact(const size_t max_bytes)
+	{
+		if (m_compacted)
+		{
+			return 0;
+		}
+
+		// the meshes furthest from the start go first. A new place is taken while the old one is still
+		// allocated, so the copy never overlaps. Draws already submitted read the old place,
+		// GL orders later writes to it after them
+		std::vector<Handle> handles;
+		handles.reserve(m_meshes.size());
+		for (Handle handle = 0; handle < m_meshes.size(); ++handle)
+		{
+			if (!m_meshes[handle].vertices.is_null())
+			{
+				handles.push_back(handle);
+			}
+		}
+
+		const size_t stride = m_layout.get_stride();
+		const size_t index_size = m_index_buffer->get_index_size();
+		size_t copied = 0;
+
+		std::sort(handles.begin(), handles.end(), [this](const Handle a, const Handle b) { return m_meshes[a].vertices.offset > m_meshes[b].vertices.offset; });
+		for (const Handle handle : handles)
+		{
+			if (copied >= max_bytes)
+			{
+				return copied;
+			}
+			Mesh& mesh = m_meshes[handle];
+			const OffsetAllocator::Allocation vertices = m_vertex_allocator.allocate(m_vertex_allocator.get_allocation_size(mesh.vertices));
+			if (vertices.is_null())
+			{
+				continue;
+			}
+			if (vertices.offset > mesh.vertices.offset)
+			{
+				m_vertex_allocator.free(vertices);
+				continue;
+			}
+			const size_t size = mesh.vertices_count * stride;
+			if (size > 0)
+			{
+				glCopyNamedBufferSubData(m_vertex_buffer->get_id(), m_vertex_buffer->get_id(), mesh.vertices.offset * stride, vertices.offset * stride, size);
+			}
+			m_vertex_allocator.free(mesh.vertices);
+			mesh.vertices = vertices;
+			mesh.range.base_vertex = static_cast<int32_t>(vertices.offset);
+			copied += size;
+		}
+
+		std::sort(handles.begin(), handles.end(), [this](const Handle a, const Handle b) { return m_meshes[a].indices.offset > m_meshes[b].indices.offset; });
+		for (const Handle handle : handles)
+		{
+			if (copied >= max_bytes)
+			{
+				return copied;
+			}
+			Mesh& mesh = m_meshes[handle];
+			const OffsetAllocator::Allocation indices = m_index_allocator.allocate(m_index_allocator.get_allocation_size(mesh.indices));
+			if (indices.is_null())
+			{
+				continue;
+			}
+			if (indices.offset > mesh.indices.offset)
+			{
+				m_index_allocator.free(indices);
+				continue;
+			}
+			const size_t size = mesh.range.indices_count * index_size;
+			if (size > 0)
+			{
+				glCopyNamedBufferSubData(m_index_buffer->get_id(), m_index_buffer->get_id(), mesh.indices.offset * index_size, indices.offset * index_size, size);
+			}
+			m_index_allocator.free(mesh.indices);
+			mesh.indices = indices;
+			mesh.range.first_index = indices.offset;
+			copied += size;
+		}
+
+		// a full pass: whatever is left can't be moved lower
+		m_compacted = true;
+		return copied;
+	}
+
+
+	float MeshPool::get_fragmentation() const
+	{
+		return std::max(m_vertex_allocator.get_fragmentation(), m_index_allocator.get_fragmentation());
+	}
+
+
+	void MeshPool::grow(const size_t vertices_capacity, const size_t indices_capacity)
+	{
+		// storage is immutable: new buffers, then a copy on the GPU. Draws already submitted keep the old ones alive.
+		// The whole old buffers are copied, meshes are anywhere in them
+		std::unique_ptr<VertexBuffer> vertex_buffer = std::make_unique<VertexBuffer>(nullptr, vertices_capacity * m_layout.get_stride(), m_layout);
+		std::unique_ptr<IndexBuffer> index_buffer = std::make_unique<IndexBuffer>(nullptr, indices_capacity, VertexBuffer::EUsage::Static, m_index_type);
+		if (get_vertices_count() > 0)
+		{
+			glCopyNamedBufferSubData(m_vertex_buffer->get_id(), vertex_buffer->get_id(), 0, 0, get_vertices_capacity() * m_layout.get_stride());
+		}
+		if (get_indices_count() > 0)
+		{
+			glCopyNamedBufferSubData(m_index_buffer->get_id(), index_buffer->get_id(), 0, 0, get_indices_capacity() * index_buffer->get_index_size());
+		}
+
+		if (m_vertex_buffer)
+		{
+			LOG_INFO("MeshPool: grown to {0} vertices, {1} indices", vertices_capacity, indices_capacity);
+			m_vertex_array.set_vertex_buffer(0, *vertex_buffer);
+		}
+		else
+		{
+			m_vertex_array.add_vertex_buffer(*vertex_buffer);
+		}
+		m_vertex_array.set_index_buffer(*index_buffer);
+
+		m_vertex_buffer = std::move(vertex_buffer);
+		m_index_buffer = std::move(index_buffer);
+		m_vertex_allocator.grow(static_cast<uint32_t>(vertices_capacity));
+		m_index_allocator.grow(static_cast<uint32_t>(indices_capacity));
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "VertexBuffer.hpp"
+#include "IndexBuffer.hpp"
+#include "VertexArray.hpp"
+#include "SimpleEngineCore/Components.hpp"
+#include "SimpleEngineCore/OffsetAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+
+    // Meshes of one vertex layout and index type in shared vertex and index buffers, drawn through one VertexArray
+    // with base vertex and first index, so RenderQueue can draw all of them with one multi draw indirect call.
+    // Indices stay relative to the mesh, base vertex moves them to its vertices.
+    // Ranges come from OffsetAllocators in vertices and indices. Freed ranges leave holes, compact() moves
+    // meshes from the end into them with copies on the GPU
+    class MeshPool {
+    public:
+        static constexpr size_t default_vertices_capacity = 64 * 1024;
+        static constexpr size_t default_indices_capacity = 256 * 1024;
+
+        using Handle = uint32_t;
+        static constexpr Handle invalid_handle = UINT32_MAX;
+
+        MeshPool(BufferLayout layout, const IndexBuffer::EIndexType index_type,
+            const size_t vertices_capacity = default_vertices_capacity, const size_t indices_capacity = default_indices_capacity);
+
+        MeshPool(const MeshPool&) = delete;
+        MeshPool& operator=(const MeshPool&) = delete;
+
+        bool is_compatible(const BufferLayout& layout, const IndexBuffer::EIndexType index_type) const;
+
+        // space for a mesh. When it doesn't fit the buffers are replaced with bigger ones on the GPU,
+        // meshes keep their places
+        Handle allocate(const size_t vertices_count, const size_t indices_count);
+        void free(const Handle handle);
+        // the address stays the same until free(), compact() changes the values
+        const MeshRange& get_range(const Handle handle) const { return m_meshes[handle].range; }
+        // offset in bytes and first_index are relative to the mesh
+        void set_vertex_data(const Handle handle, const void* data, const size_t size, const size_t offset = 0);
+        void set_index_data(const Handle handle, const void* data, const size_t count, const size_t first_index = 0);
+
+        // moves meshes towards the start of the buffers, copying at most about max_bytes.
+        // Returns the bytes copied, 0 once nothing can be moved until the next free()
+        size_t compact(const size_t max_bytes);
+
+        VertexArray* get_vertex_array() { return &m_vertex_array; }
+        const BufferLayout& get_layout() const { return m_layout; }
+        IndexBuffer::EIndexType get_index_type() const { return m_index_type; }
+        size_t get_meshes_count() const { return m_meshes.size() - m_free_handles.size(); }
+        size_t get_vertices_count() const { return m_vertex_allocator.get_size() - m_vertex_allocator.get_free_size(); }
+        size_t get_indices_count() const { return m_index_allocator.get_size() - m_index_allocator.get_free_size(); }
+        size_t get_vertices_capacity() const { return m_vertex_allocator.get_size(); }
+        size_t get_indices_capacity() const { return m_index_allocator.get_size(); }
+        // the worse of the two buffers, see OffsetAllocator::get_fragmentation()
+        float get_fragmentation() const;
+
+    private:
+        struct Mesh
+        {
+            MeshRange range;
+            uint32_t vertices_count = 0;
+            OffsetAllocator::Allocation vertices;
+            OffsetAllocator::Allocation indices;
+        };
+
+        void grow(const size_t vertices_capacity, const size_t indices_capacity);
+
+        BufferLayout m_layout;
+        IndexBuffer::EIndexType m_index_type;
+        std::unique_ptr<VertexBuffer> m_vertex_buffer;
+        std::unique_ptr<IndexBuffer> m_index_buffer;
+        VertexArray m_vertex_array;
+        OffsetAllocator m_vertex_allocator;
+        OffsetAllocator m_index_allocator;
+        std::deque<Mesh> m_meshes; // by handle, deque keeps the ranges in place
+        std::vector<Handle> m_free_handles;
+        bool m_compacted = true; // nothing was freed since compact() gave up
+    };
+
+}
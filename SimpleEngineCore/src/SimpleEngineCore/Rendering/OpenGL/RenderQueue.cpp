@@ -0,0 +1,373 @@
+#include "RenderQueue.hpp"
+
+#include "ShaderProgram.hpp"
+#include "StateCache.hpp"
+#include "StreamBuffer.hpp"
+#include "Texture.hpp"
+#include "VertexArray.hpp"
+#include "Renderer_OpenGL.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	// first size of the transforms and indirect buffers, in commands per frame
+	static constexpr size_t min_indirect_capacity = 1024;
+
+
+	// float bits reordered so that unsigned integer comparison gives the same order as float comparison
+	static uint32_t depth_to_sortable_bits(const float depth)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+	}
+
+
+	uint64_t RenderQueue::make_sort_key(const RenderPass pass, const unsigned int shader_id, const uint16_t material_id, const float depth)
+	{
+		uint32_t depth_bits = depth_to_sortable_bits(depth);
+		if (pass == RenderPass::Transparent)
+		{
+			depth_bits = ~depth_bits; // back to front
+		}
+
+		return (static_cast<uint64_t>(pass) & 0xF) << 60
+			| (static_cast<uint64_t>(shader_id) & 0xFFF) << 48
+			| static_cast<uint64_t>(material_id) << 32
+			| depth_bits;
+	}
+
+
+	// a bigger buffer when this frame's region is full. Deleting the old one is fine, GL keeps its storage
+	// until the draws already submitted from it are done
+	static StreamRing::Allocation allocate_or_grow(std::unique_ptr<StreamBuffer>& buffer, const size_t size, const size_t alignment)
+	{
+		if (buffer)
+		{
+			const StreamRing::Allocation allocation = buffer->try_allocate(size, alignment);
+			if (allocation.data)
+			{
+				return allocation;
+			}
+		}
+
+		size_t region_size = buffer ? buffer->get_region_size() * 2 : 0;
+		while (region_size < size + alignment)
+		{
+			region_size = std::max(region_size * 2, size_t(min_indirect_capacity) * alignment);
+		}
+		buffer = std::make_unique<StreamBuffer>(region_size);
+		return buffer->allocate(size, alignment);
+	}
+
+
+	RenderQueue::RenderQueue() = default;
+	RenderQueue::~RenderQueue() = default;
+
+
+	void RenderQueue::shutdown()
+	{
+		m_transforms = nullptr;
+		m_indirect_commands = nullptr;
+		m_white_texture = nullptr;
+	}
+
+
+	const Texture* RenderQueue::get_white_texture()
+	{
+		if (!m_white_texture)
+		{
+			static constexpr uint8_t white[4] = { 255, 255, 255, 255 };
+			m_white_texture = std::make_unique<Texture2D>(ETextureFormat::RGBA8, 1, 1);
+			m_white_texture->set_rows(0, 0, 0, 1, white);
+		}
+		return m_white_texture.get();
+	}
+
+
+	void CommandList::submit(const DrawCommand& command, const RenderPass pass, const uint16_t material_id, const float depth)
+	{
+		submit(command, RenderQueue::make_sort_key(pass, command.shader_program->get_id(), material_id, depth));
+	}
+
+
+	void CommandList::submit(const DrawCommand& command, const uint64_t sort_key)
+	{
+		if (command.indices_count == 0)
+		{
+			return;
+		}
+		m_commands.push_back(command);
+		m_sort_keys.push_back(sort_key);
+	}
+
+
+	void CommandList::clear()
+	{
+		m_commands.clear();
+		m_sort_keys.clear();
+	}
+
+
+	void CommandList::reserve(const size_t count)
+	{
+		m_commands.reserve(count);
+		m_sort_keys.reserve(count);
+	}
+
+
+	void RenderQueue::begin_frame(const glm::mat4& view_projection_matrix, const size_t command_lists_count)
+	{
+		m_view_projection_matrix = view_projection_matrix;
+		m_commands.clear();
+		m_sort_entries.clear();
+
+		if (m_command_lists.size() < command_lists_count)
+		{
+			m_command_lists.resize(command_lists_count);
+		}
+		m_command_lists_count = command_lists_count;
+		for (size_t i = 0; i < m_command_lists_count; ++i)
+		{
+			m_command_lists[i].clear();
+		}
+	}
+
+
+	void RenderQueue::submit(const DrawCommand& command, const RenderPass pass, const uint16_t material_id, const float depth)
+	{
+		submit(command, make_sort_key(pass, command.shader_program->get_id(), material_id, depth));
+	}
+
+
+	void RenderQueue::submit(const DrawCommand& command, const uint64_t sort_key)
+	{
+		if (command.indices_count == 0)
+		{
+			return;
+		}
+		m_sort_entries.push_back({ sort_key, static_cast<uint32_t>(m_commands.size()) });
+		m_commands.push_back(command);
+	}
+
+
+	void RenderQueue::merge_command_lists()
+	{
+		size_t total_count = m_commands.size();
+		for (size_t i = 0; i < m_command_lists_count; ++i)
+		{
+			total_count += m_command_lists[i].m_commands.size();
+		}
+		m_commands.reserve(total_count);
+		m_sort_entries.reserve(total_count);
+
+		for (size_t i = 0; i < m_command_lists_count; ++i)
+		{
+			CommandList& command_list = m_command_lists[i];
+			const uint32_t first_index = static_cast<uint32_t>(m_commands.size());
+			m_commands.insert(m_commands.end(), command_list.m_commands.begin(), command_list.m_commands.end());
+			for (size_t j = 0; j < command_list.m_sort_keys.size(); ++j)
+			{
+				m_sort_entries.push_back({ command_list.m_sort_keys[j], first_index + static_cast<uint32_t>(j) });
+			}
+			command_list.clear();
+		}
+	}
+
+
+	void RenderQueue::sort()
+	{
+		// LSD radix sort, 8 bits per pass. Stable, so commands with equal keys keep submission order
+		constexpr size_t radix_bits = 8;
+		constexpr size_t buckets_count = 1 << radix_bits;
+		constexpr size_t passes_count = sizeof(uint64_t) * 8 / radix_bits;
+
+		const size_t count = m_sort_entries.size();
+		m_sort_scratch.resize(count);
+
+		// one read over the data builds histograms for all passes
+		std::array<std::array<size_t, buckets_count>, passes_count> histograms{};
+		for (const SortEntry& entry : m_sort_entries)
+		{
+			for (size_t pass = 0; pass < passes_count; ++pass)
+			{
+				++histograms[pass][(entry.key >> (pass * radix_bits)) & (buckets_count - 1)];
+			}
+		}
+
+		SortEntry* src = m_sort_entries.data();
+		SortEntry* dst = m_sort_scratch.data();
+		for (size_t pass = 0; pass < passes_count; ++pass)
+		{
+			auto& histogram = histograms[pass];
+			const size_t shift = pass * radix_bits;
+
+			// all keys have the same digit - nothing to reorder in this pass
+			if (histogram[(src[0].key >> shift) & (buckets_count - 1)] == count)
+			{
+				continue;
+			}
+
+			size_t offset = 0;
+			for (size_t& bucket : histogram)
+			{
+				const size_t bucket_count = bucket;
+				bucket = offset;
+				offset += bucket_count;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				dst[histogram[(src[i].key >> shift) & (buckets_count - 1)]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+
+		if (src != m_sort_entries.data())
+		{
+			m_sort_entries.swap(m_sort_scratch);
+		}
+	}
+
+
+	void RenderQueue::execute()
+	{
+		merge_command_lists();
+		m_indirect_commands_count = 0;
+		m_indirect_draw_calls_count = 0;
+		if (m_commands.empty())
+		{
+			return;
+		}
+
+		sort();
+
+		const ShaderProgram* current_shader_program = nullptr;
+		ShaderProgram::UniformHandle view_projection_matrix_handle = ShaderProgram::invalid_uniform;
+		ShaderProgram::UniformHandle model_matrix_handle = ShaderProgram::invalid_uniform;
+		ShaderProgram::UniformHandle transforms_offset_handle = ShaderProgram::invalid_uniform;
+		const ShaderProgram::StorageBlockInfo* transforms_block = nullptr;
+		const Texture* current_texture = nullptr;
+		RenderState current_state;
+		Renderer_OpenGL::disable_depth_testing();
+		Renderer_OpenGL::disable_blending();
+
+		for (size_t i = 0; i < m_sort_entries.size();)
+		{
+			const DrawCommand& command = m_commands[m_sort_entries[i].index];
+
+			if (command.shader_program != current_shader_program)
+			{
+				current_shader_program = command.shader_program;
+				current_shader_program->bind();
+				view_projection_matrix_handle = current_shader_program->get_uniform_handle("view_projection_matrix");
+				current_shader_program->setMatrix4(view_projection_matrix_handle, m_view_projection_matrix);
+				model_matrix_handle = current_shader_program->get_uniform_handle("model_matrix");
+				transforms_offset_handle = current_shader_program->get_uniform_handle(transforms_offset_name);
+				transforms_block = current_shader_program->get_storage_block(transforms_block_name);
+			}
+
+			if (command.state.depth_test != current_state.depth_test)
+			{
+				command.state.depth_test ? Renderer_OpenGL::enable_depth_testing() : Renderer_OpenGL::disable_depth_testing();
+			}
+			if (command.state.blend != current_state.blend)
+			{
+				command.state.blend ? Renderer_OpenGL::enable_blending() : Renderer_OpenGL::disable_blending();
+			}
+			current_state = command.state;
+
+			const Texture* texture = command.texture ? command.texture : get_white_texture();
+			if (texture != current_texture)
+			{
+				current_texture = texture;
+				texture->bind(0);
+			}
+
+			if (transforms_block)
+			{
+				size_t last = i + 1;
+				while (last < m_sort_entries.size())
+				{
+					const DrawCommand& next = m_commands[m_sort_entries[last].index];
+					if (next.shader_program != command.shader_program || next.vertex_array != command.vertex_array
+						|| next.texture != command.texture || next.state != command.state)
+					{
+						break;
+					}
+					++last;
+				}
+				draw_indirect(i, last, *current_shader_program, transforms_block->binding, transforms_offset_handle);
+				i = last;
+				continue;
+			}
+
+			current_shader_program->setMatrix4(model_matrix_handle, command.model_matrix);
+			if (command.instance_count == 1 && command.base_instance == 0)
+			{
+				if (command.indices_count == DrawCommand::all_indices)
+				{
+					Renderer_OpenGL::draw(*command.vertex_array);
+				}
+				else
+				{
+					Renderer_OpenGL::draw(*command.vertex_array, command.indices_count, command.first_index, command.base_vertex);
+				}
+			}
+			else
+			{
+				const size_t indices_count = command.indices_count == DrawCommand::all_indices ? command.vertex_array->get_indices_count() : command.indices_count;
+				Renderer_OpenGL::draw_instanced(*command.vertex_array, command.instance_count, command.base_instance,
+					indices_count, command.first_index, command.base_vertex);
+			}
+			++i;
+		}
+
+		m_commands.clear();
+		m_sort_entries.clear();
+	}
+
+
+	void RenderQueue::draw_indirect(const size_t first, const size_t last, const ShaderProgram& shader_program, const unsigned int transforms_binding,
+		const int transforms_offset_handle)
+	{
+		using IndirectCommand = Renderer_OpenGL::DrawElementsIndirectCommand;
+		const size_t count = last - first;
+		const StreamRing::Allocation transforms = allocate_or_grow(m_transforms, count * sizeof(glm::mat4), sizeof(glm::mat4));
+		const StreamRing::Allocation indirect_commands = allocate_or_grow(m_indirect_commands, count * sizeof(IndirectCommand), sizeof(IndirectCommand));
+		if (!transforms.data || !indirect_commands.data)
+		{
+			LOG_ERROR("RenderQueue: can't allocate {0} indirect commands, the batch is skipped", count);
+			return;
+		}
+
+		glm::mat4* model_matrices = static_cast<glm::mat4*>(transforms.data);
+		IndirectCommand* commands = static_cast<IndirectCommand*>(indirect_commands.data);
+		const VertexArray& vertex_array = *m_commands[m_sort_entries[first].index].vertex_array;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const DrawCommand& command = m_commands[m_sort_entries[first + i].index];
+			model_matrices[i] = command.model_matrix;
+			commands[i].indices_count = command.indices_count == DrawCommand::all_indices ? static_cast<uint32_t>(vertex_array.get_indices_count()) : command.indices_count;
+			commands[i].instance_count = static_cast<uint32_t>(command.instance_count);
+			commands[i].first_index = command.first_index;
+			commands[i].base_vertex = command.base_vertex;
+			commands[i].base_instance = static_cast<uint32_t>(command.base_instance);
+		}
+
+		// the whole buffer stays bound, the shader finds the batch by offset
+		StateCache::bind_buffer_base(GL_SHADER_STORAGE_BUFFER, transforms_binding, m_transforms->get_id());
+		shader_program.setInt(transforms_offset_handle, static_cast<int>(transforms.offset / sizeof(glm::mat4)));
+		Renderer_OpenGL::multi_draw_indirect(vertex_array, m_indirect_commands->get_id(), indirect_commands.offset, count);
+
+		m_indirect_commands_count += count;
+		++m_indirect_draw_calls_count;
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <glm/mat4x4.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace SimpleEngine {
+    class ShaderProgram;
+    class StreamBuffer;
+    class Texture;
+    class VertexArray;
+
+    // passes are executed in this order (highest bits of the sort key)
+    enum class RenderPass : uint8_t
+    {
+        Opaque = 0,
+        Transparent,
+        Overlay
+    };
+
+    struct RenderState
+    {
+        bool depth_test = false;
+        bool blend = false;
+
+        bool operator==(const RenderState& other) const { return depth_test == other.depth_test && blend == other.blend; }
+        bool operator!=(const RenderState& other) const { return !(*this == other); }
+    };
+
+    // everything needed to issue one draw call, recorded now and executed at the end of the frame
+    struct DrawCommand
+    {
+        const ShaderProgram* shader_program = nullptr;
+        const VertexArray* vertex_array = nullptr;
+        const Texture* texture = nullptr; // bound on unit 0, null - 1x1 white
+        glm::mat4 model_matrix{ 1.f }; // per draw uniform block
+        RenderState state;
+        size_t instance_count = 1; // per instance data comes from instanced vertex buffers of vertex_array
+        size_t base_instance = 0;
+        static constexpr uint32_t all_indices = UINT32_MAX;
+
+        // part of the index buffer (a level of detail, a mesh in a MeshPool), all_indices - all of it.
+        // A command with 0 indices is dropped on submit
+        uint32_t first_index = 0;
+        uint32_t indices_count = all_indices;
+        int32_t base_vertex = 0; // added to every index
+    };
+
+    // commands recorded by one thread without any GL calls. Several lists can be
+    // filled in parallel, RenderQueue::execute() merges them on the GL thread
+    class CommandList {
+    public:
+        void submit(const DrawCommand& command, const RenderPass pass = RenderPass::Opaque, const uint16_t material_id = 0, const float depth = 0.f);
+        void submit(const DrawCommand& command, const uint64_t sort_key);
+        void clear();
+        void reserve(const size_t count);
+
+        size_t get_commands_count() const { return m_commands.size(); }
+
+    private:
+        friend class RenderQueue;
+
+        std::vector<DrawCommand> m_commands;
+        std::vector<uint64_t> m_sort_keys;
+    };
+
+
+    // Shaders with a storage block named transforms_block_name get model matrices from it instead of the model_matrix uniform:
+    //     layout(std430, binding = 0) readonly buffer Transforms { mat4 model_matrices[]; };
+    //     uniform int transforms_offset;
+    //     ... model_matrices[transforms_offset + gl_DrawID] ...
+    // Their commands with the same vertex array, texture and state that follow each other after sorting
+    // are drawn with one glMultiDrawElementsIndirect
+    class RenderQueue {
+    public:
+        static constexpr const char* transforms_block_name = "Transforms";
+        static constexpr const char* transforms_offset_name = "transforms_offset";
+
+        RenderQueue();
+        ~RenderQueue();
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        // key layout (from high to low bits): pass 4 | shader 12 | material 16 | depth 32
+        static uint64_t make_sort_key(const RenderPass pass, const unsigned int shader_id, const uint16_t material_id, const float depth);
+
+        // command_lists_count - lists for parallel recording, get them with get_command_list()
+        void begin_frame(const glm::mat4& view_projection_matrix, const size_t command_lists_count = 0);
+        void submit(const DrawCommand& command, const RenderPass pass = RenderPass::Opaque, const uint16_t material_id = 0, const float depth = 0.f);
+        void submit(const DrawCommand& command, const uint64_t sort_key);
+        // each list must be filled by one thread at a time. Lists are merged in index order,
+        // so equal keys keep the order of list 0, then list 1 and so on
+        CommandList& get_command_list(const size_t index) { return m_command_lists[index]; }
+        size_t get_command_lists_count() const { return m_command_lists_count; }
+        // merges command lists, sorts all recorded commands by key and draws them in one pass, then clears the queue
+        void execute();
+
+        // commands submitted directly, not counting command lists before execute()
+        size_t get_commands_count() const { return m_commands.size(); }
+        // commands drawn by the last execute() through multi draw indirect, and the draw calls that took
+        size_t get_indirect_commands_count() const { return m_indirect_commands_count; }
+        size_t get_indirect_draw_calls_count() const { return m_indirect_draw_calls_count; }
+
+        void shutdown(); // deletes the transforms and indirect buffers and the white texture, needs the context
+
+    private:
+        struct SortEntry
+        {
+            uint64_t key;
+            uint32_t index; // index in m_commands
+        };
+
+        void merge_command_lists();
+        // for commands without a texture, so shaders that sample one still read white
+        const Texture* get_white_texture();
+        void sort();
+        // commands of m_sort_entries [first, last) share shader, vertex array, texture and state
+        void draw_indirect(const size_t first, const size_t last, const ShaderProgram& shader_program, const unsigned int transforms_binding,
+            const int transforms_offset_handle);
+
+        glm::mat4 m_view_projection_matrix{ 1.f };
+        std::vector<DrawCommand> m_commands;
+        std::vector<SortEntry> m_sort_entries;
+        std::vector<SortEntry> m_sort_scratch; // radix sort ping-pong buffer
+        // kept between frames so their memory is reused
+        std::vector<CommandList> m_command_lists;
+        size_t m_command_lists_count = 0;
+
+        // replaced with bigger ones when a frame needs more
+        std::unique_ptr<StreamBuffer> m_transforms;
+        std::unique_ptr<StreamBuffer> m_indirect_commands;
+        std::unique_ptr<Texture> m_white_texture; // created on first use
+        size_t m_indirect_commands_count = 0;
+        size_t m_indirect_draw_calls_count = 0;
+    };
+
+}
@@ -3,12 +3,17 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include "StateCache.hpp"
 #include "VertexArray.hpp"
 #include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
 
 
 namespace SimpleEngine {
 
+	uint64_t Renderer_OpenGL::s_frame_number = 0;
+	static GLsync s_frame_fences[Renderer_OpenGL::frames_in_flight] = {};
+
 	bool Renderer_OpenGL::init(GLFWwindow* pWindow)
 	{
 		glfwMakeContextCurrent(pWindow);
@@ -30,25 +35,121 @@ namespace SimpleEngine {
 		return true;
 	}
 
+	void Renderer_OpenGL::end_frame()
+	{
+		s_frame_fences[get_frame_index()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		++s_frame_number;
+
+		GLsync& fence = s_frame_fences[get_frame_index()];
+		if (!fence)
+		{
+			return;
+		}
+
+		// first wait flushes the command queue, otherwise the fence may never be signaled
+		GLbitfield wait_flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		constexpr GLuint64 timeout_ns = 1000000; // 1 ms
+		while (true)
+		{
+			const GLenum result = glClientWaitSync(fence, wait_flags, timeout_ns);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			{
+				break;
+			}
+			if (result == GL_WAIT_FAILED)
+			{
+				LOG_ERROR("Frame fence wait failed");
+				break;
+			}
+			wait_flags = 0;
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	static GLenum index_type_to_GLenum(const IndexBuffer::EIndexType index_type)
+	{
+		return index_type == IndexBuffer::EIndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
 	void Renderer_OpenGL::draw(const VertexArray& vertex_array)
 	{
 		vertex_array.bind();
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertex_array.get_indices_count()), GL_UNSIGNED_INT, nullptr);
+		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(vertex_array.get_indices_count()), index_type_to_GLenum(vertex_array.get_index_type()), nullptr);
+		Profiler::add_draw_call();
+	}
+
+	void Renderer_OpenGL::draw(const VertexArray& vertex_array, const size_t indices_count, const size_t first_index, const int base_vertex)
+	{
+		vertex_array.bind();
+		glDrawElementsBaseVertex(GL_TRIANGLES,
+			static_cast<GLsizei>(indices_count),
+			index_type_to_GLenum(vertex_array.get_index_type()),
+			reinterpret_cast<const void*>(first_index * IndexBuffer::get_index_size(vertex_array.get_index_type())),
+			base_vertex);
+		Profiler::add_draw_call();
+	}
+
+	void Renderer_OpenGL::draw_instanced(const VertexArray& vertex_array, const size_t instance_count, const size_t base_instance,
+		const size_t indices_count, const size_t first_index, const int base_vertex)
+	{
+		vertex_array.bind();
+		glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES,
+			static_cast<GLsizei>(indices_count == 0 ? vertex_array.get_indices_count() : indices_count),
+			index_type_to_GLenum(vertex_array.get_index_type()),
+			reinterpret_cast<const void*>(first_index * IndexBuffer::get_index_size(vertex_array.get_index_type())),
+			static_cast<GLsizei>(instance_count),
+			base_vertex,
+			static_cast<GLuint>(base_instance));
+		Profiler::add_draw_call();
+	}
+
+	void Renderer_OpenGL::multi_draw_indirect(const VertexArray& vertex_array, const unsigned int indirect_buffer_id, const size_t offset, const size_t draws_count)
+	{
+		vertex_array.bind();
+		StateCache::bind_buffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_id);
+		glMultiDrawElementsIndirect(GL_TRIANGLES,
+			index_type_to_GLenum(vertex_array.get_index_type()),
+			reinterpret_cast<const void*>(offset),
+			static_cast<GLsizei>(draws_count),
+			0);
+		Profiler::add_draw_call();
 	}
 
 	void Renderer_OpenGL::set_clear_color(const float r, const float g, const float b, const float a)
 	{
-		glClearColor(r, g, b, a);
+		StateCache::set_clear_color(r, g, b, a);
 	}
 
 	void Renderer_OpenGL::clear()
 	{
-		glClear(GL_COLOR_BUFFER_BIT);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+
+	void Renderer_OpenGL::enable_depth_testing()
+	{
+		StateCache::set_depth_test(true);
+	}
+
+	void Renderer_OpenGL::disable_depth_testing()
+	{
+		StateCache::set_depth_test(false);
+	}
+
+	void Renderer_OpenGL::enable_blending()
+	{
+		StateCache::set_blend(true);
+		StateCache::set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+
+	void Renderer_OpenGL::disable_blending()
+	{
+		StateCache::set_blend(false);
 	}
 
 	void Renderer_OpenGL::set_viewport(const unsigned int width, const unsigned int height, const unsigned int left_offset, const unsigned int bottom_offset)
 	{
-		glViewport(left_offset, bottom_offset, width, height);
+		StateCache::set_viewport(static_cast<int>(left_offset), static_cast<int>(bottom_offset), static_cast<int>(width), static_cast<int>(height));
 	}
 
 	const char* Renderer_OpenGL::get_vendor_str()
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 struct GLFWwindow;
 
 namespace SimpleEngine {
@@ -7,16 +10,51 @@ namespace SimpleEngine {
 
     class Renderer_OpenGL {
     public:
+        // how many frames CPU can record ahead of GPU. Streaming buffers keep one region per frame in flight
+        static constexpr size_t frames_in_flight = 3;
+
+        // layout glMultiDrawElementsIndirect reads from the indirect buffer
+        struct DrawElementsIndirectCommand
+        {
+            uint32_t indices_count;
+            uint32_t instance_count;
+            uint32_t first_index;
+            int32_t base_vertex;
+            uint32_t base_instance;
+        };
+
         static bool init(GLFWwindow* pWindow);
 
+        // puts a fence after all commands of the frame and moves to the next frame.
+        // Waits until GPU finished the frame that used the same streaming regions before,
+        // so anything written after this call (in on_update too) is safe
+        static void end_frame();
+        static size_t get_frame_index() { return static_cast<size_t>(s_frame_number % frames_in_flight); }
+        static uint64_t get_frame_number() { return s_frame_number; }
+
         static void draw(const VertexArray& vertex_array);
+        // draws part of the index buffer, base_vertex is added to every index
+        static void draw(const VertexArray& vertex_array, const size_t indices_count, const size_t first_index, const int base_vertex = 0);
+        // indices_count = 0 - the whole index buffer
+        static void draw_instanced(const VertexArray& vertex_array, const size_t instance_count, const size_t base_instance = 0,
+            const size_t indices_count = 0, const size_t first_index = 0, const int base_vertex = 0);
+        // draws_count DrawElementsIndirectCommands read from indirect_buffer_id at offset (in bytes), one draw call.
+        // gl_DrawID in shaders is the index of the command
+        static void multi_draw_indirect(const VertexArray& vertex_array, const unsigned int indirect_buffer_id, const size_t offset, const size_t draws_count);
         static void set_clear_color(const float r, const float g, const float b, const float a);
         static void clear();
+        static void enable_depth_testing();
+        static void disable_depth_testing();
+        static void enable_blending();
+        static void disable_blending();
         static void set_viewport(const unsigned int width, const unsigned int height, const unsigned int left_offset = 0, const unsigned int bottom_offset = 0);
 
         static const char* get_vendor_str();
         static const char* get_renderer_str();
         static const char* get_version_str();
+
+    private:
+        static uint64_t s_frame_number;
     };
 
 }
\ No newline at end of file
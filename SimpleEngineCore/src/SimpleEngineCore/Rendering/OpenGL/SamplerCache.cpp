@@ -0,0 +1,78 @@
+#include "SamplerCache.hpp"
+#include "StateCache.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace SimpleEngine {
+
+	struct CachedSampler
+	{
+		SamplerDesc desc;
+		GLuint id;
+	};
+
+	// a handful of descriptions, a linear search is fine
+	static std::vector<CachedSampler> s_samplers;
+
+
+	static GLenum wrap_to_GLenum(const ETextureWrap wrap)
+	{
+		switch (wrap)
+		{
+		case ETextureWrap::Repeat:         return GL_REPEAT;
+		case ETextureWrap::ClampToEdge:    return GL_CLAMP_TO_EDGE;
+		case ETextureWrap::MirroredRepeat: return GL_MIRRORED_REPEAT;
+		}
+		return GL_REPEAT;
+	}
+
+
+	unsigned int SamplerCache::get_sampler(const SamplerDesc& desc)
+	{
+		for (const CachedSampler& sampler : s_samplers)
+		{
+			if (sampler.desc == desc)
+			{
+				return sampler.id;
+			}
+		}
+
+		GLuint id = 0;
+		glCreateSamplers(1, &id);
+		const GLenum min_filter = desc.filter == ETextureFilter::Nearest ? GL_NEAREST_MIPMAP_NEAREST
+			: desc.filter == ETextureFilter::Linear ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+		glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, min_filter);
+		glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, desc.filter == ETextureFilter::Nearest ? GL_NEAREST : GL_LINEAR);
+		glSamplerParameteri(id, GL_TEXTURE_WRAP_S, wrap_to_GLenum(desc.wrap));
+		glSamplerParameteri(id, GL_TEXTURE_WRAP_T, wrap_to_GLenum(desc.wrap));
+		glSamplerParameteri(id, GL_TEXTURE_WRAP_R, wrap_to_GLenum(desc.wrap));
+		if (desc.max_anisotropy > 1.f)
+		{
+			GLfloat max_supported = 1.f;
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_supported);
+			glSamplerParameterf(id, GL_TEXTURE_MAX_ANISOTROPY, std::min(desc.max_anisotropy, max_supported));
+		}
+		s_samplers.push_back({ desc, id });
+		return id;
+	}
+
+
+	size_t SamplerCache::get_samplers_count()
+	{
+		return s_samplers.size();
+	}
+
+
+	void SamplerCache::shutdown()
+	{
+		for (const CachedSampler& sampler : s_samplers)
+		{
+			StateCache::on_sampler_deleted(sampler.id);
+			glDeleteSamplers(1, &sampler.id);
+		}
+		s_samplers.clear();
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    enum class ETextureFilter
+    {
+        Nearest,
+        Linear,
+        Trilinear // linear between mip levels too
+    };
+
+    enum class ETextureWrap
+    {
+        Repeat,
+        ClampToEdge,
+        MirroredRepeat
+    };
+
+    struct SamplerDesc
+    {
+        ETextureFilter filter = ETextureFilter::Trilinear;
+        ETextureWrap wrap = ETextureWrap::Repeat;
+        float max_anisotropy = 1.f; // clamped to what the driver supports
+
+        bool operator==(const SamplerDesc& other) const
+        {
+            return filter == other.filter && wrap == other.wrap && max_anisotropy == other.max_anisotropy;
+        }
+    };
+
+    // one sampler object per description, shared by all textures that use it. GL thread only
+    class SamplerCache {
+    public:
+        // created on the first request
+        static unsigned int get_sampler(const SamplerDesc& desc);
+        static size_t get_samplers_count();
+        // deletes all samplers, needs the context
+        static void shutdown();
+    };
+
+}
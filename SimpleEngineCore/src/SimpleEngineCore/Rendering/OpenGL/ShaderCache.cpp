@@ -0,0 +1,200 @@
+#include "ShaderCache.hpp"
+
+#include "Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace SimpleEngine {
+
+	std::string ShaderCache::s_directory = "shader_cache";
+
+	constexpr uint32_t cache_file_magic = 0x42504553; // "SEPB"
+	constexpr uint32_t cache_file_version = 1;
+
+	struct CacheFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t binary_format;
+		uint32_t binary_size;
+	};
+
+	// FNV-1a
+	static uint64_t hash_string(uint64_t hash, const char* str)
+	{
+		if (!str)
+		{
+			return hash;
+		}
+		for (; *str; ++str)
+		{
+			hash ^= static_cast<uint8_t>(*str);
+			hash *= 0x100000001b3ull;
+		}
+		// separator, so "ab" + "c" and "a" + "bc" give different keys
+		hash ^= 0xFF;
+		hash *= 0x100000001b3ull;
+		return hash;
+	}
+
+
+	void ShaderCache::set_directory(std::string directory)
+	{
+		s_directory = std::move(directory);
+	}
+
+
+	bool ShaderCache::is_enabled()
+	{
+		static GLint formats_count = -1;
+		if (formats_count < 0)
+		{
+			formats_count = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_count);
+			if (formats_count == 0)
+			{
+				LOG_WARN("ShaderCache: driver doesn't support program binaries, cache is disabled");
+			}
+		}
+		return !s_directory.empty() && formats_count > 0;
+	}
+
+
+	uint64_t ShaderCache::make_key(const char* vertex_shader_src, const char* fragment_shader_src)
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		hash = hash_string(hash, vertex_shader_src);
+		hash = hash_string(hash, fragment_shader_src);
+		hash = hash_string(hash, Renderer_OpenGL::get_vendor_str());
+		hash = hash_string(hash, Renderer_OpenGL::get_renderer_str());
+		hash = hash_string(hash, Renderer_OpenGL::get_version_str());
+		return hash;
+	}
+
+
+	std::string ShaderCache::get_file_path(const uint64_t key)
+	{
+		char file_name[32];
+		std::snprintf(file_name, sizeof(file_name), "%016llx.bin", static_cast<unsigned long long>(key));
+		return (std::filesystem::path(s_directory) / file_name).string();
+	}
+
+
+	unsigned int ShaderCache::load_program(const uint64_t key)
+	{
+		if (!is_enabled())
+		{
+			return 0;
+		}
+
+		const std::string file_path = get_file_path(key);
+		std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			return 0;
+		}
+		const std::streamoff file_size = file.tellg();
+		file.seekg(0);
+
+		// the size in the header is checked against the file before anything is allocated
+		CacheFileHeader header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		if (!file || header.magic != cache_file_magic || header.version != cache_file_version
+			|| file_size != static_cast<std::streamoff>(sizeof(header) + static_cast<size_t>(header.binary_size)))
+		{
+			LOG_WARN("ShaderCache: {0} is not a valid cache file, compiling from source", file_path);
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(file_path, error);
+			return 0;
+		}
+
+		std::vector<char> binary(header.binary_size);
+		file.read(binary.data(), binary.size());
+		if (!file)
+		{
+			LOG_WARN("ShaderCache: can't read {0}", file_path);
+			return 0;
+		}
+
+		const GLuint program_id = glCreateProgram();
+		glProgramBinary(program_id, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+		GLint success;
+		glGetProgramiv(program_id, GL_LINK_STATUS, &success);
+		if (success == GL_FALSE)
+		{
+			// driver update or different GPU - the binary is stale, it will be rebuilt from source
+			LOG_WARN("ShaderCache: driver rejected {0}, compiling from source", file_path);
+			glDeleteProgram(program_id);
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(file_path, error);
+			return 0;
+		}
+
+		return program_id;
+	}
+
+
+	void ShaderCache::save_program(const uint64_t key, const unsigned int program_id)
+	{
+		if (!is_enabled())
+		{
+			return;
+		}
+
+		GLint binary_size = 0;
+		glGetProgramiv(program_id, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+		if (binary_size <= 0)
+		{
+			return;
+		}
+
+		std::vector<char> binary(binary_size);
+		GLenum binary_format = 0;
+		glGetProgramBinary(program_id, binary_size, nullptr, &binary_format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(s_directory, error);
+		if (error)
+		{
+			LOG_ERROR("ShaderCache: can't create directory {0}: {1}", s_directory, error.message());
+			return;
+		}
+
+		// written next to the final file and renamed over it, so another process never reads half of it.
+		// Every writer has its own temporary file
+		const std::string file_path = get_file_path(key);
+		char suffix[32];
+		std::snprintf(suffix, sizeof(suffix), ".%08x.tmp", static_cast<unsigned int>(std::random_device()()));
+		const std::string temporary_path = file_path + suffix;
+		{
+			std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+			const CacheFileHeader header{ cache_file_magic, cache_file_version, binary_format, static_cast<uint32_t>(binary_size) };
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(binary.data(), binary.size());
+			file.close();
+			if (!file)
+			{
+				LOG_ERROR("ShaderCache: can't write {0}", temporary_path);
+				std::filesystem::remove(temporary_path, error);
+				return;
+			}
+		}
+
+		std::filesystem::rename(temporary_path, file_path, error);
+		if (error)
+		{
+			LOG_ERROR("ShaderCache: can't move {0} to {1}: {2}", temporary_path, file_path, error.message());
+			std::filesystem::remove(temporary_path, error);
+		}
+	}
+}
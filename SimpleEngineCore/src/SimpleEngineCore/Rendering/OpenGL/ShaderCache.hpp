@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+    // Linked program binaries on disk, one file per program.
+    // Binaries are only valid for the driver that produced them, so driver strings are part of the key
+    class ShaderCache {
+    public:
+        // empty directory disables the cache
+        static void set_directory(std::string directory);
+        static const std::string& get_directory() { return s_directory; }
+
+        // hash of sources + vendor, renderer and version strings of the current context
+        static uint64_t make_key(const char* vertex_shader_src, const char* fragment_shader_src);
+
+        // returns linked program id or 0 if there is no binary or the driver rejected it
+        static unsigned int load_program(const uint64_t key);
+        // program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        static void save_program(const uint64_t key, const unsigned int program_id);
+
+        static bool is_enabled();
+
+    private:
+        static std::string get_file_path(const uint64_t key);
+
+        static std::string s_directory;
+    };
+
+}
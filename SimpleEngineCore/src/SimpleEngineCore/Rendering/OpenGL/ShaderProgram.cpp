@@ -1,10 +1,15 @@
 #include "ShaderProgram.hpp"
+#include "ShaderCache.hpp"
+#include "StateCache.hpp"
 
 #include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Profiler.hpp"
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstring>
+
 namespace SimpleEngine
 {
 	bool create_shader(const char* source, const GLenum shader_type, GLuint& shader_id)
@@ -26,9 +31,85 @@ namespace SimpleEngine
 		return true;
 	}
 
+	// size of the value in bytes as it is passed to glProgramUniform*
+	constexpr size_t uniform_type_size(const GLenum type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT:        return sizeof(GLfloat);
+		case GL_FLOAT_VEC2:   return sizeof(GLfloat) * 2;
+		case GL_FLOAT_VEC3:   return sizeof(GLfloat) * 3;
+		case GL_FLOAT_VEC4:   return sizeof(GLfloat) * 4;
+		case GL_FLOAT_MAT2:   return sizeof(GLfloat) * 4;
+		case GL_FLOAT_MAT3:   return sizeof(GLfloat) * 9;
+		case GL_FLOAT_MAT4:   return sizeof(GLfloat) * 16;
+		case GL_INT_VEC2:     return sizeof(GLint) * 2;
+		case GL_INT_VEC3:     return sizeof(GLint) * 3;
+		case GL_INT_VEC4:     return sizeof(GLint) * 4;
+		case GL_UNSIGNED_INT_VEC2: return sizeof(GLuint) * 2;
+		case GL_UNSIGNED_INT_VEC3: return sizeof(GLuint) * 3;
+		case GL_UNSIGNED_INT_VEC4: return sizeof(GLuint) * 4;
+		case GL_BOOL_VEC2:    return sizeof(GLint) * 2;
+		case GL_BOOL_VEC3:    return sizeof(GLint) * 3;
+		case GL_BOOL_VEC4:    return sizeof(GLint) * 4;
+		}
+
+		// int, uint, bool, samplers and images are all set as a single int
+		return sizeof(GLint);
+	}
+
+
+	// samplers and images, everything that isn't a plain value
+	static bool is_opaque_type(const GLenum type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+		case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2: case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+		case GL_DOUBLE: case GL_DOUBLE_VEC2: case GL_DOUBLE_VEC3: case GL_DOUBLE_VEC4:
+		case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+		case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+		case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+			return false;
+		}
+		return true;
+	}
+
+	// whether glProgramUniform* for setter_type is allowed on a uniform of uniform_type.
+	// Bools take the int and unsigned int calls, samplers and images take glProgramUniform1i
+	static bool is_setter_compatible(const GLenum setter_type, const GLenum uniform_type)
+	{
+		if (setter_type == uniform_type)
+		{
+			return true;
+		}
+		switch (setter_type)
+		{
+		case GL_INT:               return uniform_type == GL_BOOL || is_opaque_type(uniform_type);
+		case GL_UNSIGNED_INT:      return uniform_type == GL_BOOL;
+		case GL_INT_VEC2:
+		case GL_UNSIGNED_INT_VEC2: return uniform_type == GL_BOOL_VEC2;
+		case GL_INT_VEC3:
+		case GL_UNSIGNED_INT_VEC3: return uniform_type == GL_BOOL_VEC3;
+		case GL_INT_VEC4:
+		case GL_UNSIGNED_INT_VEC4: return uniform_type == GL_BOOL_VEC4;
+		}
+		return false;
+	}
+
 
 	ShaderProgram::ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src)
 	{
+		const uint64_t cache_key = ShaderCache::make_key(vertex_shader_src, fragment_shader_src);
+		m_id = ShaderCache::load_program(cache_key);
+		if (m_id != 0)
+		{
+			m_isCompiled = true;
+			reflect();
+			return;
+		}
+
 		GLuint vertex_shader_id = 0;
 		if (!create_shader(vertex_shader_src, GL_VERTEX_SHADER, vertex_shader_id))
 		{
@@ -49,6 +130,7 @@ namespace SimpleEngine
 		m_id = glCreateProgram(); // create program as in c++
 		glAttachShader(m_id, vertex_shader_id); // link vertex shader to program
 		glAttachShader(m_id, fragment_shader_id);
+		glProgramParameteri(m_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // we want to store it in ShaderCache
 		glLinkProgram(m_id);  // create final program and "link all together"
 
 		GLint success;
@@ -67,6 +149,8 @@ namespace SimpleEngine
 		else
 		{
 			m_isCompiled = true;
+			reflect();
+			ShaderCache::save_program(cache_key, m_id);
 		}
 
 		glDetachShader(m_id, vertex_shader_id);
@@ -77,31 +161,378 @@ namespace SimpleEngine
 
 	ShaderProgram::~ShaderProgram()
 	{
+		StateCache::on_program_deleted(m_id);
 		glDeleteProgram(m_id);
 	}
 
 	void ShaderProgram::bind() const
 	{
-		glUseProgram(m_id); // make shader current 
+		StateCache::use_program(m_id); // make shader current 
 	}
 
 	void ShaderProgram::unbind()
 	{
-		glUseProgram(0);
+		StateCache::use_program(0);
+	}
+
+	void ShaderProgram::reflect()
+	{
+		m_uniforms.clear();
+		m_uniform_blocks.clear();
+		m_storage_blocks.clear();
+
+		GLint uniforms_count = 0;
+		GLint max_name_length = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM, GL_ACTIVE_RESOURCES, &uniforms_count);
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM, GL_MAX_NAME_LENGTH, &max_name_length);
+		std::vector<GLchar> name(static_cast<size_t>(max_name_length) + 1);
+
+		size_t cache_size = 0;
+		const GLenum uniform_properties[] = { GL_BLOCK_INDEX, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+		for (GLint i = 0; i < uniforms_count; ++i)
+		{
+			GLint values[4];
+			glGetProgramResourceiv(m_id, GL_UNIFORM, i, 4, uniform_properties, 4, nullptr, values);
+			if (values[0] != -1)
+			{
+				continue; // member of a uniform block, has no location
+			}
+
+			GLsizei name_length = 0;
+			glGetProgramResourceName(m_id, GL_UNIFORM, i, static_cast<GLsizei>(name.size()), &name_length, name.data());
+			std::string uniform_name(name.data(), name_length);
+			if (uniform_name.size() > 3 && uniform_name.compare(uniform_name.size() - 3, 3, "[0]") == 0)
+			{
+				uniform_name.resize(uniform_name.size() - 3);
+			}
+
+			const size_t value_size = uniform_type_size(values[2]) * values[3];
+			m_uniforms.push_back({ std::move(uniform_name), values[1], static_cast<unsigned int>(values[2]), values[3], cache_size, value_size });
+			cache_size += value_size;
+		}
+		m_uniform_values.assign(cache_size, 0);
+		m_uniform_initialized.assign(m_uniforms.size(), false);
+
+		GLint blocks_count = 0;
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &blocks_count);
+		glGetProgramInterfaceiv(m_id, GL_UNIFORM_BLOCK, GL_MAX_NAME_LENGTH, &max_name_length);
+		name.resize(static_cast<size_t>(max_name_length) + 1);
+
+		const GLenum block_properties[] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+		for (GLint i = 0; i < blocks_count; ++i)
+		{
+			GLint values[2];
+			glGetProgramResourceiv(m_id, GL_UNIFORM_BLOCK, i, 2, block_properties, 2, nullptr, values);
+
+			GLsizei name_length = 0;
+			glGetProgramResourceName(m_id, GL_UNIFORM_BLOCK, i, static_cast<GLsizei>(name.size()), &name_length, name.data());
+			m_uniform_blocks.push_back({ std::string(name.data(), name_length), static_cast<unsigned int>(i), static_cast<unsigned int>(values[0]), static_cast<size_t>(values[1]) });
+		}
+
+		glGetProgramInterfaceiv(m_id, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &blocks_count);
+		glGetProgramInterfaceiv(m_id, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &max_name_length);
+		name.resize(static_cast<size_t>(max_name_length) + 1);
+
+		const GLenum storage_block_properties[] = { GL_BUFFER_BINDING };
+		for (GLint i = 0; i < blocks_count; ++i)
+		{
+			GLint binding = 0;
+			glGetProgramResourceiv(m_id, GL_SHADER_STORAGE_BLOCK, i, 1, storage_block_properties, 1, nullptr, &binding);
+
+			GLsizei name_length = 0;
+			glGetProgramResourceName(m_id, GL_SHADER_STORAGE_BLOCK, i, static_cast<GLsizei>(name.size()), &name_length, name.data());
+			m_storage_blocks.push_back({ std::string(name.data(), name_length), static_cast<unsigned int>(i), static_cast<unsigned int>(binding) });
+		}
+	}
+
+	ShaderProgram::UniformHandle ShaderProgram::get_uniform_handle(const char* name) const
+	{
+		// programs have a handful of uniforms, linear search is faster than hashing here
+		for (size_t i = 0; i < m_uniforms.size(); ++i)
+		{
+			if (m_uniforms[i].name == name)
+			{
+				return static_cast<UniformHandle>(i);
+			}
+		}
+		return invalid_uniform;
 	}
 
-	void ShaderProgram::setMatrix4(const char* name, const glm::mat4& matrix) const
+	const ShaderProgram::UniformBlockInfo* ShaderProgram::get_uniform_block(const char* name) const
 	{
-		// we pass uniform matrix in shader
-		glUniformMatrix4fv(glGetUniformLocation(m_id, name), 1, GL_FALSE, glm::value_ptr(matrix));
-		// (location, count (how many matrices), transpose or not, pointer to data)
+		for (const UniformBlockInfo& block : m_uniform_blocks)
+		{
+			if (block.name == name)
+			{
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+
+	const ShaderProgram::StorageBlockInfo* ShaderProgram::get_storage_block(const char* name) const
+	{
+		for (const StorageBlockInfo& block : m_storage_blocks)
+		{
+			if (block.name == name)
+			{
+				return &block;
+			}
+		}
+		return nullptr;
+	}
+
+	void ShaderProgram::set_uniform_block_binding(const char* name, const unsigned int binding)
+	{
+		for (UniformBlockInfo& block : m_uniform_blocks)
+		{
+			if (block.name == name)
+			{
+				if (block.binding != binding)
+				{
+					glUniformBlockBinding(m_id, block.index, binding);
+					block.binding = binding;
+				}
+				return;
+			}
+		}
+		LOG_ERROR("SHADER PROGRAM: uniform block {0} not found", name);
+	}
+
+	bool ShaderProgram::update_cached_value(const UniformHandle handle, const unsigned int type, const void* data, const size_t size) const
+	{
+		if (handle < 0 || static_cast<size_t>(handle) >= m_uniforms.size() || size == 0)
+		{
+			return false;
+		}
+
+		const UniformInfo& uniform = m_uniforms[handle];
+		if (!is_setter_compatible(type, uniform.type))
+		{
+			LOG_ERROR("SHADER PROGRAM: uniform {0} has type 0x{1:X}, it can't be set as 0x{2:X}", uniform.name, uniform.type, type);
+			return false;
+		}
+		if (size > uniform.cache_size)
+		{
+			LOG_ERROR("SHADER PROGRAM: value of size {0} doesn't fit uniform {1}", size, uniform.name);
+			return false;
+		}
+
+		uint8_t* cached_value = m_uniform_values.data() + uniform.cache_offset;
+		if (m_uniform_initialized[handle] && std::memcmp(cached_value, data, size) == 0)
+		{
+			return false;
+		}
+		std::memcpy(cached_value, data, size);
+		m_uniform_initialized[handle] = true;
+		return true;
+	}
+
+	void ShaderProgram::setInt(const UniformHandle handle, const int value) const
+	{
+		if (update_cached_value(handle, GL_INT, &value, sizeof(value)))
+		{
+			glProgramUniform1i(m_id, m_uniforms[handle].location, value);
+		}
+	}
+
+	void ShaderProgram::setUInt(const UniformHandle handle, const unsigned int value) const
+	{
+		if (update_cached_value(handle, GL_UNSIGNED_INT, &value, sizeof(value)))
+		{
+			glProgramUniform1ui(m_id, m_uniforms[handle].location, value);
+		}
+	}
+
+	void ShaderProgram::setBool(const UniformHandle handle, const bool value) const
+	{
+		const GLint int_value = value ? 1 : 0;
+		if (update_cached_value(handle, GL_BOOL, &int_value, sizeof(int_value)))
+		{
+			glProgramUniform1i(m_id, m_uniforms[handle].location, int_value);
+		}
+	}
+
+	void ShaderProgram::setFloat(const UniformHandle handle, const float value) const
+	{
+		if (update_cached_value(handle, GL_FLOAT, &value, sizeof(value)))
+		{
+			glProgramUniform1f(m_id, m_uniforms[handle].location, value);
+		}
+	}
+
+	void ShaderProgram::setIVec2(const UniformHandle handle, const glm::ivec2& value) const
+	{
+		if (update_cached_value(handle, GL_INT_VEC2, glm::value_ptr(value), sizeof(GLint) * 2))
+		{
+			glProgramUniform2iv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setIVec3(const UniformHandle handle, const glm::ivec3& value) const
+	{
+		if (update_cached_value(handle, GL_INT_VEC3, glm::value_ptr(value), sizeof(GLint) * 3))
+		{
+			glProgramUniform3iv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setIVec4(const UniformHandle handle, const glm::ivec4& value) const
+	{
+		if (update_cached_value(handle, GL_INT_VEC4, glm::value_ptr(value), sizeof(GLint) * 4))
+		{
+			glProgramUniform4iv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setUVec2(const UniformHandle handle, const glm::uvec2& value) const
+	{
+		if (update_cached_value(handle, GL_UNSIGNED_INT_VEC2, glm::value_ptr(value), sizeof(GLuint) * 2))
+		{
+			glProgramUniform2uiv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setUVec3(const UniformHandle handle, const glm::uvec3& value) const
+	{
+		if (update_cached_value(handle, GL_UNSIGNED_INT_VEC3, glm::value_ptr(value), sizeof(GLuint) * 3))
+		{
+			glProgramUniform3uiv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setUVec4(const UniformHandle handle, const glm::uvec4& value) const
+	{
+		if (update_cached_value(handle, GL_UNSIGNED_INT_VEC4, glm::value_ptr(value), sizeof(GLuint) * 4))
+		{
+			glProgramUniform4uiv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setVec2(const UniformHandle handle, const glm::vec2& value) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC2, glm::value_ptr(value), sizeof(GLfloat) * 2))
+		{
+			glProgramUniform2fv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setVec3(const UniformHandle handle, const glm::vec3& value) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC3, glm::value_ptr(value), sizeof(GLfloat) * 3))
+		{
+			glProgramUniform3fv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setVec4(const UniformHandle handle, const glm::vec4& value) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC4, glm::value_ptr(value), sizeof(GLfloat) * 4))
+		{
+			glProgramUniform4fv(m_id, m_uniforms[handle].location, 1, glm::value_ptr(value));
+		}
+	}
+
+	void ShaderProgram::setMatrix2(const UniformHandle handle, const glm::mat2& matrix) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_MAT2, glm::value_ptr(matrix), sizeof(GLfloat) * 4))
+		{
+			glProgramUniformMatrix2fv(m_id, m_uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(matrix));
+		}
+	}
+
+	void ShaderProgram::setMatrix3(const UniformHandle handle, const glm::mat3& matrix) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_MAT3, glm::value_ptr(matrix), sizeof(GLfloat) * 9))
+		{
+			glProgramUniformMatrix3fv(m_id, m_uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(matrix));
+		}
+	}
+
+	void ShaderProgram::setMatrix4(const UniformHandle handle, const glm::mat4& matrix) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_MAT4, glm::value_ptr(matrix), sizeof(GLfloat) * 16))
+		{
+			// (program, location, count (how many matrices), transpose or not, pointer to data)
+			glProgramUniformMatrix4fv(m_id, m_uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(matrix));
+		}
+	}
+
+	void ShaderProgram::setIntArray(const UniformHandle handle, const int* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_INT, values, sizeof(GLint) * count))
+		{
+			glProgramUniform1iv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), values);
+		}
+	}
+
+	void ShaderProgram::setUIntArray(const UniformHandle handle, const unsigned int* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_UNSIGNED_INT, values, sizeof(GLuint) * count))
+		{
+			glProgramUniform1uiv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), values);
+		}
+	}
+
+	void ShaderProgram::setFloatArray(const UniformHandle handle, const float* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT, values, sizeof(GLfloat) * count))
+		{
+			glProgramUniform1fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), values);
+		}
+	}
+
+	void ShaderProgram::setVec2Array(const UniformHandle handle, const glm::vec2* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC2, values, sizeof(GLfloat) * 2 * count))
+		{
+			glProgramUniform2fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
+		}
+	}
+
+	void ShaderProgram::setVec3Array(const UniformHandle handle, const glm::vec3* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC3, values, sizeof(GLfloat) * 3 * count))
+		{
+			glProgramUniform3fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
+		}
+	}
+
+	void ShaderProgram::setVec4Array(const UniformHandle handle, const glm::vec4* values, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_VEC4, values, sizeof(GLfloat) * 4 * count))
+		{
+			glProgramUniform4fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
+		}
+	}
+
+	void ShaderProgram::setMatrix3Array(const UniformHandle handle, const glm::mat3* matrices, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_MAT3, matrices, sizeof(GLfloat) * 9 * count))
+		{
+			glProgramUniformMatrix3fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), GL_FALSE, glm::value_ptr(matrices[0]));
+		}
+	}
+
+	void ShaderProgram::setMatrix4Array(const UniformHandle handle, const glm::mat4* matrices, const size_t count) const
+	{
+		if (update_cached_value(handle, GL_FLOAT_MAT4, matrices, sizeof(GLfloat) * 16 * count))
+		{
+			glProgramUniformMatrix4fv(m_id, m_uniforms[handle].location, static_cast<GLsizei>(count), GL_FALSE, glm::value_ptr(matrices[0]));
+		}
 	}
 
 	ShaderProgram& ShaderProgram::operator=(ShaderProgram&& shaderProgram)
 	{
+		StateCache::on_program_deleted(m_id);
 		glDeleteProgram(m_id);
 		m_id = shaderProgram.m_id;
 		m_isCompiled = shaderProgram.m_isCompiled;
+		m_uniforms = std::move(shaderProgram.m_uniforms);
+		m_uniform_blocks = std::move(shaderProgram.m_uniform_blocks);
+		m_storage_blocks = std::move(shaderProgram.m_storage_blocks);
+		m_uniform_values = std::move(shaderProgram.m_uniform_values);
+		m_uniform_initialized = std::move(shaderProgram.m_uniform_initialized);
 
 		shaderProgram.m_id = 0;
 		shaderProgram.m_isCompiled = false;
@@ -112,6 +543,11 @@ namespace SimpleEngine
 	{
 		m_id = shaderProgram.m_id;
 		m_isCompiled = shaderProgram.m_isCompiled;
+		m_uniforms = std::move(shaderProgram.m_uniforms);
+		m_uniform_blocks = std::move(shaderProgram.m_uniform_blocks);
+		m_storage_blocks = std::move(shaderProgram.m_storage_blocks);
+		m_uniform_values = std::move(shaderProgram.m_uniform_values);
+		m_uniform_initialized = std::move(shaderProgram.m_uniform_initialized);
 
 		shaderProgram.m_id = 0;
 		shaderProgram.m_isCompiled = false;
@@ -1,12 +1,50 @@
 #pragma once
 
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat2x2.hpp>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace SimpleEngine {
 
     class ShaderProgram
     {
     public:
+        // index in the uniform table built at link time. Look it up once and keep it
+        using UniformHandle = int;
+        static constexpr UniformHandle invalid_uniform = -1;
+
+        struct UniformInfo
+        {
+            std::string name; // without "[0]" for arrays
+            int location;
+            unsigned int type; // OpenGL type
+            int array_size;
+            size_t cache_offset; // where the last uploaded value lives in m_uniform_values
+            size_t cache_size;
+        };
+
+        struct UniformBlockInfo
+        {
+            std::string name;
+            unsigned int index;
+            unsigned int binding;
+            size_t data_size; // in bytes
+        };
+
+        struct StorageBlockInfo
+        {
+            std::string name;
+            unsigned int index;
+            unsigned int binding; // from layout(binding = N)
+        };
+
         ShaderProgram(const char* vertex_shader_src, const char* fragment_shader_src);
         ShaderProgram(ShaderProgram&&);
         ShaderProgram& operator=(ShaderProgram&&);
@@ -19,11 +57,78 @@ namespace SimpleEngine {
         void bind() const;
         static void unbind();
         bool isCompiled() const { return m_isCompiled; }
-        void setMatrix4(const char* name, const glm::mat4& matrix) const;
+        unsigned int get_id() const { return m_id; }
+
+        UniformHandle get_uniform_handle(const char* name) const;
+        const std::vector<UniformInfo>& get_uniforms() const { return m_uniforms; }
+        const std::vector<UniformBlockInfo>& get_uniform_blocks() const { return m_uniform_blocks; }
+        const UniformBlockInfo* get_uniform_block(const char* name) const;
+        void set_uniform_block_binding(const char* name, const unsigned int binding);
+        const std::vector<StorageBlockInfo>& get_storage_blocks() const { return m_storage_blocks; }
+        const StorageBlockInfo* get_storage_block(const char* name) const;
+
+        // setters skip the upload when the value is the same as the last one. They don't require bind().
+        // The type has to match the one reflected for the uniform, otherwise nothing is uploaded.
+        // setInt also sets bools, samplers and images
+        void setInt(const UniformHandle handle, const int value) const;
+        void setUInt(const UniformHandle handle, const unsigned int value) const;
+        void setBool(const UniformHandle handle, const bool value) const;
+        void setFloat(const UniformHandle handle, const float value) const;
+        void setIVec2(const UniformHandle handle, const glm::ivec2& value) const;
+        void setIVec3(const UniformHandle handle, const glm::ivec3& value) const;
+        void setIVec4(const UniformHandle handle, const glm::ivec4& value) const;
+        void setUVec2(const UniformHandle handle, const glm::uvec2& value) const;
+        void setUVec3(const UniformHandle handle, const glm::uvec3& value) const;
+        void setUVec4(const UniformHandle handle, const glm::uvec4& value) const;
+        void setVec2(const UniformHandle handle, const glm::vec2& value) const;
+        void setVec3(const UniformHandle handle, const glm::vec3& value) const;
+        void setVec4(const UniformHandle handle, const glm::vec4& value) const;
+        void setMatrix2(const UniformHandle handle, const glm::mat2& matrix) const;
+        void setMatrix3(const UniformHandle handle, const glm::mat3& matrix) const;
+        void setMatrix4(const UniformHandle handle, const glm::mat4& matrix) const;
+
+        // first count elements of an array uniform
+        void setIntArray(const UniformHandle handle, const int* values, const size_t count) const;
+        void setUIntArray(const UniformHandle handle, const unsigned int* values, const size_t count) const;
+        void setFloatArray(const UniformHandle handle, const float* values, const size_t count) const;
+        void setVec2Array(const UniformHandle handle, const glm::vec2* values, const size_t count) const;
+        void setVec3Array(const UniformHandle handle, const glm::vec3* values, const size_t count) const;
+        void setVec4Array(const UniformHandle handle, const glm::vec4* values, const size_t count) const;
+        void setMatrix3Array(const UniformHandle handle, const glm::mat3* matrices, const size_t count) const;
+        void setMatrix4Array(const UniformHandle handle, const glm::mat4* matrices, const size_t count) const;
+
+        // by name: linear search in the uniform table, no driver calls
+        void setInt(const char* name, const int value) const { setInt(get_uniform_handle(name), value); }
+        void setUInt(const char* name, const unsigned int value) const { setUInt(get_uniform_handle(name), value); }
+        void setBool(const char* name, const bool value) const { setBool(get_uniform_handle(name), value); }
+        void setFloat(const char* name, const float value) const { setFloat(get_uniform_handle(name), value); }
+        void setIVec2(const char* name, const glm::ivec2& value) const { setIVec2(get_uniform_handle(name), value); }
+        void setIVec3(const char* name, const glm::ivec3& value) const { setIVec3(get_uniform_handle(name), value); }
+        void setIVec4(const char* name, const glm::ivec4& value) const { setIVec4(get_uniform_handle(name), value); }
+        void setUVec2(const char* name, const glm::uvec2& value) const { setUVec2(get_uniform_handle(name), value); }
+        void setUVec3(const char* name, const glm::uvec3& value) const { setUVec3(get_uniform_handle(name), value); }
+        void setUVec4(const char* name, const glm::uvec4& value) const { setUVec4(get_uniform_handle(name), value); }
+        void setVec2(const char* name, const glm::vec2& value) const { setVec2(get_uniform_handle(name), value); }
+        void setVec3(const char* name, const glm::vec3& value) const { setVec3(get_uniform_handle(name), value); }
+        void setVec4(const char* name, const glm::vec4& value) const { setVec4(get_uniform_handle(name), value); }
+        void setMatrix2(const char* name, const glm::mat2& matrix) const { setMatrix2(get_uniform_handle(name), matrix); }
+        void setMatrix3(const char* name, const glm::mat3& matrix) const { setMatrix3(get_uniform_handle(name), matrix); }
+        void setMatrix4(const char* name, const glm::mat4& matrix) const { setMatrix4(get_uniform_handle(name), matrix); }
 
     private:
+        void reflect();
+        // returns true if the value differs from the cached one (and stores it).
+        // type - OpenGL type of one element the setter passes, checked against the reflected one
+        bool update_cached_value(const UniformHandle handle, const unsigned int type, const void* data, const size_t size) const;
+
         bool m_isCompiled = false;
         unsigned int m_id = 0;
+
+        std::vector<UniformInfo> m_uniforms;
+        std::vector<UniformBlockInfo> m_uniform_blocks;
+        std::vector<StorageBlockInfo> m_storage_blocks;
+        mutable std::vector<uint8_t> m_uniform_values; // last uploaded values of all uniforms
+        mutable std::vector<bool> m_uniform_initialized;
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,88 @@
+#include "StagingBuffer.hpp"
+#include "StateCache.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+	StagingBuffer::StagingBuffer(const size_t size)
+		: m_size(size)
+	{
+		constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glCreateBuffers(1, &m_id);
+		glNamedBufferStorage(m_id, size, nullptr, flags);
+		m_mapped_data = static_cast<uint8_t*>(glMapNamedBufferRange(m_id, 0, size, flags));
+		if (!m_mapped_data)
+		{
+			LOG_CRITICAL("StagingBuffer: can't map buffer storage of {0} bytes", size);
+			m_size = 0;
+		}
+	}
+
+
+	StagingBuffer::~StagingBuffer()
+	{
+		for (const Fence& fence : m_fences)
+		{
+			glDeleteSync(static_cast<GLsync>(fence.sync));
+		}
+		StateCache::on_buffer_deleted(m_id);
+		glDeleteBuffers(1, &m_id);
+	}
+
+
+	StagingBuffer::Allocation StagingBuffer::try_allocate(const size_t size, const size_t alignment)
+	{
+		if (!m_mapped_data || size == 0 || size > m_size)
+		{
+			return {};
+		}
+		retire_fences();
+
+		// an allocation never wraps, the end of the buffer is skipped instead
+		size_t offset = static_cast<size_t>(m_head % m_size);
+		offset = (offset + alignment - 1) / alignment * alignment;
+		if (offset + size > m_size)
+		{
+			offset = 0;
+		}
+		const uint64_t start = offset >= m_head % m_size ? m_head - m_head % m_size + offset : m_head - m_head % m_size + m_size;
+		if (start + size - m_tail > m_size)
+		{
+			return {};
+		}
+
+		m_head = start + size;
+		return { m_mapped_data + offset, offset };
+	}
+
+
+	void StagingBuffer::fence()
+	{
+		if (m_fences.empty() ? m_head == m_tail : m_fences.back().head == m_head)
+		{
+			return;
+		}
+		m_fences.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_head });
+	}
+
+
+	void StagingBuffer::retire_fences()
+	{
+		// fences signal in order, the first one still pending stops the walk
+		while (!m_fences.empty())
+		{
+			const GLenum result = glClientWaitSync(static_cast<GLsync>(m_fences.front().sync), 0, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+			{
+				break;
+			}
+			glDeleteSync(static_cast<GLsync>(m_fences.front().sync));
+			m_tail = m_fences.front().head;
+			m_fences.pop_front();
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace SimpleEngine {
+
+    // Persistently mapped upload memory used as a ring, for data that reaches the GPU through copies
+    // (textures from a pixel unpack buffer). Unlike StreamRing it isn't tied to frames: space is taken
+    // while there is any, fence() marks everything written so far, and the space comes back once the GPU
+    // passed that fence. Workers can fill allocations, the GL calls stay on the GL thread
+    class StagingBuffer {
+    public:
+        static constexpr size_t invalid_offset = SIZE_MAX;
+
+        struct Allocation
+        {
+            void* data = nullptr; // write here directly, memory is coherent
+            size_t offset = invalid_offset; // in bytes from the beginning of the buffer
+        };
+
+        explicit StagingBuffer(const size_t size);
+        ~StagingBuffer();
+
+        StagingBuffer(const StagingBuffer&) = delete;
+        StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+        // null data when the GPU still reads the space, try again next frame
+        Allocation try_allocate(const size_t size, const size_t alignment = 4);
+        // after the copies that read the allocations so far are issued
+        void fence();
+
+        unsigned int get_id() const { return m_id; }
+        size_t get_size() const { return m_size; }
+        // bytes written and not yet released by the GPU
+        size_t get_used_size() const { return m_head - m_tail; }
+
+    private:
+        struct Fence
+        {
+            void* sync;
+            uint64_t head;
+        };
+
+        void retire_fences();
+
+        unsigned int m_id = 0;
+        uint8_t* m_mapped_data = nullptr;
+        size_t m_size = 0;
+        // positions grow forever, offsets are position % size
+        uint64_t m_head = 0;
+        uint64_t m_tail = 0;
+        std::deque<Fence> m_fences;
+    };
+
+}
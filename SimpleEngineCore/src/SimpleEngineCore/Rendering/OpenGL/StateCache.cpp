@@ -0,0 +1,451 @@
+#include "StateCache.hpp"
+
+#include "SimpleEngineCore/Profiler.hpp"
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SimpleEngine {
+
+	// nothing is known about the real value, the next call is issued
+	static constexpr uint32_t unknown = UINT32_MAX;
+
+	static constexpr GLenum tracked_buffer_targets[] =
+	{
+		GL_ARRAY_BUFFER,
+		GL_ELEMENT_ARRAY_BUFFER,
+		GL_COPY_READ_BUFFER,
+		GL_COPY_WRITE_BUFFER,
+		GL_DRAW_INDIRECT_BUFFER,
+		GL_SHADER_STORAGE_BUFFER,
+		GL_UNIFORM_BUFFER,
+		GL_PIXEL_UNPACK_BUFFER
+	};
+	static constexpr size_t tracked_buffer_targets_count = sizeof(tracked_buffer_targets) / sizeof(tracked_buffer_targets[0]);
+	static constexpr size_t element_array_buffer_slot = 1;
+
+	// indexed binding points below this are tracked for these targets
+	static constexpr GLenum tracked_indexed_targets[] = { GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER };
+	static constexpr size_t tracked_indexed_targets_count = sizeof(tracked_indexed_targets) / sizeof(tracked_indexed_targets[0]);
+	static constexpr size_t tracked_binding_points_count = 8;
+	// texture units below this are tracked
+	static constexpr size_t tracked_texture_units_count = 16;
+
+	struct State
+	{
+		uint32_t program = unknown;
+		uint32_t vertex_array = unknown;
+		uint32_t buffers[tracked_buffer_targets_count];
+		uint32_t indexed_buffers[tracked_indexed_targets_count][tracked_binding_points_count];
+		uint32_t textures[tracked_texture_units_count];
+		uint32_t samplers[tracked_texture_units_count];
+		GLint viewport[4];
+		GLfloat clear_color[4];
+		bool clear_color_known = false;
+		bool viewport_known = false;
+		uint32_t depth_test = unknown; // 0, 1
+		uint32_t blend = unknown;
+		uint32_t blend_source = unknown;
+		uint32_t blend_destination = unknown;
+
+		State()
+		{
+			for (uint32_t& buffer : buffers)
+			{
+				buffer = unknown;
+			}
+			for (auto& target_buffers : indexed_buffers)
+			{
+				for (uint32_t& buffer : target_buffers)
+				{
+					buffer = unknown;
+				}
+			}
+			for (size_t unit = 0; unit < tracked_texture_units_count; ++unit)
+			{
+				textures[unit] = unknown;
+				samplers[unit] = unknown;
+			}
+		}
+	};
+
+	static State s_state;
+
+
+	struct VertexBufferAttachment
+	{
+		uint32_t buffer = unknown;
+		size_t offset = 0;
+		size_t stride = 0;
+	};
+
+	struct VertexArrayAttachments
+	{
+		uint32_t vertex_array = 0;
+		uint32_t element_buffer = unknown;
+		std::vector<VertexBufferAttachment> vertex_buffers;
+	};
+
+	// few vertex arrays (one per vertex format), a linear search is fine
+	static std::vector<VertexArrayAttachments> s_vertex_arrays;
+
+
+	// true when the call has to be issued, the shadow value is updated then
+	static bool update(uint32_t& current, const uint32_t value)
+	{
+		if (current == value)
+		{
+			Profiler::add_redundant_state_change();
+			return false;
+		}
+		current = value;
+		Profiler::add_state_change();
+		return true;
+	}
+
+
+	static size_t get_buffer_slot(const GLenum target)
+	{
+		for (size_t slot = 0; slot < tracked_buffer_targets_count; ++slot)
+		{
+			if (tracked_buffer_targets[slot] == target)
+			{
+				return slot;
+			}
+		}
+		return tracked_buffer_targets_count;
+	}
+
+
+	static VertexArrayAttachments& get_attachments(const uint32_t vertex_array_id)
+	{
+		for (VertexArrayAttachments& attachments : s_vertex_arrays)
+		{
+			if (attachments.vertex_array == vertex_array_id)
+			{
+				return attachments;
+			}
+		}
+		s_vertex_arrays.push_back({ vertex_array_id });
+		return s_vertex_arrays.back();
+	}
+
+
+	void StateCache::use_program(const unsigned int program_id)
+	{
+		if (update(s_state.program, program_id))
+		{
+			glUseProgram(program_id);
+		}
+	}
+
+
+	void StateCache::bind_vertex_array(const unsigned int vertex_array_id)
+	{
+		if (update(s_state.vertex_array, vertex_array_id))
+		{
+			glBindVertexArray(vertex_array_id);
+			s_state.buffers[element_array_buffer_slot] = unknown;
+		}
+	}
+
+
+	void StateCache::bind_buffer(const unsigned int target, const unsigned int buffer_id)
+	{
+		const size_t slot = get_buffer_slot(target);
+		if (slot == tracked_buffer_targets_count)
+		{
+			Profiler::add_state_change();
+			glBindBuffer(target, buffer_id);
+		}
+		else if (update(s_state.buffers[slot], buffer_id))
+		{
+			glBindBuffer(target, buffer_id);
+			if (slot == element_array_buffer_slot && s_state.vertex_array != unknown && s_state.vertex_array != 0)
+			{
+				get_attachments(s_state.vertex_array).element_buffer = buffer_id;
+			}
+		}
+	}
+
+
+	void StateCache::bind_buffer_base(const unsigned int target, const unsigned int index, const unsigned int buffer_id)
+	{
+		size_t target_slot = 0;
+		while (target_slot < tracked_indexed_targets_count && tracked_indexed_targets[target_slot] != target)
+		{
+			++target_slot;
+		}
+
+		if (target_slot == tracked_indexed_targets_count || index >= tracked_binding_points_count)
+		{
+			Profiler::add_state_change();
+			glBindBufferBase(target, index, buffer_id);
+		}
+		else if (update(s_state.indexed_buffers[target_slot][index], buffer_id))
+		{
+			glBindBufferBase(target, index, buffer_id);
+		}
+		else
+		{
+			return;
+		}
+
+		const size_t slot = get_buffer_slot(target);
+		if (slot != tracked_buffer_targets_count)
+		{
+			s_state.buffers[slot] = buffer_id;
+		}
+	}
+
+
+	void StateCache::bind_texture_unit(const unsigned int unit, const unsigned int texture_id)
+	{
+		if (unit >= tracked_texture_units_count)
+		{
+			Profiler::add_state_change();
+			glBindTextureUnit(unit, texture_id);
+		}
+		else if (update(s_state.textures[unit], texture_id))
+		{
+			glBindTextureUnit(unit, texture_id);
+		}
+	}
+
+
+	void StateCache::bind_sampler(const unsigned int unit, const unsigned int sampler_id)
+	{
+		if (unit >= tracked_texture_units_count)
+		{
+			Profiler::add_state_change();
+			glBindSampler(unit, sampler_id);
+		}
+		else if (update(s_state.samplers[unit], sampler_id))
+		{
+			glBindSampler(unit, sampler_id);
+		}
+	}
+
+
+	void StateCache::set_viewport(const int x, const int y, const int width, const int height)
+	{
+		const GLint viewport[4] = { x, y, width, height };
+		if (s_state.viewport_known && viewport[0] == s_state.viewport[0] && viewport[1] == s_state.viewport[1]
+			&& viewport[2] == s_state.viewport[2] && viewport[3] == s_state.viewport[3])
+		{
+			Profiler::add_redundant_state_change();
+			return;
+		}
+		for (size_t i = 0; i < 4; ++i)
+		{
+			s_state.viewport[i] = viewport[i];
+		}
+		s_state.viewport_known = true;
+		Profiler::add_state_change();
+		glViewport(x, y, width, height);
+	}
+
+
+	void StateCache::set_clear_color(const float r, const float g, const float b, const float a)
+	{
+		if (s_state.clear_color_known && r == s_state.clear_color[0] && g == s_state.clear_color[1]
+			&& b == s_state.clear_color[2] && a == s_state.clear_color[3])
+		{
+			Profiler::add_redundant_state_change();
+			return;
+		}
+		s_state.clear_color[0] = r;
+		s_state.clear_color[1] = g;
+		s_state.clear_color[2] = b;
+		s_state.clear_color[3] = a;
+		s_state.clear_color_known = true;
+		Profiler::add_state_change();
+		glClearColor(r, g, b, a);
+	}
+
+
+	void StateCache::set_depth_test(const bool enabled)
+	{
+		if (update(s_state.depth_test, enabled ? 1 : 0))
+		{
+			enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+		}
+	}
+
+
+	void StateCache::set_blend(const bool enabled)
+	{
+		if (update(s_state.blend, enabled ? 1 : 0))
+		{
+			enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		}
+	}
+
+
+	void StateCache::set_blend_func(const unsigned int source_factor, const unsigned int destination_factor)
+	{
+		if (s_state.blend_source == source_factor && s_state.blend_destination == destination_factor)
+		{
+			Profiler::add_redundant_state_change();
+			return;
+		}
+		s_state.blend_source = source_factor;
+		s_state.blend_destination = destination_factor;
+		Profiler::add_state_change();
+		glBlendFunc(source_factor, destination_factor);
+	}
+
+
+	void StateCache::attach_vertex_buffer(const unsigned int vertex_array_id, const unsigned int binding_index, const unsigned int buffer_id,
+		const size_t offset, const size_t stride)
+	{
+		VertexArrayAttachments& attachments = get_attachments(vertex_array_id);
+		if (binding_index >= attachments.vertex_buffers.size())
+		{
+			attachments.vertex_buffers.resize(binding_index + 1);
+		}
+
+		VertexBufferAttachment& attachment = attachments.vertex_buffers[binding_index];
+		if (attachment.buffer == buffer_id && attachment.offset == offset && attachment.stride == stride)
+		{
+			Profiler::add_redundant_state_change();
+			return;
+		}
+		attachment = { buffer_id, offset, stride };
+		Profiler::add_state_change();
+		glVertexArrayVertexBuffer(vertex_array_id, binding_index, buffer_id, static_cast<GLintptr>(offset), static_cast<GLsizei>(stride));
+	}
+
+
+	void StateCache::attach_element_buffer(const unsigned int vertex_array_id, const unsigned int buffer_id)
+	{
+		if (update(get_attachments(vertex_array_id).element_buffer, buffer_id))
+		{
+			glVertexArrayElementBuffer(vertex_array_id, buffer_id);
+			if (s_state.vertex_array == vertex_array_id)
+			{
+				s_state.buffers[element_array_buffer_slot] = buffer_id;
+			}
+		}
+	}
+
+
+	void StateCache::on_program_deleted(const unsigned int program_id)
+	{
+		// a current program stays in use until another one is, so only the id has to be forgotten
+		if (program_id != 0 && s_state.program == program_id)
+		{
+			s_state.program = unknown;
+		}
+	}
+
+
+	void StateCache::on_vertex_array_deleted(const unsigned int vertex_array_id)
+	{
+		if (vertex_array_id == 0)
+		{
+			return;
+		}
+		if (s_state.vertex_array == vertex_array_id)
+		{
+			s_state.vertex_array = 0;
+			s_state.buffers[element_array_buffer_slot] = unknown;
+		}
+
+		for (size_t i = 0; i < s_vertex_arrays.size(); ++i)
+		{
+			if (s_vertex_arrays[i].vertex_array == vertex_array_id)
+			{
+				s_vertex_arrays[i] = std::move(s_vertex_arrays.back());
+				s_vertex_arrays.pop_back();
+				break;
+			}
+		}
+	}
+
+
+	void StateCache::on_buffer_deleted(const unsigned int buffer_id)
+	{
+		if (buffer_id == 0)
+		{
+			return;
+		}
+		for (uint32_t& buffer : s_state.buffers)
+		{
+			if (buffer == buffer_id)
+			{
+				buffer = 0;
+			}
+		}
+		for (auto& target_buffers : s_state.indexed_buffers)
+		{
+			for (uint32_t& buffer : target_buffers)
+			{
+				if (buffer == buffer_id)
+				{
+					buffer = 0;
+				}
+			}
+		}
+
+		// GL detaches the buffer only from the bound vertex array, the others keep the deleted object
+		// until something else is attached. The id can be reused, so the attachment isn't known anymore
+		for (VertexArrayAttachments& attachments : s_vertex_arrays)
+		{
+			if (attachments.element_buffer == buffer_id)
+			{
+				attachments.element_buffer = unknown;
+			}
+			for (VertexBufferAttachment& attachment : attachments.vertex_buffers)
+			{
+				if (attachment.buffer == buffer_id)
+				{
+					attachment.buffer = unknown;
+				}
+			}
+		}
+	}
+
+
+	void StateCache::on_texture_deleted(const unsigned int texture_id)
+	{
+		if (texture_id == 0)
+		{
+			return;
+		}
+		// GL unbinds a deleted texture from every unit of the current context
+		for (uint32_t& texture : s_state.textures)
+		{
+			if (texture == texture_id)
+			{
+				texture = 0;
+			}
+		}
+	}
+
+
+	void StateCache::on_sampler_deleted(const unsigned int sampler_id)
+	{
+		if (sampler_id == 0)
+		{
+			return;
+		}
+		for (uint32_t& sampler : s_state.samplers)
+		{
+			if (sampler == sampler_id)
+			{
+				sampler = 0;
+			}
+		}
+	}
+
+
+	void StateCache::invalidate()
+	{
+		s_state = State();
+	}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    // shadow copy of the GL state the engine sets. Calls that wouldn't change anything are skipped,
+    // issued and skipped calls are counted in Profiler stats. GL thread only
+    class StateCache {
+    public:
+        static void use_program(const unsigned int program_id);
+        static void bind_vertex_array(const unsigned int vertex_array_id);
+        // GL_ELEMENT_ARRAY_BUFFER is part of the vertex array state, it is forgotten when the vertex array changes
+        static void bind_buffer(const unsigned int target, const unsigned int buffer_id);
+        // indexed binding point of GL_SHADER_STORAGE_BUFFER or GL_UNIFORM_BUFFER, the generic binding changes too
+        static void bind_buffer_base(const unsigned int target, const unsigned int index, const unsigned int buffer_id);
+        // glBindTextureUnit / glBindSampler, any texture target
+        static void bind_texture_unit(const unsigned int unit, const unsigned int texture_id);
+        static void bind_sampler(const unsigned int unit, const unsigned int sampler_id);
+        static void set_viewport(const int x, const int y, const int width, const int height);
+        static void set_clear_color(const float r, const float g, const float b, const float a);
+        static void set_depth_test(const bool enabled);
+        static void set_blend(const bool enabled);
+        static void set_blend_func(const unsigned int source_factor, const unsigned int destination_factor);
+
+        // buffers attached to a vertex array object (DSA, the vertex array doesn't have to be bound).
+        // These are kept per vertex array, so vertex arrays shared by many meshes only get the buffers that changed
+        static void attach_vertex_buffer(const unsigned int vertex_array_id, const unsigned int binding_index, const unsigned int buffer_id,
+            const size_t offset, const size_t stride);
+        static void attach_element_buffer(const unsigned int vertex_array_id, const unsigned int buffer_id);
+
+        // call before deleting: GL unbinds deleted objects and the id can come back with a new object
+        static void on_program_deleted(const unsigned int program_id);
+        static void on_vertex_array_deleted(const unsigned int vertex_array_id);
+        static void on_buffer_deleted(const unsigned int buffer_id);
+        static void on_texture_deleted(const unsigned int texture_id);
+        static void on_sampler_deleted(const unsigned int sampler_id);
+
+        // after code that changes GL state past the cache (ImGui backend, other libraries),
+        // the next call of every kind goes to GL. Attachments of our vertex arrays are object state and stay
+        static void invalidate();
+    };
+
+}
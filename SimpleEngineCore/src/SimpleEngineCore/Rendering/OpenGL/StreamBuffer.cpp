@@ -0,0 +1,21 @@
+#include "StreamBuffer.hpp"
+#include "StateCache.hpp"
+
+#include <glad/glad.h>
+
+namespace SimpleEngine {
+
+	StreamBuffer::StreamBuffer(const size_t region_size)
+	{
+		glCreateBuffers(1, &m_id);
+		m_stream_ring.init(m_id, region_size, nullptr, 0);
+	}
+
+
+	StreamBuffer::~StreamBuffer()
+	{
+		// commands already submitted keep the storage alive until the GPU is done with them
+		StateCache::on_buffer_deleted(m_id);
+		glDeleteBuffers(1, &m_id);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "StreamRing.hpp"
+
+#include <cstddef>
+
+namespace SimpleEngine {
+
+    // buffer without a vertex layout (shader storage, indirect commands) written every frame, see StreamRing
+    class StreamBuffer {
+    public:
+        // region_size - bytes that can be written in one frame
+        explicit StreamBuffer(const size_t region_size);
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        StreamRing::Allocation allocate(const size_t size, const size_t alignment = 4) { return m_stream_ring.allocate(size, alignment); }
+        StreamRing::Allocation try_allocate(const size_t size, const size_t alignment = 4) { return m_stream_ring.try_allocate(size, alignment); }
+
+        unsigned int get_id() const { return m_id; }
+        size_t get_region_size() const { return m_stream_ring.get_region_size(); }
+
+    private:
+        unsigned int m_id = 0;
+        StreamRing m_stream_ring;
+    };
+
+}
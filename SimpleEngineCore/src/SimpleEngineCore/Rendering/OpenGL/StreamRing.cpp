@@ -0,0 +1,84 @@
+#include "StreamRing.hpp"
+
+#include "Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+namespace SimpleEngine {
+
+	bool StreamRing::init(const unsigned int buffer_id, const size_t region_size, const void* initial_data, const size_t initial_size)
+	{
+		constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		m_region_size = region_size > 0 ? region_size : 1; // empty storage is an error
+		const size_t storage_size = get_storage_size();
+		glNamedBufferStorage(buffer_id, storage_size, nullptr, flags); // immutable, can't be orphaned or resized
+		m_mapped_data = static_cast<uint8_t*>(glMapNamedBufferRange(buffer_id, 0, storage_size, flags));
+		if (!m_mapped_data)
+		{
+			LOG_CRITICAL("StreamRing: can't map buffer storage of {0} bytes", storage_size);
+			m_region_size = 0;
+			return false;
+		}
+
+		// initial data is visible at offset 0 until the first write
+		if (initial_data)
+		{
+			std::memcpy(m_mapped_data, initial_data, initial_size < region_size ? initial_size : region_size);
+		}
+		return true;
+	}
+
+
+	size_t StreamRing::get_storage_size() const
+	{
+		return m_region_size * Renderer_OpenGL::frames_in_flight;
+	}
+
+
+	StreamRing::Allocation StreamRing::allocate(const size_t size, const size_t alignment)
+	{
+		const Allocation allocation = try_allocate(size, alignment);
+		if (!allocation.data)
+		{
+			LOG_ERROR("StreamRing: out of space in frame region ({0} of {1} bytes used, {2} requested)", m_cursor, m_region_size, size);
+		}
+		return allocation;
+	}
+
+
+	StreamRing::Allocation StreamRing::try_allocate(const size_t size, const size_t alignment)
+	{
+		const uint64_t frame_number = Renderer_OpenGL::get_frame_number();
+		if (frame_number != m_frame_number)
+		{
+			m_frame_number = frame_number;
+			m_region_offset = Renderer_OpenGL::get_frame_index() * m_region_size;
+			m_cursor = 0;
+		}
+
+		const size_t aligned_cursor = (m_cursor + alignment - 1) / alignment * alignment;
+		if (!m_mapped_data || aligned_cursor + size > m_region_size)
+		{
+			return {};
+		}
+
+		m_cursor = aligned_cursor + size;
+		const size_t offset = m_region_offset + aligned_cursor;
+		return { m_mapped_data + offset, offset };
+	}
+
+
+	size_t StreamRing::write(const void* data, const size_t size, const size_t alignment)
+	{
+		const Allocation allocation = allocate(size, alignment);
+		if (allocation.data)
+		{
+			std::memcpy(allocation.data, data, size);
+		}
+		return allocation.offset;
+	}
+}
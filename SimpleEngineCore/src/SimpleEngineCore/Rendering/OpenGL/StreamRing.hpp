@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    // Persistently mapped storage split into Renderer_OpenGL::frames_in_flight regions.
+    // Every frame writes go to the next region; Renderer_OpenGL::end_frame() waits on the fence
+    // of that region, so the CPU never overwrites data the GPU still reads.
+    class StreamRing {
+    public:
+        static constexpr size_t invalid_offset = SIZE_MAX;
+
+        struct Allocation
+        {
+            void* data = nullptr; // write here directly, memory is coherent
+            size_t offset = invalid_offset; // in bytes from the beginning of the buffer
+        };
+
+        // creates immutable storage of region_size * frames_in_flight bytes for the buffer, nothing is bound
+        bool init(const unsigned int buffer_id, const size_t region_size, const void* initial_data, const size_t initial_size);
+        bool is_initialized() const { return m_mapped_data != nullptr; }
+
+        Allocation allocate(const size_t size, const size_t alignment = 4);
+        // same, but a full region isn't an error: for callers that replace the buffer with a bigger one then
+        Allocation try_allocate(const size_t size, const size_t alignment = 4);
+        // copies data into the current frame region and returns its offset in the buffer
+        size_t write(const void* data, const size_t size, const size_t alignment = 4);
+
+        size_t get_region_size() const { return m_region_size; }
+        size_t get_storage_size() const;
+
+    private:
+        uint8_t* m_mapped_data = nullptr;
+        size_t m_region_size = 0;
+        size_t m_region_offset = 0; // offset of the current frame region
+        size_t m_cursor = 0; // write position inside the current frame region
+        uint64_t m_frame_number = UINT64_MAX; // frame the cursor belongs to
+    };
+
+}
@@ -0,0 +1,280 @@
+#include "Texture.hpp"
+#include "StateCache.hpp"
+
+#include "SimpleEngineCore/Log.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+// EXT_texture_compression_s3tc and EXT_texture_sRGB, not in the core profile headers
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace SimpleEngine {
+
+	static GLenum format_to_GLenum(const ETextureFormat format)
+	{
+		switch (format)
+		{
+		case ETextureFormat::RGBA8:       return GL_RGBA8;
+		case ETextureFormat::RGBA8_SRGB:  return GL_SRGB8_ALPHA8;
+		case ETextureFormat::BC1:         return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case ETextureFormat::BC1_SRGB:    return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		case ETextureFormat::BC2:         return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		case ETextureFormat::BC2_SRGB:    return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+		case ETextureFormat::BC3:         return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case ETextureFormat::BC3_SRGB:    return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case ETextureFormat::BC4:         return GL_COMPRESSED_RED_RGTC1;
+		case ETextureFormat::BC4_SNORM:   return GL_COMPRESSED_SIGNED_RED_RGTC1;
+		case ETextureFormat::BC5:         return GL_COMPRESSED_RG_RGTC2;
+		case ETextureFormat::BC5_SNORM:   return GL_COMPRESSED_SIGNED_RG_RGTC2;
+		case ETextureFormat::BC6H_UFloat: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+		case ETextureFormat::BC6H_SFloat: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+		case ETextureFormat::BC7:         return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case ETextureFormat::BC7_SRGB:    return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		}
+		return GL_RGBA8;
+	}
+
+
+	// bytes per 4x4 block, per pixel for uncompressed formats
+	static size_t get_block_size(const ETextureFormat format)
+	{
+		switch (format)
+		{
+		case ETextureFormat::RGBA8:
+		case ETextureFormat::RGBA8_SRGB:
+			return 4;
+		case ETextureFormat::BC1:
+		case ETextureFormat::BC1_SRGB:
+		case ETextureFormat::BC4:
+		case ETextureFormat::BC4_SNORM:
+			return 8;
+		default:
+			return 16;
+		}
+	}
+
+
+	static bool has_extension(const char* name)
+	{
+		GLint extensions_count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensions_count);
+		for (GLint i = 0; i < extensions_count; ++i)
+		{
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+			if (extension && std::strcmp(extension, name) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	bool Texture::is_format_supported(const ETextureFormat format)
+	{
+		static const bool has_s3tc = has_extension("GL_EXT_texture_compression_s3tc");
+		static const bool has_s3tc_srgb = has_s3tc && (has_extension("GL_EXT_texture_sRGB") || has_extension("GL_EXT_texture_compression_s3tc_srgb"));
+		switch (format)
+		{
+		case ETextureFormat::BC1:
+		case ETextureFormat::BC2:
+		case ETextureFormat::BC3:
+			return has_s3tc;
+		case ETextureFormat::BC1_SRGB:
+		case ETextureFormat::BC2_SRGB:
+		case ETextureFormat::BC3_SRGB:
+			return has_s3tc_srgb;
+		default:
+			return true;
+		}
+	}
+
+
+	static uint32_t get_integer(const GLenum name)
+	{
+		GLint value = 0;
+		glGetIntegerv(name, &value);
+		return static_cast<uint32_t>(std::max(value, 0));
+	}
+
+
+	uint32_t Texture::get_max_size()
+	{
+		static const uint32_t max_size = get_integer(GL_MAX_TEXTURE_SIZE);
+		return max_size;
+	}
+
+
+	uint32_t Texture::get_max_layers_count()
+	{
+		static const uint32_t max_layers_count = get_integer(GL_MAX_ARRAY_TEXTURE_LAYERS);
+		return max_layers_count;
+	}
+
+
+	size_t Texture::get_row_size(const ETextureFormat format, const uint32_t width)
+	{
+		const size_t units = is_compressed(format) ? (std::max<uint32_t>(width, 1) + 3) / 4 : std::max<uint32_t>(width, 1);
+		return units * get_block_size(format);
+	}
+
+
+	uint32_t Texture::get_rows_count(const ETextureFormat format, const uint32_t height)
+	{
+		return is_compressed(format) ? (std::max<uint32_t>(height, 1) + 3) / 4 : std::max<uint32_t>(height, 1);
+	}
+
+
+	size_t Texture::get_image_size(const ETextureFormat format, const uint32_t width, const uint32_t height)
+	{
+		return get_row_size(format, width) * get_rows_count(format, height);
+	}
+
+
+	Texture::Texture(const unsigned int target, const ETextureFormat format, const uint32_t width, const uint32_t height,
+		const uint32_t layers_count, const uint32_t levels_count)
+		: m_target(target)
+		, m_format(format)
+		, m_width(std::max<uint32_t>(width, 1))
+		, m_height(std::max<uint32_t>(height, 1))
+		, m_layers_count(std::max<uint32_t>(layers_count, 1))
+		, m_levels_count(std::max<uint32_t>(levels_count, 1))
+	{
+		glCreateTextures(target, 1, &m_id);
+		if (target == GL_TEXTURE_2D_ARRAY)
+		{
+			glTextureStorage3D(m_id, m_levels_count, format_to_GLenum(format), m_width, m_height, m_layers_count);
+		}
+		else
+		{
+			glTextureStorage2D(m_id, m_levels_count, format_to_GLenum(format), m_width, m_height);
+		}
+		glTextureParameteri(m_id, GL_TEXTURE_MAX_LEVEL, m_levels_count - 1);
+
+		SamplerDesc sampler_desc;
+		if (m_levels_count == 1)
+		{
+			sampler_desc.filter = ETextureFilter::Linear; // mip filtering would read levels that don't exist
+		}
+		set_sampler(sampler_desc);
+	}
+
+
+	Texture::~Texture()
+	{
+		StateCache::on_texture_deleted(m_id);
+		glDeleteTextures(1, &m_id);
+	}
+
+
+	void Texture::bind(const unsigned int unit) const
+	{
+		StateCache::bind_texture_unit(unit, m_id);
+		StateCache::bind_sampler(unit, m_sampler_id);
+	}
+
+
+	void Texture::set_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count, const void* data)
+	{
+		// a bound unpack buffer would turn the pointer into an offset
+		StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		upload_rows(level, layer, first_row, rows_count, data);
+	}
+
+
+	void Texture::set_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count,
+		const unsigned int unpack_buffer_id, const size_t offset)
+	{
+		StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, unpack_buffer_id);
+		upload_rows(level, layer, first_row, rows_count, reinterpret_cast<const void*>(offset));
+	}
+
+
+	uint32_t Texture::get_width(const uint32_t level) const
+	{
+		return std::max<uint32_t>(m_width >> level, 1);
+	}
+
+
+	uint32_t Texture::get_height(const uint32_t level) const
+	{
+		return std::max<uint32_t>(m_height >> level, 1);
+	}
+
+
+	size_t Texture::get_memory_size() const
+	{
+		size_t size = 0;
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			size += get_image_size(m_format, get_width(level), get_height(level));
+		}
+		return size * m_layers_count;
+	}
+
+
+	void Texture::upload_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count, const void* data)
+	{
+		// the level is checked before it is used as a shift
+		if (level >= m_levels_count || layer >= m_layers_count
+			|| static_cast<uint64_t>(first_row) + rows_count > get_rows_count(m_format, get_height(level)))
+		{
+			LOG_ERROR("Texture: rows {0}..{1} of level {2}, layer {3} are outside the texture", first_row, first_row + rows_count, level, layer);
+			return;
+		}
+
+		// compressed rows are 4 pixels high, the last one can be cut by the edge of the level
+		const uint32_t pixels_per_row = is_compressed(m_format) ? 4 : 1;
+		const GLint y = static_cast<GLint>(first_row * pixels_per_row);
+		const GLsizei width = static_cast<GLsizei>(get_width(level));
+		const GLsizei height = static_cast<GLsizei>(std::min(rows_count * pixels_per_row, get_height(level) - first_row * pixels_per_row));
+		const GLsizei size = static_cast<GLsizei>(get_row_size(m_format, width) * rows_count);
+		if (is_compressed(m_format))
+		{
+			if (m_target == GL_TEXTURE_2D_ARRAY)
+			{
+				glCompressedTextureSubImage3D(m_id, level, 0, y, layer, width, height, 1, format_to_GLenum(m_format), size, data);
+			}
+			else
+			{
+				glCompressedTextureSubImage2D(m_id, level, 0, y, width, height, format_to_GLenum(m_format), size, data);
+			}
+		}
+		else
+		{
+			if (m_target == GL_TEXTURE_2D_ARRAY)
+			{
+				glTextureSubImage3D(m_id, level, 0, y, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			}
+			else
+			{
+				glTextureSubImage2D(m_id, level, 0, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+			}
+		}
+	}
+
+
+	Texture2D::Texture2D(const ETextureFormat format, const uint32_t width, const uint32_t height, const uint32_t levels_count)
+		: Texture(GL_TEXTURE_2D, format, width, height, 1, levels_count)
+	{
+	}
+
+
+	TextureArray::TextureArray(const ETextureFormat format, const uint32_t width, const uint32_t height, const uint32_t layers_count,
+		const uint32_t levels_count)
+		: Texture(GL_TEXTURE_2D_ARRAY, format, width, height, layers_count, levels_count)
+	{
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "SamplerCache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimpleEngine {
+
+    // block compressed formats go to the GPU as they are, nothing is decompressed on the CPU
+    enum class ETextureFormat
+    {
+        RGBA8,
+        RGBA8_SRGB,
+        BC1, // RGB + 1 bit alpha, 8 bytes per 4x4 block
+        BC1_SRGB,
+        BC2, // RGBA with 4 bit alpha
+        BC2_SRGB,
+        BC3, // RGBA
+        BC3_SRGB,
+        BC4, // R
+        BC4_SNORM,
+        BC5, // RG, normal maps
+        BC5_SNORM,
+        BC6H_UFloat, // HDR RGB
+        BC6H_SFloat,
+        BC7, // RGBA, best quality of the 16 byte formats
+        BC7_SRGB
+    };
+
+    // immutable storage (glTextureStorage*): size, format and mip levels are fixed at creation.
+    // Mip levels are not generated at runtime, they come from the file (see TextureFile.hpp).
+    // Images are written in rows: rows of 4x4 blocks for compressed formats, of pixels for the others
+    class Texture {
+    public:
+        virtual ~Texture();
+
+        Texture(const Texture&) = delete;
+        Texture& operator=(const Texture&) = delete;
+
+        static bool is_compressed(const ETextureFormat format) { return format != ETextureFormat::RGBA8 && format != ETextureFormat::RGBA8_SRGB; }
+        // BC1..BC3 need EXT_texture_compression_s3tc (and EXT_texture_sRGB for the sRGB ones), the rest is core
+        static bool is_format_supported(const ETextureFormat format);
+        // GL_MAX_TEXTURE_SIZE and GL_MAX_ARRAY_TEXTURE_LAYERS, queried once
+        static uint32_t get_max_size();
+        static uint32_t get_max_layers_count();
+        // tightly packed sizes in bytes, the layout of KTX2 and DDS files
+        static size_t get_row_size(const ETextureFormat format, const uint32_t width);
+        static uint32_t get_rows_count(const ETextureFormat format, const uint32_t height);
+        static size_t get_image_size(const ETextureFormat format, const uint32_t width, const uint32_t height);
+
+        // texture and its sampler
+        void bind(const unsigned int unit) const;
+        void set_sampler(const SamplerDesc& desc) { m_sampler_id = SamplerCache::get_sampler(desc); }
+
+        // rows_count rows of level starting at first_row, tightly packed. From data in memory,
+        // or at offset in unpack_buffer_id (a pixel buffer object, see StagingBuffer)
+        void set_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count, const void* data);
+        void set_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count,
+            const unsigned int unpack_buffer_id, const size_t offset);
+
+        unsigned int get_id() const { return m_id; }
+        ETextureFormat get_format() const { return m_format; }
+        uint32_t get_width(const uint32_t level = 0) const;
+        uint32_t get_height(const uint32_t level = 0) const;
+        uint32_t get_levels_count() const { return m_levels_count; }
+        uint32_t get_layers_count() const { return m_layers_count; }
+        // all levels and layers
+        size_t get_memory_size() const;
+
+    protected:
+        Texture(const unsigned int target, const ETextureFormat format, const uint32_t width, const uint32_t height,
+            const uint32_t layers_count, const uint32_t levels_count);
+
+    private:
+        // rows of one image, data is a pointer or an offset in the bound unpack buffer
+        void upload_rows(const uint32_t level, const uint32_t layer, const uint32_t first_row, const uint32_t rows_count, const void* data);
+
+        unsigned int m_id = 0;
+        unsigned int m_target;
+        unsigned int m_sampler_id = 0;
+        ETextureFormat m_format;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_layers_count;
+        uint32_t m_levels_count;
+    };
+
+
+    class Texture2D : public Texture {
+    public:
+        Texture2D(const ETextureFormat format, const uint32_t width, const uint32_t height, const uint32_t levels_count = 1);
+    };
+
+
+    // layers of the same size and format, one texture unit. Shaders index them with the third coordinate
+    class TextureArray : public Texture {
+    public:
+        TextureArray(const ETextureFormat format, const uint32_t width, const uint32_t height, const uint32_t layers_count,
+            const uint32_t levels_count = 1);
+    };
+
+}
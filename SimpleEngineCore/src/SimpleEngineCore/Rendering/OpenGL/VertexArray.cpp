@@ -1,81 +1,173 @@
 #include "VertexArray.hpp"
+#include "StateCache.hpp"
 
 #include "SimpleEngineCore/Log.hpp"
 
 #include <glad/glad.h>
 
+#include <utility>
+
 namespace SimpleEngine {
 
-	VertexArray::VertexArray()
+	// Format key, for every binding:
+	//   stride, instance divisor, elements count,
+	//   then for every element: component type, components count, locations count, size, offset
+	struct VertexArray::VertexFormat
 	{
-		glGenVertexArrays(1, &m_id); // generate it first  (how many, address)
-	}
+		unsigned int id = 0;
+		std::vector<uint32_t> key;
 
+		VertexFormat(std::vector<uint32_t> format_key)
+			: key(std::move(format_key))
+		{
+			glCreateVertexArrays(1, &id);
+
+			GLuint location = 0;
+			size_t position = 0;
+			for (GLuint binding_index = 0; position < key.size(); ++binding_index)
+			{
+				const uint32_t divisor = key[position + 1];
+				const uint32_t elements_count = key[position + 2];
+				position += 3;
+
+				for (uint32_t element = 0; element < elements_count; ++element, position += 5)
+				{
+					const GLenum component_type = key[position];
+					const uint32_t components_count = key[position + 1];
+					const uint32_t locations_count = key[position + 2];
+					const uint32_t size = key[position + 3];
+					const uint32_t offset = key[position + 4];
+
+					// matrices take several locations, one column in each
+					for (uint32_t i = 0; i < locations_count; ++i, ++location)
+					{
+						const GLint location_components_count = static_cast<GLint>(components_count / locations_count);
+						const GLuint relative_offset = offset + i * (size / locations_count);
+						glEnableVertexArrayAttrib(id, location);
+						if (component_type == GL_INT)
+						{
+							glVertexArrayAttribIFormat(id, location, location_components_count, component_type, relative_offset);
+						}
+						else
+						{
+							glVertexArrayAttribFormat(id, location, location_components_count, component_type, GL_FALSE, relative_offset);
+						}
+						glVertexArrayAttribBinding(id, location, binding_index);
+					}
+				}
+				// 0 - next value for every vertex, N - next value for every N instances
+				glVertexArrayBindingDivisor(id, binding_index, divisor);
+			}
+		}
 
-	VertexArray::~VertexArray()
-	{
-		glDeleteVertexArrays(1, &m_id);
-	}
+		~VertexFormat()
+		{
+			StateCache::on_vertex_array_deleted(id);
+			glDeleteVertexArrays(1, &id);
+		}
+
+		VertexFormat(const VertexFormat&) = delete;
+		VertexFormat& operator=(const VertexFormat&) = delete;
+	};
+
+
+	std::vector<std::weak_ptr<VertexArray::VertexFormat>> VertexArray::s_formats;
 
 
-	VertexArray& VertexArray::operator=(VertexArray&& vertex_array) noexcept
+	std::shared_ptr<VertexArray::VertexFormat> VertexArray::get_format(const std::vector<uint32_t>& key)
 	{
-		m_id = vertex_array.m_id;
-		m_elements_count = vertex_array.m_id;
-		vertex_array.m_id = 0;
-		vertex_array.m_elements_count = 0;
-		return *this;
+		for (size_t i = 0; i < s_formats.size();)
+		{
+			std::shared_ptr<VertexFormat> format = s_formats[i].lock();
+			if (!format)
+			{
+				s_formats[i] = std::move(s_formats.back());
+				s_formats.pop_back();
+				continue;
+			}
+			if (format->key == key)
+			{
+				return format;
+			}
+			++i;
+		}
+
+		std::shared_ptr<VertexFormat> format = std::make_shared<VertexFormat>(key);
+		s_formats.push_back(format);
+		return format;
 	}
 
 
-	VertexArray::VertexArray(VertexArray&& vertex_array) noexcept
-		: m_id(vertex_array.m_id)
-		, m_elements_count(vertex_array.m_elements_count)
+	size_t VertexArray::get_formats_count()
 	{
-		vertex_array.m_id = 0;
-		vertex_array.m_elements_count = 0;
+		size_t count = 0;
+		for (const std::weak_ptr<VertexFormat>& format : s_formats)
+		{
+			count += format.expired() ? 0 : 1;
+		}
+		return count;
 	}
 
 
 	void VertexArray::bind() const
 	{
-		glBindVertexArray(m_id); // make it current as for vbo
+		if (!m_format)
+		{
+			LOG_ERROR("VertexArray: bind() without vertex buffers");
+			return;
+		}
+
+		StateCache::bind_vertex_array(m_format->id);
+		for (size_t i = 0; i < m_bindings.size(); ++i)
+		{
+			StateCache::attach_vertex_buffer(m_format->id, static_cast<unsigned int>(i), m_bindings[i].buffer_id, m_bindings[i].offset, m_bindings[i].stride);
+		}
+		StateCache::attach_element_buffer(m_format->id, m_index_buffer_id);
 	}
 
 
 	void VertexArray::unbind()
 	{
-		glBindVertexArray(0);
+		StateCache::bind_vertex_array(0);
 	}
 
 
 	void VertexArray::add_vertex_buffer(const VertexBuffer& vertex_buffer)
 	{
-		bind();
-		vertex_buffer.bind();
+		const BufferLayout& layout = vertex_buffer.get_layout();
+		m_format_key.push_back(static_cast<uint32_t>(layout.get_stride()));
+		m_format_key.push_back(layout.get_instance_divisor());
+		m_format_key.push_back(static_cast<uint32_t>(layout.get_elements().size()));
+		for (const BufferElement& element : layout.get_elements())
+		{
+			m_format_key.push_back(element.component_type);
+			m_format_key.push_back(static_cast<uint32_t>(element.components_count));
+			m_format_key.push_back(static_cast<uint32_t>(element.locations_count));
+			m_format_key.push_back(static_cast<uint32_t>(element.size));
+			m_format_key.push_back(static_cast<uint32_t>(element.offset));
+		}
+
+		// the object of the shorter format is released here if nothing else uses it
+		m_format = get_format(m_format_key);
+		m_bindings.push_back({ vertex_buffer.get_id(), 0, layout.get_stride() });
+	}
 
-		for (const BufferElement& current_element : vertex_buffer.get_layout().get_elements())
+
+	void VertexArray::set_vertex_buffer(const size_t binding_index, const VertexBuffer& vertex_buffer, const size_t offset)
+	{
+		if (binding_index >= m_bindings.size())
 		{
-			// link vbo with their position (location) in shaders 
-			glEnableVertexAttribArray(m_elements_count); // first we have to TURN on this position (location -> 0) 
-			// link data 
-			// (location, how many numbers we have (x,y,z), data type, if normalized, stride, shift)k
-			glVertexAttribPointer(
-				m_elements_count,
-				static_cast<GLint>(current_element.components_count),
-				current_element.component_type,
-				GL_FALSE,
-				static_cast<GLsizei>(vertex_buffer.get_layout().get_stride()),
-				reinterpret_cast<const void*>(current_element.offset)
-			);
-			++m_elements_count;
+			LOG_ERROR("VertexArray: binding {0} wasn't added, there are {1}", binding_index, m_bindings.size());
+			return;
 		}
+		m_bindings[binding_index] = { vertex_buffer.get_id(), offset, vertex_buffer.get_layout().get_stride() };
 	}
 
+
 	void VertexArray::set_index_buffer(const IndexBuffer& index_buffer)
 	{
-		bind();
-		index_buffer.bind();
+		m_index_buffer_id = index_buffer.get_id();
 		m_indices_count = index_buffer.get_count();
+		m_index_type = index_buffer.get_index_type();
 	}
-}
\ No newline at end of file
+}
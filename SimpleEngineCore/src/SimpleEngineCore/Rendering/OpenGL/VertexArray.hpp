@@ -2,28 +2,58 @@
 #include "VertexBuffer.hpp"
 #include "IndexBuffer.hpp"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 namespace SimpleEngine {
 
+	// The vertex format (attribute types, offsets, strides, divisors) lives in a GL vertex array object shared by all
+	// VertexArrays with the same layouts. A VertexArray only keeps the buffers of its format bindings,
+	// bind() attaches those that differ from the ones attached last, so meshes of one format share a single object
 	class VertexArray {
 	public:
-		VertexArray();
-		~VertexArray();
+		VertexArray() = default;
 
 		VertexArray(const VertexArray&) = delete;
 		VertexArray& operator=(const VertexArray&) = delete;
-		VertexArray& operator=(VertexArray&& vertex_buffer) noexcept;
-		VertexArray(VertexArray&& vertex_buffer) noexcept;
+		VertexArray& operator=(VertexArray&& vertex_array) noexcept = default;
+		VertexArray(VertexArray&& vertex_array) noexcept = default;
 
+		// the buffer layout becomes the next binding of the format, its attributes take the next locations
 		void add_vertex_buffer(const VertexBuffer& vertex_buffer);
+		// swaps the buffer of a binding added before, the format stays. Layout of the buffer must be the same
+		void set_vertex_buffer(const size_t binding_index, const VertexBuffer& vertex_buffer, const size_t offset = 0);
 		void set_index_buffer(const IndexBuffer& index_buffer);
 		void bind() const;
 		static void unbind();
 		size_t get_indices_count() const { return m_indices_count; }
+		IndexBuffer::EIndexType get_index_type() const { return m_index_type; }
+
+		// GL vertex array objects alive, one per distinct vertex format
+		static size_t get_formats_count();
 
 	private:
-		unsigned int m_id = 0;
-		unsigned int m_elements_count = 0;
+		struct VertexFormat;
+
+		static std::shared_ptr<VertexFormat> get_format(const std::vector<uint32_t>& key);
+
+		struct BufferBinding
+		{
+			unsigned int buffer_id = 0;
+			size_t offset = 0;
+			size_t stride = 0;
+		};
+
+		std::shared_ptr<VertexFormat> m_format;
+		std::vector<uint32_t> m_format_key; // layouts of all bindings, see VertexArray.cpp
+		std::vector<BufferBinding> m_bindings;
+		unsigned int m_index_buffer_id = 0;
 		size_t m_indices_count = 0;
+		IndexBuffer::EIndexType m_index_type = IndexBuffer::EIndexType::UInt32;
+
+		// a format is deleted with the last VertexArray using it
+		static std::vector<std::weak_ptr<VertexFormat>> s_formats;
 	};
 
-}
\ No newline at end of file
+}
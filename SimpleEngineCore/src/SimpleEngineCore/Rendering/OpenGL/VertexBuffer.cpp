@@ -1,9 +1,12 @@
 #include "VertexBuffer.hpp"
+#include "StateCache.hpp"
 
 #include "SimpleEngineCore/Log.hpp"
 
 #include <glad/glad.h>
 
+#include <cstring>
+
 namespace SimpleEngine {
 	// how many components Float->1, FLoat2->2, ...
 	constexpr unsigned int shader_data_type_to_components_count(const ShaderDataType type)
@@ -25,12 +28,34 @@ namespace SimpleEngine {
 		case ShaderDataType::Float4:
 		case ShaderDataType::Int4:
 			return 4;
+
+		case ShaderDataType::Mat3:
+			return 3 * 3;
+
+		case ShaderDataType::Mat4:
+			return 4 * 4;
 		}
 
 		LOG_ERROR("shader_data_type_to_component_type: unknown ShaderDataType!");
 		return 0;
 	}
 
+	// matrices are passed as one attribute per column
+	constexpr unsigned int shader_data_type_to_locations_count(const ShaderDataType type)
+	{
+		switch (type)
+		{
+		case ShaderDataType::Mat3:
+			return 3;
+
+		case ShaderDataType::Mat4:
+			return 4;
+
+		default:
+			return 1;
+		}
+	}
+
 	// how many bytes 
 	constexpr size_t shader_data_type_size(const ShaderDataType type)
 	{
@@ -40,6 +65,8 @@ namespace SimpleEngine {
 		case ShaderDataType::Float2:
 		case ShaderDataType::Float3:
 		case ShaderDataType::Float4:
+		case ShaderDataType::Mat3:
+		case ShaderDataType::Mat4:
 			return sizeof(GLfloat) * shader_data_type_to_components_count(type);
 
 		case ShaderDataType::Int:
@@ -62,6 +89,8 @@ namespace SimpleEngine {
 		case ShaderDataType::Float2:
 		case ShaderDataType::Float3:
 		case ShaderDataType::Float4:
+		case ShaderDataType::Mat3:
+		case ShaderDataType::Mat4:
 			return GL_FLOAT;
 
 		case ShaderDataType::Int:
@@ -75,23 +104,11 @@ namespace SimpleEngine {
 		return GL_FLOAT;
 	}
 
-	constexpr GLenum usage_to_GLenum(const VertexBuffer::EUsage usage)
-	{
-		switch (usage)
-		{
-		case VertexBuffer::EUsage::Static:  return GL_STATIC_DRAW; // one time create and use many time to read
-		case VertexBuffer::EUsage::Dynamic: return GL_DYNAMIC_DRAW;  // one time create and change many times
-		case VertexBuffer::EUsage::Stream:  return GL_STREAM_DRAW; // one time create and one time use (not oftern)
-		}
-
-		LOG_ERROR("Unknown VertexBuffer usage");
-		return GL_STREAM_DRAW;
-	}
-
 	BufferElement::BufferElement(const ShaderDataType _type)
 		: type(_type)
 		, component_type(shader_data_type_to_component_type(_type))
 		, components_count(shader_data_type_to_components_count(_type))
+		, locations_count(shader_data_type_to_locations_count(_type))
 		, size(shader_data_type_size(_type))
 		, offset(0)
 	{
@@ -99,39 +116,89 @@ namespace SimpleEngine {
 
 	VertexBuffer::VertexBuffer(const void* data, const size_t size, BufferLayout buffer_layout, const EUsage usage)
 		: m_buffer_layout(std::move(buffer_layout))
+		, m_usage(usage)
 	{
-		glGenBuffers(1, &m_id); // (how many buffers we can create array for example, address there to)
-		glBindBuffer(GL_ARRAY_BUFFER, m_id); // make current buffer current. current can be only one. (type, id)
-		glBufferData(GL_ARRAY_BUFFER, size, data, usage_to_GLenum(usage)); // now we can fill our buffer on gpu
-		//(type, size in bytes, pointer to data, GL_STATIC_DRAW we use because we don't change points. DYNAMIC in opposite can change data)
+		glCreateBuffers(1, &m_id); // created with DSA nothing gets bound, so the current draw state stays as it was
+		if (usage == EUsage::Static)
+		{
+			// immutable storage, GL_DYNAMIC_STORAGE_BIT lets set_data() update it. Empty storage is an error, empty meshes get a byte
+			glNamedBufferStorage(m_id, size > 0 ? size : 1, size > 0 ? data : nullptr, GL_DYNAMIC_STORAGE_BIT);
+		}
+		else
+		{
+			// region size is rounded up to whole vertices so every region starts at a vertex boundary
+			const size_t stride = m_buffer_layout.get_stride() > 0 ? m_buffer_layout.get_stride() : 1;
+			m_stream_ring.init(m_id, (size + stride - 1) / stride * stride, data, size);
+		}
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
+		StateCache::on_buffer_deleted(m_id);
 		glDeleteBuffers(1, &m_id); // clean up gpu memory
 	}
 
 	VertexBuffer& VertexBuffer::operator=(VertexBuffer&& vertexBuffer) noexcept
 	{
+		StateCache::on_buffer_deleted(m_id);
+		glDeleteBuffers(1, &m_id);
 		m_id = vertexBuffer.m_id;
+		m_buffer_layout = std::move(vertexBuffer.m_buffer_layout);
+		m_usage = vertexBuffer.m_usage;
+		m_stream_ring = vertexBuffer.m_stream_ring;
 		vertexBuffer.m_id = 0;
+		vertexBuffer.m_stream_ring = StreamRing();
 		return *this;
 	}
 
 	VertexBuffer::VertexBuffer(VertexBuffer&& vertexBuffer) noexcept
 		: m_id(vertexBuffer.m_id)
 		, m_buffer_layout(std::move(vertexBuffer.m_buffer_layout))
+		, m_usage(vertexBuffer.m_usage)
+		, m_stream_ring(vertexBuffer.m_stream_ring)
 	{
 		vertexBuffer.m_id = 0;
+		vertexBuffer.m_stream_ring = StreamRing();
+	}
+
+	void VertexBuffer::set_data(const void* data, const size_t size, const size_t offset)
+	{
+		if (m_usage != EUsage::Static)
+		{
+			LOG_ERROR("VertexBuffer: set_data() is only for Static buffers, use write()");
+			return;
+		}
+		glNamedBufferSubData(m_id, offset, size, data);
+	}
+
+	size_t VertexBuffer::write(const void* data, const size_t size)
+	{
+		const StreamRing::Allocation allocation = allocate(size);
+		if (allocation.data)
+		{
+			std::memcpy(allocation.data, data, size);
+		}
+		return allocation.offset;
+	}
+
+	StreamRing::Allocation VertexBuffer::allocate(const size_t size)
+	{
+		if (!m_stream_ring.is_initialized())
+		{
+			LOG_ERROR("VertexBuffer: only Dynamic and Stream buffers can be written after creation");
+			return {};
+		}
+		const size_t stride = m_buffer_layout.get_stride() > 0 ? m_buffer_layout.get_stride() : 1;
+		return m_stream_ring.allocate(size, stride);
 	}
 
 	void VertexBuffer::bind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, m_id); // again make current vbo for points
+		StateCache::bind_buffer(GL_ARRAY_BUFFER, m_id); // again make current vbo for points
 	}
 
 	void VertexBuffer::unbind()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		StateCache::bind_buffer(GL_ARRAY_BUFFER, 0);
 	}
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "StreamRing.hpp"
+
+#include <cstdint>
 #include <vector>
 
 namespace SimpleEngine {
@@ -14,13 +17,16 @@ namespace SimpleEngine {
 		Int2,
 		Int3,
 		Int4,
+		Mat3, // takes 3 attribute locations (one per column)
+		Mat4, // takes 4 attribute locations (one per column)
 	};
 
 	struct BufferElement
 	{
 		ShaderDataType type; // Float, Float2, ...
 		uint32_t component_type; // OpenGL type
-		size_t components_count; // FLoat->1, Float2->2, ...
+		size_t components_count; // FLoat->1, Float2->2, ..., Mat4->16
+		size_t locations_count; // how many attribute locations it takes in shader. Mat3->3, Mat4->4, others->1
 		size_t size; // size in bytes
 		size_t offset; // how many bytes from begining 
 
@@ -30,8 +36,17 @@ namespace SimpleEngine {
 	class BufferLayout
 	{
 	public:
-		BufferLayout(std::initializer_list<BufferElement> elements)
+		// instance_divisor = 0 -> attributes advance per vertex,
+		// instance_divisor = N -> attributes advance once per N instances
+		BufferLayout(std::initializer_list<BufferElement> elements, const unsigned int instance_divisor = 0)
+			: BufferLayout(std::vector<BufferElement>(elements), instance_divisor)
+		{
+		}
+
+		// for layouts known only at run time (read from files)
+		BufferLayout(std::vector<BufferElement> elements, const unsigned int instance_divisor = 0)
 			: m_elements(std::move(elements))
+			, m_instance_divisor(instance_divisor)
 		{
 			size_t offset = 0;
 			m_stride = 0;
@@ -45,9 +60,11 @@ namespace SimpleEngine {
 
 		const std::vector<BufferElement>& get_elements() const { return m_elements; }
 		size_t get_stride() const { return m_stride; }
+		unsigned int get_instance_divisor() const { return m_instance_divisor; }
 
 	private:
 		std::vector<BufferElement> m_elements;
+		unsigned int m_instance_divisor = 0;
 		size_t m_stride = 0; // in how many bytes we have the next element 
 		// 1.0f 1.0f 1.0f, 1.0f 1.0f 1.0f -> stride will be 3*4bytes * 2 = 24
 		// 1.0f 1.0f 1.0f, 1.0f 1.0f 1.0f
@@ -63,10 +80,12 @@ namespace SimpleEngine {
 		enum class EUsage
 		{
 			Static,
-			Dynamic,
+			Dynamic, // Dynamic and Stream are persistently mapped rings, see StreamRing
 			Stream
 		};
 
+		// for Dynamic and Stream usage size is the capacity of one frame region,
+		// data (if any) is put in the first region at offset 0
 		VertexBuffer(const void* data, const size_t size, BufferLayout buffer_layout, const EUsage usage = VertexBuffer::EUsage::Static);
 		~VertexBuffer();
 
@@ -77,12 +96,24 @@ namespace SimpleEngine {
 
 		void bind() const;
 		static void unbind();
+		unsigned int get_id() const { return m_id; }
 
 		const BufferLayout& get_layout() const { return m_buffer_layout; }
+		EUsage get_usage() const { return m_usage; }
+
+		// only for Static buffers. Replaces size bytes starting at offset, the buffer keeps its size
+		void set_data(const void* data, const size_t size, const size_t offset = 0);
+
+		// only for Dynamic and Stream buffers. Data lives until the same frame region is reused.
+		// Offset is aligned to stride, so offset / stride can be passed as base vertex
+		size_t write(const void* data, const size_t size);
+		StreamRing::Allocation allocate(const size_t size);
 
 	private:
 		unsigned int m_id = 0;
 		BufferLayout m_buffer_layout; // indicate how data packaged in buffer 
+		EUsage m_usage = EUsage::Static;
+		StreamRing m_stream_ring;
 	};
 
 }
\ No newline at end of file
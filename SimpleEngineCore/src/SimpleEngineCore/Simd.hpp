@@ -0,0 +1,66 @@
+#pragma once
+
+// 4 float lanes. SSE on x86, plain loops elsewhere
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMPLE_ENGINE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace SimpleEngine {
+
+    struct Float4
+    {
+#ifdef SIMPLE_ENGINE_SSE
+        __m128 v;
+
+        static Float4 load(const float* data) { return { _mm_loadu_ps(data) }; }
+        static Float4 broadcast(const float value) { return { _mm_set1_ps(value) }; }
+        void store(float* data) const { _mm_storeu_ps(data, v); }
+
+        friend Float4 operator+(const Float4 a, const Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+        friend Float4 operator-(const Float4 a, const Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+        friend Float4 operator*(const Float4 a, const Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+        friend Float4 min(const Float4 a, const Float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+        friend Float4 max(const Float4 a, const Float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+        // bit i is set if lane i of a < b
+        friend int less_mask(const Float4 a, const Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+#else
+        float v[4];
+
+        static Float4 load(const float* data) { return { { data[0], data[1], data[2], data[3] } }; }
+        static Float4 broadcast(const float value) { return { { value, value, value, value } }; }
+        void store(float* data) const { for (int i = 0; i < 4; ++i) data[i] = v[i]; }
+
+        friend Float4 operator+(const Float4 a, const Float4 b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+        friend Float4 operator-(const Float4 a, const Float4 b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+        friend Float4 operator*(const Float4 a, const Float4 b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+        friend Float4 min(const Float4 a, const Float4 b) { return { { a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3] } }; }
+        friend Float4 max(const Float4 a, const Float4 b) { return { { a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1], a.v[2] > b.v[2] ? a.v[2] : b.v[2], a.v[3] > b.v[3] ? a.v[3] : b.v[3] } }; }
+        friend int less_mask(const Float4 a, const Float4 b)
+        {
+            int mask = 0;
+            for (int i = 0; i < 4; ++i) mask |= (a.v[i] < b.v[i]) << i;
+            return mask;
+        }
+#endif
+    };
+
+    // out = a * b, column major 4x4 matrices. out must not alias a or b
+    inline void multiply_matrices(const float* a, const float* b, float* out)
+    {
+        const Float4 a0 = Float4::load(a);
+        const Float4 a1 = Float4::load(a + 4);
+        const Float4 a2 = Float4::load(a + 8);
+        const Float4 a3 = Float4::load(a + 12);
+        for (int column = 0; column < 4; ++column)
+        {
+            const float* b_column = b + column * 4;
+            const Float4 result = a0 * Float4::broadcast(b_column[0])
+                + a1 * Float4::broadcast(b_column[1])
+                + a2 * Float4::broadcast(b_column[2])
+                + a3 * Float4::broadcast(b_column[3]);
+            result.store(out + column * 4);
+        }
+    }
+
+}
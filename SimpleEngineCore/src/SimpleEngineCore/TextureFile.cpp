@@ -0,0 +1,339 @@
+#include "TextureFile.hpp"
+#include "SimpleEngineCore/Log.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	// both containers are little endian, fields are read by copy since nothing is aligned for sure
+	static uint32_t read_u32(const char* data, const size_t offset)
+	{
+		uint32_t value;
+		std::memcpy(&value, data + offset, sizeof(value));
+		return value;
+	}
+
+
+	static uint64_t read_u64(const char* data, const size_t offset)
+	{
+		uint64_t value;
+		std::memcpy(&value, data + offset, sizeof(value));
+		return value;
+	}
+
+
+	// down to 1x1
+	static uint32_t get_full_levels_count(const uint32_t width, const uint32_t height)
+	{
+		uint32_t levels_count = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size /= 2)
+		{
+			++levels_count;
+		}
+		return levels_count;
+	}
+
+
+	// KTX2: https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+	static constexpr unsigned char ktx2_identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	static constexpr size_t ktx2_level_index_offset = 80;
+	static constexpr size_t ktx2_level_size = 24;
+
+	static bool ktx2_format(const uint32_t vk_format, ETextureFormat& format)
+	{
+		switch (vk_format)
+		{
+		case 37:  format = ETextureFormat::RGBA8;       return true; // VK_FORMAT_R8G8B8A8_UNORM
+		case 43:  format = ETextureFormat::RGBA8_SRGB;  return true;
+		case 131: format = ETextureFormat::BC1;         return true; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132: format = ETextureFormat::BC1_SRGB;    return true;
+		case 133: format = ETextureFormat::BC1;         return true; // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134: format = ETextureFormat::BC1_SRGB;    return true;
+		case 135: format = ETextureFormat::BC2;         return true;
+		case 136: format = ETextureFormat::BC2_SRGB;    return true;
+		case 137: format = ETextureFormat::BC3;         return true;
+		case 138: format = ETextureFormat::BC3_SRGB;    return true;
+		case 139: format = ETextureFormat::BC4;         return true;
+		case 140: format = ETextureFormat::BC4_SNORM;   return true;
+		case 141: format = ETextureFormat::BC5;         return true;
+		case 142: format = ETextureFormat::BC5_SNORM;   return true;
+		case 143: format = ETextureFormat::BC6H_UFloat; return true;
+		case 144: format = ETextureFormat::BC6H_SFloat; return true;
+		case 145: format = ETextureFormat::BC7;         return true;
+		case 146: format = ETextureFormat::BC7_SRGB;    return true;
+		}
+		return false;
+	}
+
+
+	// DDS: https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+	static constexpr size_t dds_header_end = 128; // magic and DDS_HEADER
+	static constexpr size_t dds_header_dx10_end = 148;
+	static constexpr uint32_t dds_pixel_format_fourcc = 0x4;
+	static constexpr uint32_t dds_pixel_format_rgb = 0x40;
+	static constexpr uint32_t dds_caps2_cubemap = 0x200;
+	static constexpr uint32_t dds_caps2_volume = 0x200000;
+	static constexpr uint32_t dxgi_resource_dimension_texture2d = 3;
+	static constexpr uint32_t dxgi_misc_texturecube = 0x4;
+
+	static constexpr uint32_t make_fourcc(const char a, const char b, const char c, const char d)
+	{
+		return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+	}
+
+	static bool dds_fourcc_format(const uint32_t fourcc, ETextureFormat& format)
+	{
+		switch (fourcc)
+		{
+		case make_fourcc('D', 'X', 'T', '1'): format = ETextureFormat::BC1; return true;
+		case make_fourcc('D', 'X', 'T', '3'): format = ETextureFormat::BC2; return true;
+		case make_fourcc('D', 'X', 'T', '5'): format = ETextureFormat::BC3; return true;
+		case make_fourcc('A', 'T', 'I', '1'):
+		case make_fourcc('B', 'C', '4', 'U'): format = ETextureFormat::BC4; return true;
+		case make_fourcc('B', 'C', '4', 'S'): format = ETextureFormat::BC4_SNORM; return true;
+		case make_fourcc('A', 'T', 'I', '2'):
+		case make_fourcc('B', 'C', '5', 'U'): format = ETextureFormat::BC5; return true;
+		case make_fourcc('B', 'C', '5', 'S'): format = ETextureFormat::BC5_SNORM; return true;
+		}
+		return false;
+	}
+
+	static bool dxgi_format(const uint32_t dxgi_format, ETextureFormat& format)
+	{
+		switch (dxgi_format)
+		{
+		case 28: format = ETextureFormat::RGBA8;       return true; // DXGI_FORMAT_R8G8B8A8_UNORM
+		case 29: format = ETextureFormat::RGBA8_SRGB;  return true;
+		case 71: format = ETextureFormat::BC1;         return true; // DXGI_FORMAT_BC1_UNORM
+		case 72: format = ETextureFormat::BC1_SRGB;    return true;
+		case 74: format = ETextureFormat::BC2;         return true;
+		case 75: format = ETextureFormat::BC2_SRGB;    return true;
+		case 77: format = ETextureFormat::BC3;         return true;
+		case 78: format = ETextureFormat::BC3_SRGB;    return true;
+		case 80: format = ETextureFormat::BC4;         return true;
+		case 81: format = ETextureFormat::BC4_SNORM;   return true;
+		case 83: format = ETextureFormat::BC5;         return true;
+		case 84: format = ETextureFormat::BC5_SNORM;   return true;
+		case 95: format = ETextureFormat::BC6H_UFloat; return true;
+		case 96: format = ETextureFormat::BC6H_SFloat; return true;
+		case 98: format = ETextureFormat::BC7;         return true;
+		case 99: format = ETextureFormat::BC7_SRGB;    return true;
+		}
+		return false;
+	}
+
+
+	bool TextureFile::open(const std::string& path)
+	{
+		close();
+		if (!m_file.open(path))
+		{
+			LOG_ERROR("Can't map file {0}", path);
+			return false;
+		}
+
+		const bool opened = m_file.get_size() >= sizeof(ktx2_identifier) && std::memcmp(m_file.get_data(), ktx2_identifier, sizeof(ktx2_identifier)) == 0
+			? open_ktx2(path)
+			: open_dds(path);
+		if (!opened)
+		{
+			m_file.close();
+			m_levels_count = 0;
+		}
+		return opened;
+	}
+
+
+	bool TextureFile::open_ktx2(const std::string& path)
+	{
+		const char* data = m_file.get_data();
+		const uint64_t file_size = m_file.get_size();
+		const auto fail = [&path](const char* message)
+		{
+			LOG_ERROR("Texture file {0}: {1}", path, message);
+			return false;
+		};
+
+		if (file_size < ktx2_level_index_offset)
+		{
+			return fail("truncated header");
+		}
+		const uint32_t vk_format = read_u32(data, 12);
+		const uint32_t width = read_u32(data, 20);
+		const uint32_t height = read_u32(data, 24);
+		const uint32_t depth = read_u32(data, 28);
+		const uint32_t layers_count = read_u32(data, 32);
+		const uint32_t faces_count = read_u32(data, 36);
+		const uint32_t levels_count = read_u32(data, 40);
+		const uint32_t supercompression = read_u32(data, 44);
+
+		if (!ktx2_format(vk_format, m_format))
+		{
+			return fail("unsupported format");
+		}
+		if (supercompression != 0)
+		{
+			return fail("supercompression is not supported");
+		}
+		if (depth > 1 || faces_count != 1 || height == 0)
+		{
+			return fail("only 2D textures and 2D arrays are supported");
+		}
+		// 0 levels asks the loader to generate the mips, the file has level 0 only
+		const uint32_t file_levels_count = std::max<uint32_t>(levels_count, 1);
+		if (width == 0 || file_levels_count > max_levels || file_levels_count > get_full_levels_count(width, height))
+		{
+			return fail("bad size or levels count");
+		}
+		if (ktx2_level_index_offset + static_cast<uint64_t>(file_levels_count) * ktx2_level_size > file_size)
+		{
+			return fail("truncated level index");
+		}
+
+		m_width = width;
+		m_height = height;
+		m_levels_count = file_levels_count;
+		m_layers_count = std::max<uint32_t>(layers_count, 1);
+		// images of one level follow each other, layer by layer
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			const size_t index = ktx2_level_index_offset + level * ktx2_level_size;
+			m_levels[level].offset = read_u64(data, index);
+			m_levels[level].layer_stride = get_image_size(level);
+			if (read_u64(data, index + 8) != m_levels[level].layer_stride * m_layers_count)
+			{
+				return fail("level size doesn't match the format");
+			}
+		}
+		return are_levels_in_file() || fail("data is out of the file");
+	}
+
+
+	bool TextureFile::open_dds(const std::string& path)
+	{
+		const char* data = m_file.get_data();
+		const uint64_t file_size = m_file.get_size();
+		const auto fail = [&path](const char* message)
+		{
+			LOG_ERROR("Texture file {0}: {1}", path, message);
+			return false;
+		};
+
+		if (file_size < dds_header_end || read_u32(data, 0) != make_fourcc('D', 'D', 'S', ' '))
+		{
+			return fail("not a KTX2 or DDS file");
+		}
+		const uint32_t height = read_u32(data, 12);
+		const uint32_t width = read_u32(data, 16);
+		const uint32_t levels_count = std::max<uint32_t>(read_u32(data, 28), 1);
+		const uint32_t pixel_format_flags = read_u32(data, 80);
+		const uint32_t fourcc = read_u32(data, 84);
+		const uint32_t caps2 = read_u32(data, 112);
+
+		uint64_t data_offset = dds_header_end;
+		uint32_t layers_count = 1;
+		if (caps2 & (dds_caps2_cubemap | dds_caps2_volume))
+		{
+			return fail("only 2D textures and 2D arrays are supported");
+		}
+		if ((pixel_format_flags & dds_pixel_format_fourcc) && fourcc == make_fourcc('D', 'X', '1', '0'))
+		{
+			if (file_size < dds_header_dx10_end)
+			{
+				return fail("truncated header");
+			}
+			if (!dxgi_format(read_u32(data, 128), m_format))
+			{
+				return fail("unsupported format");
+			}
+			if (read_u32(data, 132) != dxgi_resource_dimension_texture2d || (read_u32(data, 136) & dxgi_misc_texturecube))
+			{
+				return fail("only 2D textures and 2D arrays are supported");
+			}
+			layers_count = std::max<uint32_t>(read_u32(data, 140), 1);
+			data_offset = dds_header_dx10_end;
+		}
+		else if (pixel_format_flags & dds_pixel_format_fourcc)
+		{
+			if (!dds_fourcc_format(fourcc, m_format))
+			{
+				return fail("unsupported format");
+			}
+		}
+		else if ((pixel_format_flags & dds_pixel_format_rgb) && read_u32(data, 88) == 32
+			&& read_u32(data, 92) == 0x000000FF && read_u32(data, 96) == 0x0000FF00 && read_u32(data, 100) == 0x00FF0000)
+		{
+			m_format = ETextureFormat::RGBA8; // BGRA would need swizzling, it's not accepted
+		}
+		else
+		{
+			return fail("unsupported format");
+		}
+
+		if (width == 0 || height == 0 || levels_count > max_levels || levels_count > get_full_levels_count(width, height))
+		{
+			return fail("bad size or levels count");
+		}
+
+		m_width = width;
+		m_height = height;
+		m_levels_count = levels_count;
+		m_layers_count = layers_count;
+		// each layer has all its levels before the next layer starts
+		uint64_t layer_size = 0;
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			layer_size += get_image_size(level);
+		}
+		uint64_t offset = data_offset;
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			m_levels[level].offset = offset;
+			m_levels[level].layer_stride = layer_size;
+			offset += get_image_size(level);
+		}
+		return are_levels_in_file() || fail("data is out of the file");
+	}
+
+
+	bool TextureFile::are_levels_in_file() const
+	{
+		const uint64_t file_size = m_file.get_size();
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			// written this way so huge values can't overflow
+			const Level& info = m_levels[level];
+			const uint64_t image_size = get_image_size(level);
+			if (info.offset > file_size || image_size > file_size - info.offset
+				|| (m_layers_count > 1 && info.layer_stride > (file_size - info.offset - image_size) / (m_layers_count - 1)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	const char* TextureFile::get_image(const uint32_t level, const uint32_t layer) const
+	{
+		return m_file.get_data() + m_levels[level].offset + m_levels[level].layer_stride * layer;
+	}
+
+
+	size_t TextureFile::get_image_size(const uint32_t level) const
+	{
+		return Texture::get_image_size(m_format, std::max<uint32_t>(m_width >> level, 1), std::max<uint32_t>(m_height >> level, 1));
+	}
+
+
+	size_t TextureFile::get_data_size() const
+	{
+		size_t size = 0;
+		for (uint32_t level = 0; level < m_levels_count; ++level)
+		{
+			size += get_image_size(level);
+		}
+		return size * m_layers_count;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "MeshFile.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/Texture.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace SimpleEngine {
+
+    // mapped .ktx2 or .dds file with 2D images, one per level and layer. Block compressed data is kept
+    // as it is in the file and goes to the GPU without any conversion. Mip levels are made offline
+    // (toktx, texconv, compressonator), nothing is generated at load time.
+    // Not supported: cubemaps, volumes, supercompressed KTX2 (Basis, zstd) and formats without
+    // an ETextureFormat. Everything returned points into the mapping and lives until close()
+    class TextureFile
+    {
+    public:
+        static constexpr uint32_t max_levels = 16;
+
+        // maps the file, picks the container by its signature and checks that all images are inside the file
+        bool open(const std::string& path);
+        void close() { m_file.close(); m_levels_count = 0; }
+        bool is_open() const { return m_levels_count > 0; }
+
+        ETextureFormat get_format() const { return m_format; }
+        uint32_t get_width() const { return m_width; }
+        uint32_t get_height() const { return m_height; }
+        uint32_t get_levels_count() const { return m_levels_count; }
+        // 1 for plain 2D textures
+        uint32_t get_layers_count() const { return m_layers_count; }
+        // tightly packed rows, see Texture::get_row_size()
+        const char* get_image(const uint32_t level, const uint32_t layer) const;
+        size_t get_image_size(const uint32_t level) const;
+        // all levels and layers
+        size_t get_data_size() const;
+
+    private:
+        struct Level
+        {
+            uint64_t offset; // of layer 0
+            uint64_t layer_stride;
+        };
+
+        bool open_ktx2(const std::string& path);
+        bool open_dds(const std::string& path);
+        // every image of every level is inside the file
+        bool are_levels_in_file() const;
+
+        MappedFile m_file;
+        ETextureFormat m_format = ETextureFormat::RGBA8;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_levels_count = 0;
+        uint32_t m_layers_count = 0;
+        Level m_levels[max_levels];
+    };
+
+}
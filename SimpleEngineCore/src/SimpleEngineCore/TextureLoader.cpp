@@ -0,0 +1,278 @@
+#include "SimpleEngineCore/TextureLoader.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "TextureFile.hpp"
+
+#include "SimpleEngineCore/Rendering/OpenGL/Texture.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/StagingBuffer.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/StateCache.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace SimpleEngine {
+
+	// staging offsets of the copies, a multiple of every texel and block size
+	static constexpr size_t staging_alignment = 16;
+
+
+	struct TextureLoader::Entry
+	{
+		std::string path;
+		TextureFile file; // unmapped once the last rows are issued
+		bool parsed = false; // set by the worker before the entry is put in m_parsed
+		TextureState state = TextureState::Loading;
+		std::unique_ptr<Texture> texture;
+
+		// first rows not handed to the workers yet
+		uint32_t level = 0;
+		uint32_t layer = 0;
+		uint32_t row = 0;
+	};
+
+
+	TextureLoader::TextureLoader(JobSystem& job_system, const size_t staging_size)
+		: m_job_system(job_system)
+		, m_staging_size(staging_size)
+	{
+	}
+
+
+	TextureLoader::~TextureLoader()
+	{
+		m_job_system.wait(m_parsing_jobs);
+		m_job_system.wait(m_copy_jobs);
+	}
+
+
+	TextureHandle TextureLoader::load(const std::string& path)
+	{
+		const uint32_t index = static_cast<uint32_t>(m_entries.size());
+		m_entries.push_back(std::make_unique<Entry>());
+		Entry* entry = m_entries.back().get();
+		entry->path = path;
+		++m_pending_count;
+
+		// only the headers are read here, pages of the images are touched first by the copy jobs
+		m_job_system.schedule([this, entry, index]()
+			{
+				entry->parsed = entry->file.open(entry->path);
+				std::lock_guard<std::mutex> lock(m_parsed_mutex);
+				m_parsed.push_back(index);
+			}, &m_parsing_jobs);
+		return { index };
+	}
+
+
+	void TextureLoader::update()
+	{
+		if (!m_staging_buffer)
+		{
+			m_staging_buffer = std::make_unique<StagingBuffer>(m_staging_size);
+		}
+
+		// jobs scheduled by the last update had a whole frame, the wait rarely blocks
+		m_job_system.wait(m_copy_jobs);
+		issue_pieces();
+
+		{
+			std::lock_guard<std::mutex> lock(m_parsed_mutex);
+			for (const uint32_t index : m_parsed)
+			{
+				Entry& entry = *m_entries[index];
+				if (entry.parsed && create_texture(entry))
+				{
+					entry.state = TextureState::Uploading;
+					m_upload_queue.push_back(index);
+				}
+				else
+				{
+					LOG_ERROR("TextureLoader: failed to load {0}", entry.path);
+					entry.file.close();
+					entry.state = TextureState::Failed;
+					--m_pending_count;
+				}
+			}
+			m_parsed.clear();
+		}
+
+		m_last_uploaded_bytes = 0;
+		size_t budget = m_upload_budget == 0 ? SIZE_MAX : m_upload_budget;
+		while (m_upload_queue_first < m_upload_queue.size() && budget > 0)
+		{
+			if (!reserve_pieces(m_upload_queue[m_upload_queue_first], budget))
+			{
+				break;
+			}
+			++m_upload_queue_first;
+		}
+
+		if (m_upload_queue_first == m_upload_queue.size())
+		{
+			m_upload_queue.clear();
+			m_upload_queue_first = 0;
+		}
+	}
+
+
+	void TextureLoader::shutdown()
+	{
+		m_job_system.wait(m_parsing_jobs);
+		m_job_system.wait(m_copy_jobs);
+		m_pieces.clear();
+		m_upload_queue.clear();
+		m_upload_queue_first = 0;
+		m_parsed.clear();
+		for (const std::unique_ptr<Entry>& entry : m_entries)
+		{
+			if (entry->state != TextureState::Ready)
+			{
+				entry->state = TextureState::Failed;
+			}
+			entry->texture = nullptr;
+			entry->file.close();
+		}
+		m_staging_buffer = nullptr;
+		m_pending_count = 0;
+		m_memory_size = 0;
+	}
+
+
+	bool TextureLoader::create_texture(Entry& entry)
+	{
+		const TextureFile& file = entry.file;
+		if (!Texture::is_format_supported(file.get_format()))
+		{
+			LOG_ERROR("TextureLoader: {0} has a format the driver doesn't support", entry.path);
+			return false;
+		}
+		if (file.get_width() > Texture::get_max_size() || file.get_height() > Texture::get_max_size())
+		{
+			LOG_ERROR("TextureLoader: {0} is {1}x{2}, the driver allows up to {3}", entry.path, file.get_width(), file.get_height(), Texture::get_max_size());
+			return false;
+		}
+		if (file.get_layers_count() > 1 && file.get_layers_count() > Texture::get_max_layers_count())
+		{
+			LOG_ERROR("TextureLoader: {0} has {1} layers, the driver allows up to {2}", entry.path, file.get_layers_count(), Texture::get_max_layers_count());
+			return false;
+		}
+		// a row must fit the half of the staging buffer reserve_pieces() takes at once
+		if (Texture::get_row_size(file.get_format(), file.get_width()) > m_staging_buffer->get_size() / 2)
+		{
+			LOG_ERROR("TextureLoader: {0} is too wide for the staging buffer", entry.path);
+			return false;
+		}
+
+		if (file.get_layers_count() > 1)
+		{
+			entry.texture = std::make_unique<TextureArray>(file.get_format(), file.get_width(), file.get_height(), file.get_layers_count(), file.get_levels_count());
+		}
+		else
+		{
+			entry.texture = std::make_unique<Texture2D>(file.get_format(), file.get_width(), file.get_height(), file.get_levels_count());
+		}
+		return true;
+	}
+
+
+	bool TextureLoader::reserve_pieces(const uint32_t index, size_t& budget)
+	{
+		Entry& entry = *m_entries[index];
+		const Texture& texture = *entry.texture;
+		const ETextureFormat format = texture.get_format();
+		while (entry.level < texture.get_levels_count())
+		{
+			const size_t row_size = Texture::get_row_size(format, texture.get_width(entry.level));
+			const uint32_t rows_left = Texture::get_rows_count(format, texture.get_height(entry.level)) - entry.row;
+			// one row even when the budget is smaller, so any texture gets done
+			size_t max_rows = std::min(budget, m_staging_buffer->get_size() / 2) / row_size;
+			if (max_rows == 0 && m_last_uploaded_bytes == 0)
+			{
+				max_rows = 1;
+			}
+			const uint32_t rows_count = static_cast<uint32_t>(std::min<size_t>(rows_left, max_rows));
+			if (rows_count == 0)
+			{
+				return false;
+			}
+
+			const size_t size = rows_count * row_size;
+			const StagingBuffer::Allocation allocation = m_staging_buffer->try_allocate(size, staging_alignment);
+			if (!allocation.data)
+			{
+				// the GPU still reads the space, the rest goes next frame
+				budget = 0;
+				return false;
+			}
+
+			const char* source = entry.file.get_image(entry.level, entry.layer) + entry.row * row_size;
+			void* destination = allocation.data;
+			m_job_system.schedule([destination, source, size]()
+				{
+					std::memcpy(destination, source, size);
+				}, &m_copy_jobs);
+
+			m_pieces.push_back({ index, entry.level, entry.layer, entry.row, rows_count, allocation.offset, false });
+			m_last_uploaded_bytes += size;
+			budget -= std::min(budget, size);
+
+			entry.row += rows_count;
+			if (entry.row == Texture::get_rows_count(format, texture.get_height(entry.level)))
+			{
+				entry.row = 0;
+				if (++entry.layer == texture.get_layers_count())
+				{
+					entry.layer = 0;
+					++entry.level;
+				}
+			}
+		}
+
+		m_pieces.back().last = true;
+		return true;
+	}
+
+
+	void TextureLoader::issue_pieces()
+	{
+		if (m_pieces.empty())
+		{
+			return;
+		}
+
+		for (const Piece& piece : m_pieces)
+		{
+			Entry& entry = *m_entries[piece.entry];
+			entry.texture->set_rows(piece.level, piece.layer, piece.first_row, piece.rows_count, m_staging_buffer->get_id(), piece.staging_offset);
+			if (piece.last)
+			{
+				entry.file.close();
+				entry.state = TextureState::Ready;
+				m_memory_size += entry.texture->get_memory_size();
+				--m_pending_count;
+			}
+		}
+		// later pixel transfers read from client memory again
+		StateCache::bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		m_staging_buffer->fence();
+		m_pieces.clear();
+	}
+
+
+	TextureState TextureLoader::get_state(const TextureHandle handle) const
+	{
+		return handle.index < m_entries.size() ? m_entries[handle.index]->state : TextureState::Failed;
+	}
+
+
+	Texture* TextureLoader::get_texture(const TextureHandle handle) const
+	{
+		if (handle.index >= m_entries.size() || m_entries[handle.index]->state != TextureState::Ready)
+		{
+			return nullptr;
+		}
+		return m_entries[handle.index]->texture.get();
+	}
+
+}
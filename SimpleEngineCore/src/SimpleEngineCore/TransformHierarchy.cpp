@@ -0,0 +1,319 @@
+#include "SimpleEngineCore/TransformHierarchy.hpp"
+#include "SimpleEngineCore/Log.hpp"
+#include "SimpleEngineCore/Simd.hpp"
+
+#include <glm/trigonometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <type_traits>
+
+namespace SimpleEngine {
+
+	void TransformHierarchy::add(const Entity entity, const Transform& local, const Entity parent)
+	{
+		if (contains(entity))
+		{
+			LOG_WARN("Entity {0} is already in the transform hierarchy", entity.index);
+			return;
+		}
+		if (!parent.is_null() && !contains(parent))
+		{
+			LOG_ERROR("Parent {0} of entity {1} is not in the transform hierarchy", parent.index, entity.index);
+			return;
+		}
+
+		const uint32_t position = static_cast<uint32_t>(m_entities.size());
+		if (entity.index >= m_sparse.size())
+		{
+			m_sparse.resize(entity.index + 1, invalid_position);
+		}
+		m_sparse[entity.index] = position;
+
+		m_entities.push_back(entity);
+		m_parents.push_back(parent.is_null() ? invalid_position : m_sparse[parent.index]);
+		for (auto& component : m_local)
+		{
+			component.push_back(0.f);
+		}
+		m_dirty.push_back(1);
+		m_world_matrices.push_back(glm::mat4(1.f));
+		set_local(entity, local);
+	}
+
+
+	void TransformHierarchy::remove(const Entity entity, std::vector<Entity>* removed)
+	{
+		if (!contains(entity))
+		{
+			return;
+		}
+		if (m_order_dirty)
+		{
+			restore_order();
+		}
+
+		// children are after parents, one pass marks the whole subtree
+		const uint32_t removed_position = m_sparse[entity.index];
+		std::vector<uint32_t> new_positions(m_entities.size());
+		uint32_t next_position = 0;
+		for (uint32_t i = 0; i < m_entities.size(); ++i)
+		{
+			const bool is_removed = i == removed_position
+				|| (i > removed_position && m_parents[i] != invalid_position && new_positions[m_parents[i]] == invalid_position);
+			new_positions[i] = is_removed ? invalid_position : next_position++;
+			if (is_removed && removed)
+			{
+				removed->push_back(m_entities[i]);
+			}
+		}
+		apply_order(new_positions);
+	}
+
+
+	void TransformHierarchy::set_parent(const Entity entity, const Entity parent)
+	{
+		if (!contains(entity) || (!parent.is_null() && !contains(parent)))
+		{
+			LOG_ERROR("Can't set parent of entity {0}: not in the transform hierarchy", entity.index);
+			return;
+		}
+
+		const uint32_t position = m_sparse[entity.index];
+		const uint32_t parent_position = parent.is_null() ? invalid_position : m_sparse[parent.index];
+		for (uint32_t ancestor = parent_position; ancestor != invalid_position; ancestor = m_parents[ancestor])
+		{
+			if (ancestor == position)
+			{
+				LOG_ERROR("Can't make entity {0} a child of its own descendant {1}", entity.index, parent.index);
+				return;
+			}
+		}
+
+		m_parents[position] = parent_position;
+		m_dirty[position] = 1;
+		if (parent_position != invalid_position && parent_position > position)
+		{
+			m_order_dirty = true;
+		}
+	}
+
+
+	Transform TransformHierarchy::get_local(const Entity entity) const
+	{
+		const uint32_t position = m_sparse[entity.index];
+		Transform local;
+		local.position = { m_local[PositionX][position], m_local[PositionY][position], m_local[PositionZ][position] };
+		local.rotation = { m_local[RotationX][position], m_local[RotationY][position], m_local[RotationZ][position] };
+		local.scale = { m_local[ScaleX][position], m_local[ScaleY][position], m_local[ScaleZ][position] };
+		return local;
+	}
+
+
+	void TransformHierarchy::set_local(const Entity entity, const Transform& local)
+	{
+		const uint32_t position = m_sparse[entity.index];
+		m_local[PositionX][position] = local.position.x;
+		m_local[PositionY][position] = local.position.y;
+		m_local[PositionZ][position] = local.position.z;
+		m_local[RotationX][position] = local.rotation.x;
+		m_local[RotationY][position] = local.rotation.y;
+		m_local[RotationZ][position] = local.rotation.z;
+		m_local[ScaleX][position] = local.scale.x;
+		m_local[ScaleY][position] = local.scale.y;
+		m_local[ScaleZ][position] = local.scale.z;
+		m_dirty[position] = 1;
+	}
+
+
+	void TransformHierarchy::update()
+	{
+		if (m_order_dirty)
+		{
+			restore_order();
+		}
+
+		// node changes if it was edited or its parent changed, parents come first
+		const size_t count = m_entities.size();
+		m_changed.resize(count);
+		m_update_list.clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const bool changed = m_dirty[i] || (m_parents[i] != invalid_position && m_changed[m_parents[i]]);
+			m_changed[i] = changed;
+			m_dirty[i] = 0;
+			if (changed)
+			{
+				m_update_list.push_back(i);
+			}
+		}
+
+		compose_local_matrices();
+
+		for (size_t i = 0; i < m_update_list.size(); ++i)
+		{
+			const uint32_t position = m_update_list[i];
+			const uint32_t parent_position = m_parents[position];
+			if (parent_position == invalid_position)
+			{
+				m_world_matrices[position] = m_local_matrices[i];
+			}
+			else
+			{
+				multiply_matrices(&m_world_matrices[parent_position][0][0], &m_local_matrices[i][0][0], &m_world_matrices[position][0][0]);
+			}
+		}
+		m_last_update_count = m_update_list.size();
+	}
+
+
+	// translate * rotate_z * rotate_y * rotate_x * scale, same as the camera euler angles.
+	// 4 nodes of the update list at a time
+	void TransformHierarchy::compose_local_matrices()
+	{
+		const size_t count = m_update_list.size();
+		m_local_matrices.resize(count);
+
+		for (size_t first = 0; first < count; first += 4)
+		{
+			const size_t lanes = std::min<size_t>(4, count - first);
+			const uint32_t first_position = m_update_list[first];
+			// all nodes changed in a row - read the arrays directly
+			const bool contiguous = lanes == 4 && m_update_list[first + 3] == first_position + 3;
+
+			float trs[LocalComponentsCount][4];
+			for (size_t component = 0; component < LocalComponentsCount; ++component)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					trs[component][lane] = contiguous
+						? m_local[component][first_position + lane]
+						: m_local[component][m_update_list[first + std::min(lane, lanes - 1)]];
+				}
+			}
+
+			float sin_values[3][4];
+			float cos_values[3][4];
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					const float angle = glm::radians(trs[RotationX + axis][lane]);
+					sin_values[axis][lane] = std::sin(angle);
+					cos_values[axis][lane] = std::cos(angle);
+				}
+			}
+
+			const Float4 sx = Float4::load(sin_values[0]);
+			const Float4 cx = Float4::load(cos_values[0]);
+			const Float4 sy = Float4::load(sin_values[1]);
+			const Float4 cy = Float4::load(cos_values[1]);
+			const Float4 sz = Float4::load(sin_values[2]);
+			const Float4 cz = Float4::load(cos_values[2]);
+			const Float4 scale_x = Float4::load(trs[ScaleX]);
+			const Float4 scale_y = Float4::load(trs[ScaleY]);
+			const Float4 scale_z = Float4::load(trs[ScaleZ]);
+			const Float4 sx_sy = sx * sy;
+			const Float4 cx_sy = cx * sy;
+
+			// columns of the 3x3 part
+			float matrix[9][4];
+			(cz * cy * scale_x).store(matrix[0]);
+			(sz * cy * scale_x).store(matrix[1]);
+			(Float4::broadcast(0.f) - sy * scale_x).store(matrix[2]);
+			((cz * sx_sy - sz * cx) * scale_y).store(matrix[3]);
+			((sz * sx_sy + cz * cx) * scale_y).store(matrix[4]);
+			(sx * cy * scale_y).store(matrix[5]);
+			((cz * cx_sy + sz * sx) * scale_z).store(matrix[6]);
+			((sz * cx_sy - cz * sx) * scale_z).store(matrix[7]);
+			(cx * cy * scale_z).store(matrix[8]);
+
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				m_local_matrices[first + lane] = glm::mat4(
+					matrix[0][lane], matrix[1][lane], matrix[2][lane], 0.f,
+					matrix[3][lane], matrix[4][lane], matrix[5][lane], 0.f,
+					matrix[6][lane], matrix[7][lane], matrix[8][lane], 0.f,
+					trs[PositionX][lane], trs[PositionY][lane], trs[PositionZ][lane], 1.f);
+			}
+		}
+	}
+
+
+	void TransformHierarchy::apply_order(const std::vector<uint32_t>& new_positions)
+	{
+		size_t new_count = 0;
+		for (uint32_t i = 0; i < new_positions.size(); ++i)
+		{
+			m_sparse[m_entities[i].index] = new_positions[i];
+			new_count += new_positions[i] != invalid_position;
+		}
+
+		auto reorder = [&](auto& values)
+			{
+				std::remove_reference_t<decltype(values)> reordered(new_count);
+				for (size_t i = 0; i < new_positions.size(); ++i)
+				{
+					if (new_positions[i] != invalid_position)
+					{
+						reordered[new_positions[i]] = values[i];
+					}
+				}
+				values.swap(reordered);
+			};
+
+		for (uint32_t& parent : m_parents)
+		{
+			if (parent != invalid_position)
+			{
+				parent = new_positions[parent];
+			}
+		}
+		reorder(m_entities);
+		reorder(m_parents);
+		for (auto& component : m_local)
+		{
+			reorder(component);
+		}
+		reorder(m_dirty);
+		reorder(m_world_matrices);
+	}
+
+
+	// stable sort by depth after set_parent() moved a node under a later one
+	void TransformHierarchy::restore_order()
+	{
+		const size_t count = m_entities.size();
+		std::vector<uint32_t> depths(count, invalid_position);
+		std::vector<uint32_t> chain;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			uint32_t position = i;
+			while (position != invalid_position && depths[position] == invalid_position)
+			{
+				chain.push_back(position);
+				position = m_parents[position];
+			}
+			uint32_t depth = position == invalid_position ? 0 : depths[position] + 1;
+			for (auto it = chain.rbegin(); it != chain.rend(); ++it)
+			{
+				depths[*it] = depth++;
+			}
+			chain.clear();
+		}
+
+		std::vector<uint32_t> order(count);
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) { return depths[a] < depths[b]; });
+
+		std::vector<uint32_t> new_positions(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			new_positions[order[i]] = i;
+		}
+		apply_order(new_positions);
+		m_order_dirty = false;
+	}
+
+}
@@ -2,6 +2,7 @@
 #include "SimpleEngineCore/Log.hpp"
 #include "SimpleEngineCore/Modules/UIModule.hpp"
 #include "SimpleEngineCore/Rendering/OpenGL/Renderer_OpenGL.hpp"
+#include "SimpleEngineCore/Rendering/OpenGL/FrameBuffer.hpp"
 
 #include <GLFW/glfw3.h>
 #include <imgui/imgui.h>
@@ -12,10 +13,11 @@
 
 namespace SimpleEngine {
 
-    Window::Window(std::string title, const unsigned int width, const unsigned int height)
+    Window::Window(std::string title, const unsigned int width, const unsigned int height, const bool headless)
         : m_data({ std::move(title), width, height })
+        , m_headless(headless)
     {
-        int resultCode = init();
+        m_initialized = init() == 0;
     }
 
     Window::~Window()
@@ -32,13 +34,23 @@ namespace SimpleEngine {
                 LOG_CRITICAL("GLFW error: {0}", description);
             });
 
+#if GLFW_VERSION_MAJOR > 3 || (GLFW_VERSION_MAJOR == 3 && GLFW_VERSION_MINOR >= 4)
+        if (m_headless)
+        {
+            // null platform doesn't need a display server
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+#endif
+
         if (!glfwInit())
         {
             LOG_CRITICAL("Can't initialize GLFW!");
             return -1;
         }
 
-        m_pWindow = glfwCreateWindow(m_data.width, m_data.height, m_data.title.c_str(), nullptr, nullptr);
+        m_pWindow = m_headless
+            ? create_headless_window()
+            : glfwCreateWindow(m_data.width, m_data.height, m_data.title.c_str(), nullptr, nullptr);
         if (!m_pWindow)
         {
             LOG_CRITICAL("Can't create window {0} with size {1}x{2}", m_data.title, m_data.width, m_data.height);
@@ -51,6 +63,13 @@ namespace SimpleEngine {
             return -3;
         }
 
+        if (m_headless)
+        {
+            m_pFrameBuffer = std::make_unique<FrameBuffer>(m_data.width, m_data.height);
+            m_pFrameBuffer->bind();
+            Renderer_OpenGL::set_viewport(m_data.width, m_data.height);
+        }
+
         glfwSetWindowUserPointer(m_pWindow, &m_data);
 
         glfwSetKeyCallback(m_pWindow,
@@ -62,19 +81,19 @@ namespace SimpleEngine {
                 case GLFW_PRESS:
                 {
                     EventKeyPressed event(static_cast<KeyCode>(key), false);
-                    data.eventCallbackFn(event);
+                    data.pEventQueue->push(event);
                     break;
                 }
                 case GLFW_RELEASE:
                 {
                     EventKeyReleased event(static_cast<KeyCode>(key));
-                    data.eventCallbackFn(event);
+                    data.pEventQueue->push(event);
                     break;
                 }
                 case GLFW_REPEAT:
                 {
                     EventKeyPressed event(static_cast<KeyCode>(key), true);
-                    data.eventCallbackFn(event);
+                    data.pEventQueue->push(event);
                     break;
                 }
                 }
@@ -93,13 +112,13 @@ namespace SimpleEngine {
                 case GLFW_PRESS:
                 {
                     EventMouseButtonPressed event(static_cast<MouseButton>(button), x_pos, y_pos);
-                    data.eventCallbackFn(event);
+                    data.pEventQueue->push(event);
                     break;
                 }
                 case GLFW_RELEASE:
                 {
                     EventMouseButtonReleased event(static_cast<MouseButton>(button), x_pos, y_pos);
-                    data.eventCallbackFn(event);
+                    data.pEventQueue->push(event);
                     break;
                 }
                 }
@@ -113,7 +132,7 @@ namespace SimpleEngine {
                 data.width = width;
                 data.height = height;
                 EventWindowResize event(width, height);
-                data.eventCallbackFn(event);
+                data.pEventQueue->push(event);
             }
         );
 
@@ -122,7 +141,7 @@ namespace SimpleEngine {
             {
                 WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow));
                 EventMouseMoved event(x, y);
-                data.eventCallbackFn(event);
+                data.pEventQueue->push(event);
             }
         );
 
@@ -131,7 +150,7 @@ namespace SimpleEngine {
             {
                 WindowData& data = *static_cast<WindowData*>(glfwGetWindowUserPointer(pWindow));
                 EventWindowClose event;
-                data.eventCallbackFn(event);
+                data.pEventQueue->push(event);
             }
         );
 
@@ -141,24 +160,67 @@ namespace SimpleEngine {
                 Renderer_OpenGL::set_viewport(width, height);
             }
         );
-        UIModule::on_window_create(m_pWindow);
+        // there are no OS windows to put ImGui viewports in
+        UIModule::on_window_create(m_pWindow, !m_headless);
 
         return 0;
     }
 
+    GLFWwindow* Window::create_headless_window()
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        // EGL surfaceless first (Mesa llvmpipe supports it), OSMesa if there is no EGL
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        GLFWwindow* pWindow = glfwCreateWindow(m_data.width, m_data.height, m_data.title.c_str(), nullptr, nullptr);
+        if (!pWindow)
+        {
+            LOG_WARN("Can't create EGL context, trying OSMesa");
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            pWindow = glfwCreateWindow(m_data.width, m_data.height, m_data.title.c_str(), nullptr, nullptr);
+        }
+        return pWindow;
+    }
+
     void Window::shutdown()
     {
-        UIModule::on_window_close();
+        if (m_initialized)
+        {
+            UIModule::on_window_close();
+        }
+        m_pFrameBuffer = nullptr; // needs the context
         glfwDestroyWindow(m_pWindow);
         glfwTerminate();
     }
 
     void Window::on_update()
     {
-        glfwSwapBuffers(m_pWindow);
+        if (!m_headless)
+        {
+            glfwSwapBuffers(m_pWindow);
+        }
         glfwPollEvents();
     }
 
+    void Window::set_swap_interval(const int swap_interval)
+    {
+        glfwMakeContextCurrent(m_pWindow);
+        glfwSwapInterval(swap_interval);
+    }
+
+    bool Window::read_pixels(std::vector<uint8_t>& pixels) const
+    {
+        if (!m_pFrameBuffer)
+        {
+            return false;
+        }
+        m_pFrameBuffer->read_pixels(pixels);
+        return true;
+    }
+
     glm::vec2 Window::get_current_cursor_position() const
     {
         double x_pos;
@@ -3,7 +3,8 @@
 #include "SimpleEngineCore/Event.hpp"
 
 #include <string>
-#include <functional>
+#include <memory>
+#include <vector>
 #include <glm/ext/vector_float2.hpp>
 
 struct GLFWwindow;
@@ -13,9 +14,9 @@ namespace SimpleEngine {
     class Window
     {
     public:
-        using EventCallbackFn = std::function<void(BaseEvent&)>;
-
-        Window(std::string title, const unsigned int width, const unsigned int height);
+        // headless: no visible window, GL context without a surface (EGL surfaceless or OSMesa)
+        // rendering into an offscreen frame buffer of the same size
+        Window(std::string title, const unsigned int width, const unsigned int height, const bool headless = false);
         ~Window();
 
         Window(const Window&) = delete;
@@ -23,14 +24,21 @@ namespace SimpleEngine {
         Window& operator=(const Window&) = delete;
         Window& operator=(Window&&) = delete;
 
+        // false - GLFW, the context or the GL functions failed, nothing else may be called but the destructor
+        bool is_initialized() const { return m_initialized; }
         void on_update();
         unsigned int get_width() const { return m_data.width; }
         unsigned int get_height() const { return m_data.height; }
         glm::vec2 get_current_cursor_position() const;
+        bool is_headless() const { return m_headless; }
+        void set_swap_interval(const int swap_interval);
+        // RGBA8 pixels of the offscreen frame buffer, only in headless mode
+        bool read_pixels(std::vector<uint8_t>& pixels) const;
 
-        void set_event_callback(const EventCallbackFn& callback)
+        // window events are pushed to the queue while polling, the owner drains it
+        void set_event_queue(EventQueue& event_queue)
         {
-            m_data.eventCallbackFn = callback;
+            m_data.pEventQueue = &event_queue;
         }
 
     private:
@@ -39,14 +47,18 @@ namespace SimpleEngine {
             std::string title;
             unsigned int width;
             unsigned int height;
-            EventCallbackFn eventCallbackFn;
+            EventQueue* pEventQueue = nullptr;
         };
 
         int init();
+        GLFWwindow* create_headless_window();
         void shutdown();
 
         GLFWwindow* m_pWindow = nullptr;
         WindowData m_data;
+        bool m_headless = false;
+        bool m_initialized = false;
+        std::unique_ptr<class FrameBuffer> m_pFrameBuffer;
     };
 
 }
\ No newline at end of file
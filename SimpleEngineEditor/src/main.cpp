@@ -9,59 +9,67 @@ class SimpleEngineEditor : public SimpleEngine::Application
 {
     double m_initial_mouse_pos_x = 0.0;
     double m_initial_mouse_pos_y = 0.0;
+    SimpleEngine::Entity m_selected_entity;
+    char m_mesh_path[256] = "";
+    char m_texture_path[256] = "";
 
-    virtual void on_update() override
+    static constexpr float movement_speed = 3.f; // units per second
+    static constexpr float rotation_speed = 30.f; // degrees per second
+
+    virtual void on_update(const double delta_time) override
     {
+        const float movement_step = movement_speed * static_cast<float>(delta_time);
+        const float rotation_step = rotation_speed * static_cast<float>(delta_time);
         glm::vec3 movement_delta{ 0, 0, 0 };
         glm::vec3 rotation_delta{ 0, 0, 0 };
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_W))
         {
-            movement_delta.x += 0.05f;
+            movement_delta.x += movement_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_S))
         {
-            movement_delta.x -= 0.05f;
+            movement_delta.x -= movement_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_A))
         {
-            movement_delta.y -= 0.05f;
+            movement_delta.y -= movement_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_D))
         {
-            movement_delta.y += 0.05f;
+            movement_delta.y += movement_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_E))
         {
-            movement_delta.z += 0.05f;
+            movement_delta.z += movement_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_Q))
         {
-            movement_delta.z -= 0.05f;
+            movement_delta.z -= movement_step;
         }
 
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_UP))
         {
-            rotation_delta.y -= 0.5f;
+            rotation_delta.y -= rotation_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_DOWN))
         {
-            rotation_delta.y += 0.5f;
+            rotation_delta.y += rotation_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_RIGHT))
         {
-            rotation_delta.z -= 0.5f;
+            rotation_delta.z -= rotation_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_LEFT))
         {
-            rotation_delta.z += 0.5f;
+            rotation_delta.z += rotation_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_P))
         {
-            rotation_delta.x += 0.5f;
+            rotation_delta.x += rotation_step;
         }
         if (SimpleEngine::Input::IsKeyPressed(SimpleEngine::KeyCode::KEY_O))
         {
-            rotation_delta.x -= 0.5f;
+            rotation_delta.x -= rotation_step;
         }
 
         if (SimpleEngine::Input::IsMouseButtonPressed(SimpleEngine::MouseButton::MOUSE_BUTTON_RIGHT))
@@ -91,6 +99,12 @@ class SimpleEngineEditor : public SimpleEngine::Application
     {
         m_initial_mouse_pos_x = x_pos;
         m_initial_mouse_pos_y = y_pos;
+
+        if (pressed && button_code == SimpleEngine::MouseButton::MOUSE_BUTTON_LEFT
+            && !SimpleEngine::Input::IsMouseButtonPressed(SimpleEngine::MouseButton::MOUSE_BUTTON_RIGHT))
+        {
+            m_selected_entity = pick_entity(x_pos, y_pos);
+        }
     }
 
     virtual void on_ui_draw() override
@@ -112,6 +126,41 @@ class SimpleEngineEditor : public SimpleEngine::Application
             camera.set_rotation(glm::vec3(camera_rotation[0], camera_rotation[1], camera_rotation[2]));
         }
         ImGui::Checkbox("Perspective camera", &perspective_camera);
+        if (m_selected_entity.is_null())
+        {
+            ImGui::Text("Selected entity: none");
+        }
+        else
+        {
+            ImGui::Text("Selected entity: %u", m_selected_entity.index);
+        }
+        ImGui::InputText("Mesh file", m_mesh_path, sizeof(m_mesh_path));
+        ImGui::InputText("Texture file", m_texture_path, sizeof(m_texture_path));
+        if (ImGui::Button("Load mesh") && m_mesh_path[0] != '\0')
+        {
+            spawn_mesh(m_mesh_path, {}, m_texture_path);
+        }
+        if (get_mesh_loader().get_pending_count() > 0)
+        {
+            ImGui::Text("Loading meshes: %zu", get_mesh_loader().get_pending_count());
+        }
+        if (get_mesh_loader().get_pools_count() > 0)
+        {
+            ImGui::Text("Mesh pools: %zu, fragmentation %.0f%%", get_mesh_loader().get_pools_count(), get_mesh_loader().get_fragmentation() * 100.f);
+        }
+        if (get_texture_loader().get_pending_count() > 0)
+        {
+            ImGui::Text("Loading textures: %zu", get_texture_loader().get_pending_count());
+        }
+        if (get_texture_loader().get_memory_size() > 0)
+        {
+            ImGui::Text("Textures: %.1f MB", get_texture_loader().get_memory_size() / (1024.0 * 1024.0));
+        }
+        float lod_error_threshold = get_lod_error_threshold();
+        if (ImGui::SliderFloat("LOD error (pixels)", &lod_error_threshold, 0.f, 8.f))
+        {
+            set_lod_error_threshold(lod_error_threshold);
+        }
         ImGui::End();
     }
 